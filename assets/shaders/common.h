@@ -32,6 +32,8 @@ struct PushConstantsData {
     float padding;
     float4 color;
     float4 frustum_planes [6];
+    float3 position_origin; // Unorm16 mesh positions decode to position_origin + q * position_step
+    float position_step;
 };
 
 struct SdfOctreeNode {
@@ -39,5 +41,106 @@ struct SdfOctreeNode {
   uint offset; // offset for children (they are stored together). 0 offset means it's a leaf
 };
 
+// Quantized nodes: corner i decodes to base + q_i * step, where base (low half) and step (high half)
+// are packed as f16 into `range`. Q8 takes 16 bytes per node, Q16 takes 24 bytes.
+struct SdfOctreeNodeQ8 {
+  uint range;
+  uint offset;
+  uint values [2]; // 8-bit corners, corner i lives in byte (i % 4) of values [i / 4]
+};
+
+struct SdfOctreeNodeQ16 {
+  uint range;
+  uint offset;
+  uint values [4]; // 16-bit corners, corner i lives in half (i % 2) of values [i / 2]
+};
+
+// Meshlets (meshlet.hpp). Meshlet i draws triangle_count triangles from triangle_offset on, each packing three local
+// ids (a | b << 8 | c << 16) into the vertex_count mesh vertex ids from vertex_offset on.
+#define MESHLET_MAX_VERTICES 64
+#define MESHLET_MAX_TRIANGLES 124
+#define MESHLET_TASK_GROUP_SIZE 32 // meshlets culled by one task shader workgroup
+
+struct Meshlet {
+  uint vertex_offset;
+  uint triangle_offset;
+  uint vertex_count;
+  uint triangle_count;
+};
+
+// Bounding sphere and the cone of the triangle normals. Every triangle faces away from a camera at c when
+// dot (normalize (cone_apex - c), cone_axis) >= cone_cutoff; a cone too wide to ever cull has cutoff 1 and axis 0.
+struct MeshletBounds {
+  float3 center;
+  float radius;
+  float3 cone_apex;
+  float cone_cutoff;
+  float3 cone_axis;
+  float padding;
+};
+
+#ifndef __cplusplus
+
+// Meshlets that survived culling in one task shader workgroup, one mesh shader workgroup each.
+struct MeshletPayload {
+    uint meshlet_indices [MESHLET_TASK_GROUP_SIZE];
+};
+
+float sdf_node_value (SdfOctreeNode node, uint i) {
+    return node.values [i];
+}
+
+float sdf_node_value (SdfOctreeNodeQ8 node, uint i) {
+    float base = f16tof32 (node.range & 0xffff);
+    float step = f16tof32 (node.range >> 16);
+    uint q = (node.values [i >> 2] >> ((i & 3) * 8)) & 0xff;
+    return base + float (q) * step;
+}
+
+float sdf_node_value (SdfOctreeNodeQ16 node, uint i) {
+    float base = f16tof32 (node.range & 0xffff);
+    float step = f16tof32 (node.range >> 16);
+    uint q = (node.values [i >> 1] >> ((i & 1) * 16)) & 0xffff;
+    return base + float (q) * step;
+}
+
+// CompactMesh streams (compact_mesh.hpp) bound as uint arrays. Unorm16 positions take 3 halves per vertex and decode
+// to origin + q * step; Octahedral16 normals take one word per vertex.
+uint compact_mesh_half (StructuredBuffer <uint> words, uint half_index) {
+    return (words [half_index >> 1] >> ((half_index & 1) * 16)) & 0xffff;
+}
+
+float3 compact_mesh_position (StructuredBuffer <uint> positions, uint vertex, float3 origin, float step) {
+    uint h = 3 * vertex;
+    float3 q = float3 (compact_mesh_half (positions, h), compact_mesh_half (positions, h + 1), compact_mesh_half (positions, h + 2));
+    return origin + q * step;
+}
+
+float3 octahedral_decode (float2 e) {
+    float3 n = float3 (e.x, e.y, 1.0 - abs (e.x) - abs (e.y));
+    float t = max (-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize (n);
+}
+
+float3 compact_mesh_normal (StructuredBuffer <uint> normals, uint vertex) {
+    uint word = normals [vertex];
+    int2 q = int2 (int (word << 16) >> 16, int (word) >> 16);
+    return octahedral_decode (float2 (q) / 32767.0);
+}
+
+// Node layout bound to the octree storage buffer, selected at shader compile time (slangc -DSDF_OCTREE_Q8); the build
+// writes the quantized variants as <shader>.q8.spv and <shader>.q16.spv.
+#if defined (SDF_OCTREE_Q8)
+typedef SdfOctreeNodeQ8 SdfOctreeNodeStorage;
+#elif defined (SDF_OCTREE_Q16)
+typedef SdfOctreeNodeQ16 SdfOctreeNodeStorage;
+#else
+typedef SdfOctreeNode SdfOctreeNodeStorage;
+#endif
+
+#endif // __cplusplus
+
 #endif // COMMON_H
 
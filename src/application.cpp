@@ -1,11 +1,22 @@
+#include <algorithm>
 #include <chrono>
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 #include <stdexcept>
+#include <thread>
 
 #include "application.hpp"
+#include "benchmarks.hpp"
 #include "marching_cubes.hpp"
+#include "mesh_export.hpp"
+#include "mesh_import.hpp"
+#include "mesh_reorder.hpp"
+#include "mesh_sdf.hpp"
+#include "mesh_simplify.hpp"
+#include "meshlet.hpp"
 #include "sdf_octree.hpp"
+#include "sdf_octree_builder.hpp"
 #include "mesh_shader_renderer.hpp"
 
 namespace sdf_raster {
@@ -18,10 +29,12 @@ Application::Application (int a_width, int a_height)
     // init_renderer ();
 }
 
-Application::Application(int a_width, int a_height, const std::string& a_window_title)
+Application::Application(int a_width, int a_height, const std::string& a_window_title, bool a_render_meshlets, SdfOctreeEncoding a_octree_encoding)
     : width (a_width)
     , height (a_height)
     , window_title (a_window_title)
+    , render_meshlets (a_render_meshlets)
+    , octree_encoding (a_octree_encoding)
     , camera ()
     , user_data ({this}) {
     init_window ();
@@ -35,14 +48,160 @@ Application::~Application() {
     cleanup();
 }
 
-void Application::marching_cubes_cpu (const std::string& a_octree_filename, const std::string& a_mesh_filename) {
-    SdfOctree scene {};
-    load_sdf_octree (scene, a_octree_filename);
+namespace {
+
+Mesh extract_mesh (const std::string& a_octree_filename, int a_max_threads, MarchingCubesGrid a_grid = MarchingCubesGrid::Primal) {
+    const MappedSdfOctree scene (a_octree_filename);
+    SdfOctreeRangeIndex range_index;
+    load_or_build_sdf_octree_range_index (scene, a_octree_filename, range_index);
+
     MarchingCubesSettings settings;
     settings.iso_level = 0.0f;
-    settings.max_threads = 1;
-    const std::vector <Mesh> meshes = create_mesh_marching_cubes (settings, scene);
-    save_mesh_as_obj (meshes [0], a_mesh_filename); // TODO: mesh concatenation
+    settings.max_threads = a_max_threads;
+    settings.deterministic = true;
+    settings.normals = MarchingCubesNormals::LeafGradient;
+    settings.grid = a_grid;
+    settings.weld_vertices = true;
+    settings.range_index = &range_index;
+    return create_mesh_marching_cubes (settings, scene);
+}
+
+Meshlets build_and_report_meshlets (const Mesh& a_mesh, int a_max_threads) {
+    MeshletSettings settings;
+    settings.max_threads = a_max_threads;
+    Meshlets meshlets = build_meshlets (a_mesh, settings);
+    printf ("Built %u meshlets for %u triangles\n", (unsigned) meshlets.size (), (unsigned) (a_mesh.get_indices ().size () / 3));
+    return meshlets;
+}
+
+}
+
+// With a_simplify_ratio below 1, the mesh is simplified to that fraction of its triangles before it is written. It is
+// then reordered for the vertex cache and vertex fetches. With a_write_meshlets, its meshlets are written next to it
+// as <mesh file>.meshlets. The dual grid has no cracks between levels but leaves out surface within half a leaf of
+// the domain boundary.
+void Application::marching_cubes_cpu (const std::string& a_octree_filename, const std::string& a_mesh_filename, float a_simplify_ratio, bool a_write_meshlets, MarchingCubesGrid a_grid) {
+    const int max_threads = std::max (1u, std::thread::hardware_concurrency ());
+    Mesh mesh = extract_mesh (a_octree_filename, max_threads, a_grid);
+
+    if (a_simplify_ratio < 1.0f) {
+        MeshSimplifySettings simplify_settings;
+        simplify_settings.target_triangles = size_t (mesh.get_indices ().size () / 3 * double (std::max (a_simplify_ratio, 0.0f)));
+        simplify_settings.max_threads = max_threads;
+        const MeshSimplifyStats stats = simplify_mesh (mesh, simplify_settings);
+        printf ("Simplified %u -> %u triangles in %u passes, max error %g\n"
+                , (unsigned) stats.triangles_before
+                , (unsigned) stats.triangles_after
+                , (unsigned) stats.passes
+                , stats.max_error
+                );
+    }
+
+    MeshReorderSettings reorder_settings;
+    reorder_settings.max_threads = max_threads;
+    const MeshReorderStats reorder_stats = reorder_mesh (mesh, reorder_settings);
+    printf ("Reordered for a %u entry vertex cache: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n"
+            , reorder_settings.cache_size
+            , reorder_stats.before.acmr
+            , reorder_stats.after.acmr
+            , reorder_stats.before.atvr
+            , reorder_stats.after.atvr
+            );
+
+    MeshExportSettings export_settings;
+    export_settings.max_threads = max_threads;
+    save_mesh (mesh, a_mesh_filename, export_settings);
+
+    if (a_write_meshlets) {
+        save_meshlets (build_and_report_meshlets (mesh, max_threads), a_mesh_filename + ".meshlets");
+    }
+}
+
+// Same surface as marching_cubes_cpu on the primal grid, but written chunk by chunk, for meshes too big to hold.
+void Application::stream_marching_cubes_cpu (const std::string& a_octree_filename, const std::string& a_mesh_filename, size_t a_memory_cap) {
+    const MappedSdfOctree scene (a_octree_filename);
+    SdfOctreeRangeIndex range_index;
+    load_or_build_sdf_octree_range_index (scene, a_octree_filename, range_index);
+
+    MarchingCubesSettings settings;
+    settings.iso_level = 0.0f;
+    settings.max_threads = std::max (1u, std::thread::hardware_concurrency ());
+    settings.normals = MarchingCubesNormals::LeafGradient;
+    settings.weld_vertices = true;
+    settings.range_index = &range_index;
+
+    MeshStreamSettings stream_settings;
+    stream_settings.memory_cap = a_memory_cap;
+    FileMeshSink sink (a_mesh_filename);
+    stream_mesh_marching_cubes (settings, stream_settings, scene, sink);
+}
+
+void Application::build_sdf_octree_cpu (const std::string& a_expression_filename, const std::string& a_octree_filename, unsigned int a_max_depth, float a_max_error) {
+    const SdfProgram program = compile_sdf_expression (load_sdf_expression (a_expression_filename));
+
+    SdfOctreeBuildSettings settings;
+    settings.max_depth = a_max_depth;
+    settings.max_error = a_max_error;
+    settings.max_threads = std::max (1u, std::thread::hardware_concurrency ());
+    SdfOctree octree;
+    const auto start = std::chrono::steady_clock::now ();
+    const SdfOctreeBuildStats stats = build_sdf_octree (program, octree, settings);
+    const double seconds = std::chrono::duration <double> (std::chrono::steady_clock::now () - start).count ();
+    printf ("Built %u nodes (%u leaves, depth %u) from %u instructions in %.1f ms, %u evaluations\n"
+            , (unsigned) stats.nodes
+            , (unsigned) stats.leaves
+            , stats.depth
+            , (unsigned) program.instructions.size ()
+            , seconds * 1e3
+            , (unsigned) stats.evaluations
+            );
+
+    save_sdf_octree (octree, a_octree_filename, SdfOctreeLayout::DepthFirst);
+}
+
+void Application::mesh_to_sdf_octree_cpu (const std::string& a_mesh_filename, const std::string& a_octree_filename, unsigned int a_max_depth, float a_max_error) {
+    const Mesh mesh = load_mesh (a_mesh_filename);
+
+    MeshSdfSettings settings;
+    settings.octree.max_depth = a_max_depth;
+    settings.octree.max_error = a_max_error;
+    settings.octree.max_threads = std::max (1u, std::thread::hardware_concurrency ());
+    SdfOctree octree;
+    const MeshSdfStats stats = build_sdf_octree_from_mesh (mesh, octree, settings);
+    printf ("Built a BVH of %u nodes over %u triangles in %.1f ms\n"
+            , (unsigned) stats.bvh_nodes
+            , (unsigned) stats.triangles
+            , stats.bvh_seconds * 1e3
+            );
+    printf ("Built %u nodes (%u leaves, depth %u) in %.1f ms, %u evaluations\n"
+            , (unsigned) stats.octree.nodes
+            , (unsigned) stats.octree.leaves
+            , stats.octree.depth
+            , stats.octree_seconds * 1e3
+            , (unsigned) stats.octree.evaluations
+            );
+    printf ("Octree point p is mesh point (%f, %f, %f) + p / %f\n", stats.center.x, stats.center.y, stats.center.z, stats.scale);
+
+    save_sdf_octree (octree, a_octree_filename, SdfOctreeLayout::DepthFirst);
+}
+
+void Application::run_benchmarks (const std::string& a_octree_filename) {
+    const MappedSdfOctree scene (a_octree_filename);
+    benchmark_octree_layouts (scene, 1 << 22);
+    benchmark_sdf_octree_builder (std::max (1u, std::thread::hardware_concurrency ()));
+
+    SdfOctreeRangeIndex range_index;
+    load_or_build_sdf_octree_range_index (scene, a_octree_filename, range_index);
+    const int max_threads = std::max (1u, std::thread::hardware_concurrency ());
+    benchmark_marching_cubes_cases (scene, range_index, 0.0f, max_threads);
+    benchmark_extraction_engines (scene, range_index, 0.0f, max_threads);
+    benchmark_extraction_workspace (scene, range_index, 0.0f, max_threads);
+    benchmark_compact_mesh (scene, range_index, 0.0f, max_threads);
+    benchmark_mesh_weld (scene, range_index, 0.0f, max_threads);
+    benchmark_mesh_simplify (scene, range_index, 0.0f, max_threads);
+    benchmark_mesh_reorder (scene, range_index, 0.0f, max_threads);
+    benchmark_meshlets (scene, range_index, 0.0f, max_threads);
+    benchmark_mesh_sdf (scene, range_index, 0.0f, max_threads);
 }
 
 void Application::run () {
@@ -94,9 +253,15 @@ void Application::init_vulkan () {
 
 void Application::init_renderer () {
     this->renderer = std::make_unique <MeshShaderRenderer> (this->vulkan_context);
+    if (this->render_meshlets) {
+        const int max_threads = std::max (1u, std::thread::hardware_concurrency ());
+        const Mesh mesh = extract_mesh ("./assets/sdf/example_octree_large.octree", max_threads);
+        this->renderer->init (this->width, this->height, mesh, build_and_report_meshlets (mesh, max_threads));
+        return;
+    }
     SdfOctree scene {};
     load_sdf_octree (scene, "./assets/sdf/example_octree_large.octree");
-    this->renderer->init (this->width, this->height, std::move (scene));
+    this->renderer->init (this->width, this->height, std::move (scene), this->octree_encoding);
 }
 
 void Application::cleanup () {
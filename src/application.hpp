@@ -7,6 +7,7 @@
 #include "GLFW/glfw3.h"
 
 #include "camera.hpp"
+#include "marching_cubes.hpp"
 #include "mesh_shader_renderer.hpp"
 #include "vulkan_context.hpp"
 
@@ -15,11 +16,19 @@ namespace sdf_raster {
 class Application {
 public:
     Application(int a_width, int a_height);
-    Application(int width, int height, const std::string& title);
+    // With a_render_meshlets the window draws the extracted mesh through meshlets instead of the octree; otherwise the
+    // octree nodes are uploaded in a_octree_encoding.
+    Application(int width, int height, const std::string& title, bool a_render_meshlets = false, SdfOctreeEncoding a_octree_encoding = SdfOctreeEncoding::Float32);
     ~Application();
 
     void run();
-    void marching_cubes_cpu (const std::string& a_octree_filename, const std::string& a_mesh_filename);
+    void marching_cubes_cpu (const std::string& a_octree_filename, const std::string& a_mesh_filename, float a_simplify_ratio = 1.0f, bool a_write_meshlets = false, MarchingCubesGrid a_grid = MarchingCubesGrid::Primal);
+    void stream_marching_cubes_cpu (const std::string& a_octree_filename, const std::string& a_mesh_filename, size_t a_memory_cap);
+    // Builds an octree from the expression in a_expression_filename (see parse_sdf_expression) and writes it.
+    void build_sdf_octree_cpu (const std::string& a_expression_filename, const std::string& a_octree_filename, unsigned int a_max_depth, float a_max_error);
+    // Builds an octree from an OBJ or STL mesh (see build_sdf_octree_from_mesh) and writes it.
+    void mesh_to_sdf_octree_cpu (const std::string& a_mesh_filename, const std::string& a_octree_filename, unsigned int a_max_depth, float a_max_error);
+    void run_benchmarks (const std::string& a_octree_filename);
 
 private:
     void cleanup ();
@@ -38,6 +47,8 @@ private:
     int width;
     int height;
     std::string window_title;
+    bool render_meshlets = false;
+    SdfOctreeEncoding octree_encoding = SdfOctreeEncoding::Float32;
 
     Camera camera;
     float last_x = 0.0f;
@@ -0,0 +1,533 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+#include "benchmarks.hpp"
+#include "compact_mesh.hpp"
+#include "dual_contouring.hpp"
+#include "extraction_workspace.hpp"
+#include "marching_cubes.hpp"
+#include "mesh_export.hpp"
+#include "mesh_reorder.hpp"
+#include "mesh_sdf.hpp"
+#include "mesh_simplify.hpp"
+#include "mesh_weld.hpp"
+#include "meshlet.hpp"
+#include "sdf_octree_builder.hpp"
+
+namespace sdf_raster {
+
+namespace {
+
+std::vector <LiteMath::float3> random_points (size_t count, unsigned seed) {
+    std::mt19937 rng (seed);
+    std::uniform_real_distribution <float> dist (-1.0f, 1.0f);
+    std::vector <LiteMath::float3> points (count);
+    for (auto& p : points) {
+        p = {dist (rng), dist (rng), dist (rng)};
+    }
+    return points;
+}
+
+// A bit of everything the expression compiler handles: smooth and sharp CSG, nested transforms and rounding.
+const char* const BENCHMARK_SCENE = R"(
+(union
+  (smooth-union 0.1
+    (sphere 0.4)
+    (translate 0.45 0 0 (rotate 0 0 1 30 (box 0.2 0.1 0.15)))
+    (translate -0.4 0.1 0 (scale 0.5 (torus 0.4 0.1))))
+  (subtract (translate 0 -0.5 0 (cylinder 0.3 0.1)) (capsule -0.5 -0.5 0 0.5 -0.5 0 0.08))
+  (round 0.02 (translate 0 0.55 0.2 (rotate 1 1 0 20 (box 0.15 0.08 0.08)))))
+)";
+
+template <typename Function>
+double measure_ns_per_item (size_t items_count, Function&& function) {
+    const auto start = std::chrono::steady_clock::now ();
+    function ();
+    const auto end = std::chrono::steady_clock::now ();
+    return std::chrono::duration <double, std::nano> (end - start).count () / static_cast <double> (items_count);
+}
+
+double sample_latency (const SdfOctreeView& scene, const std::vector <LiteMath::float3>& points) {
+    volatile float sink = 0.0f;
+    // Warm-up pass, so every layout is measured with the same (hot) page-cache state.
+    for (size_t i = 0; i < points.size (); i += 64) {
+        sink = sink + sample_sdf (scene, points [i]);
+    }
+    return measure_ns_per_item (points.size (), [&] {
+        float sum = 0.0f;
+        for (const auto& p : points) {
+            sum += sample_sdf (scene, p);
+        }
+        sink = sum;
+    });
+}
+
+struct SurfaceError {
+  double mean = 0.0;
+  double max = 0.0;
+};
+
+// |f - iso| over the vertices of the mesh.
+SurfaceError surface_error (const SdfOctreeView& scene, const Mesh& mesh, float iso_level) {
+    SurfaceError result;
+    for (const auto& vertex : mesh.get_vertices ()) {
+        const double error = std::fabs (sample_sdf (scene, vertex.position) - iso_level);
+        result.mean += error;
+        result.max = std::max (result.max, error);
+    }
+    result.mean /= std::max (mesh.get_vertices ().size (), size_t {1});
+    return result;
+}
+
+void print_extraction_result (const char* name, const SdfOctreeView& scene, float iso_level, double seconds, const Mesh& mesh) {
+    // Vertices sit on the interpolated surface only up to the placement error of the engine.
+    const SurfaceError error = surface_error (scene, mesh, iso_level);
+    printf ("  %-18s %8.1f ms %9u vertices %9u triangles   |f - iso| mean %.2e max %.2e\n"
+            , name
+            , seconds * 1e3
+            , (unsigned) mesh.get_vertices ().size ()
+            , (unsigned) mesh.get_indices ().size () / 3
+            , error.mean
+            , error.max
+            );
+}
+
+template <typename Function>
+Mesh measure_extraction (double& seconds, Function&& function) {
+    const auto start = std::chrono::steady_clock::now ();
+    Mesh mesh = function ();
+    seconds = std::chrono::duration <double> (std::chrono::steady_clock::now () - start).count ();
+    return mesh;
+}
+
+}
+
+void benchmark_octree_layouts (const SdfOctreeView& scene, size_t queries_count) {
+    const auto points = random_points (queries_count, 42);
+
+    printf ("sample_sdf latency, %u nodes, %u random queries:\n", (unsigned) scene.size (), (unsigned) queries_count);
+    printf ("  %-18s %8.1f ns/query\n", "source order", sample_latency (scene, points));
+
+    const std::pair <SdfOctreeLayout, const char*> layouts [] = {
+        {SdfOctreeLayout::DepthFirst, "depth-first"}
+        , {SdfOctreeLayout::BreadthFirstHot, "bfs + hot top"}
+        , {SdfOctreeLayout::VanEmdeBoas, "van Emde Boas"}
+    };
+    for (const auto& [layout, name] : layouts) {
+        SdfOctree reordered;
+        reorder_sdf_octree (scene, reordered, layout);
+        printf ("  %-18s %8.1f ns/query\n", name, sample_latency (reordered, points));
+    }
+}
+
+void benchmark_sdf_octree_builder (int max_threads) {
+    const SdfProgram program = compile_sdf_expression (parse_sdf_expression (BENCHMARK_SCENE));
+
+    const auto points = random_points (1 << 20, 7);
+    std::vector <float> xs (points.size ()), ys (points.size ()), zs (points.size ()), distances (points.size ());
+    for (size_t i = 0; i < points.size (); ++i) {
+        xs [i] = points [i].x;
+        ys [i] = points [i].y;
+        zs [i] = points [i].z;
+    }
+    const double ns_per_point = measure_ns_per_item (points.size (), [&] {
+        program.evaluate (xs.data (), ys.data (), zs.data (), distances.data (), points.size ());
+    });
+    printf ("SDF expression, %u instructions, %u registers: %.1f ns/point\n"
+            , (unsigned) program.instructions.size ()
+            , program.register_count
+            , ns_per_point
+            );
+
+    for (unsigned int depth : {6u, 8u, 10u}) {
+        for (int threads : {1, max_threads}) {
+            SdfOctreeBuildSettings settings;
+            settings.max_depth = depth;
+            settings.max_threads = threads;
+            SdfOctree octree;
+            const auto start = std::chrono::steady_clock::now ();
+            const SdfOctreeBuildStats stats = build_sdf_octree (program, octree, settings);
+            const double seconds = std::chrono::duration <double> (std::chrono::steady_clock::now () - start).count ();
+            printf ("  depth %2u x%d %8.1f ms, %u nodes, %u leaves, %u evaluations\n"
+                    , depth
+                    , threads
+                    , seconds * 1e3
+                    , (unsigned) stats.nodes
+                    , (unsigned) stats.leaves
+                    , (unsigned) stats.evaluations
+                    );
+        }
+    }
+}
+
+void benchmark_extraction_engines (const SdfOctreeView& scene, const SdfOctreeRangeIndex& range_index, float iso_level, int max_threads) {
+    MarchingCubesSettings mc_settings;
+    mc_settings.iso_level = iso_level;
+    mc_settings.max_threads = max_threads;
+    mc_settings.normals = MarchingCubesNormals::LeafGradient;
+    mc_settings.weld_vertices = true;
+    mc_settings.range_index = &range_index;
+
+    DualContouringSettings dc_settings;
+    dc_settings.iso_level = iso_level;
+    dc_settings.max_threads = max_threads;
+    dc_settings.range_index = &range_index;
+
+    std::vector <std::pair <const char*, double>> timings;
+    std::vector <Mesh> meshes;
+    auto run = [&] (const char* name, auto&& extract) {
+        double seconds = 0.0;
+        meshes.push_back (measure_extraction (seconds, extract));
+        timings.emplace_back (name, seconds);
+    };
+
+    run ("mc primal", [&] { return create_mesh_marching_cubes (mc_settings, scene); });
+    mc_settings.grid = MarchingCubesGrid::Dual;
+    run ("mc dual", [&] { return create_mesh_marching_cubes (mc_settings, scene); });
+    run ("dc qef", [&] { return create_mesh_dual_contouring (dc_settings, scene); });
+    dc_settings.vertex_placement = DualContouringVertex::MassPoint;
+    run ("dc mass point", [&] { return create_mesh_dual_contouring (dc_settings, scene); });
+    dc_settings.vertex_placement = DualContouringVertex::Qef;
+    dc_settings.simplify_tolerance = 1e-3f;
+    run ("dc simplified", [&] { return create_mesh_dual_contouring (dc_settings, scene); });
+
+    printf ("Surface extraction, %u nodes, %d threads:\n", (unsigned) scene.size (), max_threads);
+    for (size_t i = 0; i < meshes.size (); ++i) {
+        print_extraction_result (timings [i].first, scene, iso_level, timings [i].second, meshes [i]);
+    }
+}
+
+void benchmark_marching_cubes_cases (const SdfOctreeView& scene, const SdfOctreeRangeIndex& range_index, float iso_level, int max_threads) {
+    constexpr int repetitions = 5;
+
+    MarchingCubesSettings settings;
+    settings.iso_level = iso_level;
+    settings.max_threads = max_threads;
+    settings.normals = MarchingCubesNormals::LeafGradient;
+    settings.deterministic = true;
+    settings.range_index = &range_index;
+
+    printf ("Marching cubes case kernels, %u nodes, %d threads, best of %d:\n", (unsigned) scene.size (), max_threads, repetitions);
+    for (const bool weld : {false, true}) {
+        settings.weld_vertices = weld;
+
+        double best [2] = {1e30, 1e30};
+        Mesh meshes [2];
+        const MarchingCubesCases cases [2] = {MarchingCubesCases::TableDriven, MarchingCubesCases::Specialized};
+        for (int repetition = 0; repetition < repetitions; ++repetition) {
+            for (int i = 0; i < 2; ++i) {
+                settings.cases = cases [i];
+                double seconds = 0.0;
+                meshes [i] = measure_extraction (seconds, [&] { return create_mesh_marching_cubes (settings, scene); });
+                best [i] = std::min (best [i], seconds);
+            }
+        }
+
+        const bool identical = meshes [0].get_indices () == meshes [1].get_indices ()
+            && meshes [0].get_vertices () == meshes [1].get_vertices ();
+        printf ("  %-18s table %8.1f ms   specialized %8.1f ms   %.2fx%s\n"
+                , weld ? "welded" : "soup"
+                , best [0] * 1e3
+                , best [1] * 1e3
+                , best [0] / best [1]
+                , identical ? "" : "   OUTPUT DIFFERS"
+                );
+    }
+}
+
+void benchmark_extraction_workspace (const SdfOctreeView& scene, const SdfOctreeRangeIndex& range_index, float iso_level, int max_threads) {
+    constexpr int repetitions = 5;
+    constexpr double mib = 1024.0 * 1024.0;
+
+    MarchingCubesSettings settings;
+    settings.iso_level = iso_level;
+    settings.max_threads = max_threads;
+    settings.normals = MarchingCubesNormals::LeafGradient;
+    settings.deterministic = true;
+    settings.weld_vertices = true;
+    settings.range_index = &range_index;
+
+    double best [2] = {1e30, 1e30};
+    ExtractionWorkspace reused;
+    for (int repetition = 0; repetition < repetitions; ++repetition) {
+        double seconds = 0.0;
+        {
+            ExtractionWorkspace fresh;
+            settings.workspace = &fresh;
+            measure_extraction (seconds, [&] { return create_mesh_marching_cubes (settings, scene); });
+            best [0] = std::min (best [0], seconds);
+        }
+        settings.workspace = &reused;
+        measure_extraction (seconds, [&] { return create_mesh_marching_cubes (settings, scene); });
+        best [1] = std::min (best [1], seconds);
+    }
+
+    const ExtractionWorkspaceStats stats = reused.stats ();
+    printf ("Extraction workspace, %u nodes, %d threads, best of %d:\n", (unsigned) scene.size (), max_threads, repetitions);
+    printf ("  fresh %8.1f ms   reused %8.1f ms   %.2fx\n", best [0] * 1e3, best [1] * 1e3, best [0] / best [1]);
+    printf ("  %u calls: %.1f MiB handed out, peak %.1f MiB, %.1f MiB reserved in %u heap blocks, thread meshes keep %.1f MiB\n"
+            , (unsigned) stats.extractions
+            , stats.arenas.bytes_allocated / mib
+            , stats.arenas.peak_bytes / mib
+            , stats.arenas.reserved_bytes / mib
+            , (unsigned) stats.arenas.heap_allocations
+            , stats.thread_mesh_bytes / mib
+            );
+}
+
+void benchmark_compact_mesh (const SdfOctreeView& scene, const SdfOctreeRangeIndex& range_index, float iso_level, int max_threads) {
+    constexpr double mib = 1024.0 * 1024.0;
+    const std::string filename = "benchmark_compact_mesh.glb";
+
+    MarchingCubesSettings settings;
+    settings.iso_level = iso_level;
+    settings.max_threads = max_threads;
+    settings.normals = MarchingCubesNormals::LeafGradient;
+    settings.deterministic = true;
+    settings.weld_vertices = true;
+    settings.range_index = &range_index;
+    Mesh mesh = create_mesh_marching_cubes (settings, scene);
+    mesh.get_mutable_vertices ().shrink_to_fit ();
+    mesh.get_mutable_indices ().shrink_to_fit ();
+
+    MeshExportSettings export_settings;
+    export_settings.max_threads = max_threads;
+    auto seconds_since = [] (std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration <double> (std::chrono::steady_clock::now () - start).count ();
+    };
+
+    const size_t vertex_count = std::max (mesh.get_vertices ().size (), size_t {1});
+    const size_t index_bytes = mesh.get_indices ().size () * sizeof (uint32_t);
+    const size_t mesh_bytes = mesh_memory_bytes (mesh);
+    auto start = std::chrono::steady_clock::now ();
+    save_mesh_as_glb (mesh, filename, export_settings);
+    const double mesh_export_seconds = seconds_since (start);
+
+    printf ("Compact mesh, %u vertices, %u triangles:\n", (unsigned) mesh.get_vertices ().size (), (unsigned) mesh.get_indices ().size () / 3);
+    printf ("  %-22s %6.1f B/vertex %8.1f MiB                               glb %8.1f ms\n"
+            , "Mesh (float AoS)"
+            , double (mesh_bytes - index_bytes) / vertex_count
+            , mesh_bytes / mib
+            , mesh_export_seconds * 1e3
+            );
+
+    const std::pair <const char*, CompactMeshLayout> layouts [] = {
+        {"float, float normals", {MeshPositionEncoding::Float32, MeshNormalEncoding::Float32, false}}
+        , {"unorm16, oct16", {MeshPositionEncoding::Unorm16, MeshNormalEncoding::Octahedral16, false}}
+        , {"unorm16, oct8", {MeshPositionEncoding::Unorm16, MeshNormalEncoding::Octahedral8, false}}
+        , {"unorm16, no normals", {MeshPositionEncoding::Unorm16, MeshNormalEncoding::None, false}}
+    };
+    for (const auto& [name, layout] : layouts) {
+        start = std::chrono::steady_clock::now ();
+        const CompactMesh compact (mesh, layout);
+        const double build_seconds = seconds_since (start);
+        start = std::chrono::steady_clock::now ();
+        save_mesh_as_glb (compact, filename, export_settings);
+        const double export_seconds = seconds_since (start);
+
+        const size_t bytes = compact.memory_bytes ();
+        printf ("  %-22s %6.1f B/vertex %8.1f MiB %5.2fx   build %8.1f ms   glb %8.1f ms\n"
+                , name
+                , double (bytes - index_bytes) / vertex_count
+                , bytes / mib
+                , double (mesh_bytes) / bytes
+                , build_seconds * 1e3
+                , export_seconds * 1e3
+                );
+    }
+    std::remove (filename.c_str ());
+}
+
+void benchmark_mesh_weld (const SdfOctreeView& scene, const SdfOctreeRangeIndex& range_index, float iso_level, int max_threads) {
+    MarchingCubesSettings settings;
+    settings.iso_level = iso_level;
+    settings.max_threads = max_threads;
+    settings.range_index = &range_index;
+    const Mesh soup = create_mesh_marching_cubes (settings, scene);
+
+    auto seconds_since = [] (std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration <double> (std::chrono::steady_clock::now () - start).count ();
+    };
+
+    printf ("Mesh weld, %u soup vertices:\n", (unsigned) soup.get_vertices ().size ());
+    for (float tolerance : {0.0f, 1e-4f}) {
+        auto start = std::chrono::steady_clock::now ();
+        Mesh incremental;
+        incremental.set_weld_tolerance (tolerance);
+        for (uint32_t index : soup.get_indices ()) {
+            incremental.add_vertex (soup.get_vertices () [index]);
+        }
+        const double incremental_seconds = seconds_since (start);
+        printf ("  tolerance %g: %u vertices, add_vertex %8.1f ms", tolerance, (unsigned) incremental.get_vertices ().size (), incremental_seconds * 1e3);
+
+        for (int threads : {1, max_threads}) {
+            Mesh mesh = soup;
+            MeshWeldSettings weld_settings;
+            weld_settings.tolerance = tolerance;
+            weld_settings.max_threads = threads;
+            start = std::chrono::steady_clock::now ();
+            weld_mesh (mesh, weld_settings);
+            const double seconds = seconds_since (start);
+            const bool same = mesh.get_indices () == incremental.get_indices ()
+                           && mesh.get_vertices ().size () == incremental.get_vertices ().size ();
+            printf ("   weld_mesh x%d %8.1f ms%s", threads, seconds * 1e3, same ? "" : " (MISMATCH)");
+        }
+        printf ("\n");
+    }
+}
+
+void benchmark_mesh_simplify (const SdfOctreeView& scene, const SdfOctreeRangeIndex& range_index, float iso_level, int max_threads) {
+    MarchingCubesSettings settings;
+    settings.iso_level = iso_level;
+    settings.max_threads = max_threads;
+    settings.normals = MarchingCubesNormals::LeafGradient;
+    settings.deterministic = true;
+    settings.weld_vertices = true;
+    settings.range_index = &range_index;
+    const Mesh mesh = create_mesh_marching_cubes (settings, scene);
+    const size_t triangle_count = mesh.get_indices ().size () / 3;
+
+    printf ("Mesh simplify, %u triangles:\n", (unsigned) triangle_count);
+    for (double ratio : {0.5, 0.1, 0.02}) {
+        printf ("  %4.0f%%:", ratio * 100.0);
+        for (int threads : {1, max_threads}) {
+            Mesh simplified = mesh;
+            MeshSimplifySettings simplify_settings;
+            simplify_settings.target_triangles = size_t (triangle_count * ratio);
+            simplify_settings.max_threads = threads;
+            const auto start = std::chrono::steady_clock::now ();
+            const MeshSimplifyStats stats = simplify_mesh (simplified, simplify_settings);
+            const double seconds = std::chrono::duration <double> (std::chrono::steady_clock::now () - start).count ();
+            const SurfaceError error = surface_error (scene, simplified, iso_level);
+            printf ("   x%d %8.1f ms, %u triangles, %zu passes, error mean %.2e max %.2e"
+                    , threads
+                    , seconds * 1e3
+                    , (unsigned) stats.triangles_after
+                    , stats.passes
+                    , error.mean
+                    , error.max
+                    );
+        }
+        printf ("\n");
+    }
+}
+
+void benchmark_meshlets (const SdfOctreeView& scene, const SdfOctreeRangeIndex& range_index, float iso_level, int max_threads) {
+    MarchingCubesSettings settings;
+    settings.iso_level = iso_level;
+    settings.max_threads = max_threads;
+    settings.normals = MarchingCubesNormals::LeafGradient;
+    settings.deterministic = true;
+    settings.weld_vertices = true;
+    settings.range_index = &range_index;
+    const Mesh mesh = create_mesh_marching_cubes (settings, scene);
+    const size_t triangle_count = mesh.get_indices ().size () / 3;
+
+    printf ("Meshlets, %u triangles:\n", (unsigned) triangle_count);
+    Meshlets meshlets;
+    for (int threads : {1, max_threads}) {
+        MeshletSettings meshlet_settings;
+        meshlet_settings.max_threads = threads;
+        const auto start = std::chrono::steady_clock::now ();
+        meshlets = build_meshlets (mesh, meshlet_settings);
+        const double seconds = std::chrono::duration <double> (std::chrono::steady_clock::now () - start).count ();
+        printf ("  x%d %8.1f ms\n", threads, seconds * 1e3);
+    }
+    if (meshlets.empty ()) {
+        return;
+    }
+
+    // The octree spans [-1, 1]^3; cameras sit outside it on every axis.
+    size_t culled = 0;
+    for (int axis = 0; axis < 3; ++axis) {
+        for (float side : {-3.0f, 3.0f}) {
+            LiteMath::float3 camera {0.0f};
+            camera [axis] = side;
+            for (const MeshletBounds& bounds : meshlets.bounds) {
+                culled += LiteMath::dot (LiteMath::normalize (bounds.cone_apex - camera), bounds.cone_axis) >= bounds.cone_cutoff;
+            }
+        }
+    }
+    printf ("  %u meshlets, %.1f vertices and %.1f triangles each, %.3f vertices per triangle, %.1f%% cone culled\n"
+            , (unsigned) meshlets.size ()
+            , double (meshlets.vertices.size ()) / meshlets.size ()
+            , double (meshlets.triangles.size ()) / meshlets.size ()
+            , double (meshlets.vertices.size ()) / std::max <size_t> (1, meshlets.triangles.size ())
+            , 100.0 * culled / (6.0 * meshlets.size ())
+            );
+}
+
+void benchmark_mesh_reorder (const SdfOctreeView& scene, const SdfOctreeRangeIndex& range_index, float iso_level, int max_threads) {
+    MarchingCubesSettings settings;
+    settings.iso_level = iso_level;
+    settings.max_threads = max_threads;
+    settings.normals = MarchingCubesNormals::LeafGradient;
+    settings.weld_vertices = true;
+    settings.range_index = &range_index;
+    const Mesh mesh = create_mesh_marching_cubes (settings, scene);
+
+    printf ("Mesh reorder, %u triangles:\n", (unsigned) (mesh.get_indices ().size () / 3));
+    for (uint32_t cache_size : {16u, 32u}) {
+        for (int threads : {1, max_threads}) {
+            Mesh reordered = mesh;
+            MeshReorderSettings reorder_settings;
+            reorder_settings.cache_size = cache_size;
+            reorder_settings.max_threads = threads;
+            const auto start = std::chrono::steady_clock::now ();
+            const MeshReorderStats stats = reorder_mesh (reordered, reorder_settings);
+            const double seconds = std::chrono::duration <double> (std::chrono::steady_clock::now () - start).count ();
+            printf ("  cache %2u x%d %8.1f ms, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n"
+                    , cache_size
+                    , threads
+                    , seconds * 1e3
+                    , stats.before.acmr
+                    , stats.after.acmr
+                    , stats.before.atvr
+                    , stats.after.atvr
+                    );
+        }
+    }
+}
+
+void benchmark_mesh_sdf (const SdfOctreeView& scene, const SdfOctreeRangeIndex& range_index, float iso_level, int max_threads) {
+    MarchingCubesSettings mc_settings;
+    mc_settings.iso_level = iso_level;
+    mc_settings.max_threads = max_threads;
+    mc_settings.weld_vertices = true;
+    mc_settings.range_index = &range_index;
+    const Mesh mesh = create_mesh_marching_cubes (mc_settings, scene);
+
+    printf ("Mesh to SDF octree, %u triangles:\n", (unsigned) (mesh.get_indices ().size () / 3));
+    for (unsigned int depth : {6u, 8u}) {
+        for (int threads : {1, max_threads}) {
+            MeshSdfSettings settings;
+            settings.octree.max_depth = depth;
+            settings.octree.max_threads = threads;
+            SdfOctree octree;
+            const MeshSdfStats stats = build_sdf_octree_from_mesh (mesh, octree, settings);
+
+            // The source mesh in octree space, whose vertices are on the new octree's zero surface up to its
+            // interpolation error; reported in mesh units.
+            Mesh placed = mesh;
+            for (Vertex& vertex : placed.get_mutable_vertices ()) {
+                vertex.position = (vertex.position - stats.center) * stats.scale;
+            }
+            const SurfaceError error = surface_error (octree, placed, 0.0f);
+            printf ("  depth %u x%d bvh %6.1f ms, octree %8.1f ms, %u nodes, %u evaluations   |f| mean %.2e max %.2e\n"
+                    , depth
+                    , threads
+                    , stats.bvh_seconds * 1e3
+                    , stats.octree_seconds * 1e3
+                    , (unsigned) stats.octree.nodes
+                    , (unsigned) stats.octree.evaluations
+                    , error.mean / stats.scale
+                    , error.max / stats.scale
+                    );
+        }
+    }
+}
+
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+
+#include "sdf_octree.hpp"
+#include "sdf_octree_range.hpp"
+
+namespace sdf_raster {
+
+// Per-query sample_sdf latency for the source node order and every SdfOctreeLayout.
+void benchmark_octree_layouts (const SdfOctreeView& scene, size_t queries_count);
+
+// Time per point of a compiled SDF expression, and of build_sdf_octree from it at a few depths on one thread and on
+// max_threads.
+void benchmark_sdf_octree_builder (int max_threads);
+
+// Time, output size and distance of the vertices to the iso surface for marching cubes (primal and dual grid) and
+// dual contouring, all welded and range-pruned.
+void benchmark_extraction_engines (const SdfOctreeView& scene, const SdfOctreeRangeIndex& range_index, float iso_level, int max_threads);
+
+// Table-driven against specialized marching cubes case kernels, as triangle soup and welded; both produce the same mesh.
+void benchmark_marching_cubes_cases (const SdfOctreeView& scene, const SdfOctreeRangeIndex& range_index, float iso_level, int max_threads);
+
+// Deterministic welded marching cubes with a fresh ExtractionWorkspace per call against one reused across calls,
+// and the scratch memory statistics of the reused one.
+void benchmark_extraction_workspace (const SdfOctreeView& scene, const SdfOctreeRangeIndex& range_index, float iso_level, int max_threads);
+
+// Memory of a welded marching cubes mesh as Mesh and as CompactMesh in a few layouts, with the time to build each
+// layout and to write it as GLB.
+void benchmark_compact_mesh (const SdfOctreeView& scene, const SdfOctreeRangeIndex& range_index, float iso_level, int max_threads);
+
+// Welding a marching cubes triangle soup vertex by vertex through Mesh::add_vertex against weld_mesh on one thread
+// and on max_threads, exact and with a tolerance; all give the same mesh.
+void benchmark_mesh_weld (const SdfOctreeView& scene, const SdfOctreeRangeIndex& range_index, float iso_level, int max_threads);
+
+// Time and error of simplify_mesh on a welded marching cubes mesh down to a few fractions of its triangles, on one
+// thread and on max_threads.
+void benchmark_mesh_simplify (const SdfOctreeView& scene, const SdfOctreeRangeIndex& range_index, float iso_level, int max_threads);
+
+// ACMR and ATVR of a marching cubes mesh in the order extraction left it and after reorder_mesh, for two cache sizes,
+// and the time of reorder_mesh on one thread and on max_threads. Extraction runs on max_threads without the
+// deterministic merge, as the exporters get it.
+void benchmark_mesh_reorder (const SdfOctreeView& scene, const SdfOctreeRangeIndex& range_index, float iso_level, int max_threads);
+
+// Time of build_meshlets on a welded marching cubes mesh on one thread and on max_threads, how full the meshlets are,
+// and the share of them the normal cone culls seen from the six axis directions.
+void benchmark_meshlets (const SdfOctreeView& scene, const SdfOctreeRangeIndex& range_index, float iso_level, int max_threads);
+
+// Time of build_sdf_octree_from_mesh on a welded marching cubes mesh at a few depths on one thread and on
+// max_threads, and how far the mesh vertices are from the zero surface of the octree it gives.
+void benchmark_mesh_sdf (const SdfOctreeView& scene, const SdfOctreeRangeIndex& range_index, float iso_level, int max_threads);
+
+}
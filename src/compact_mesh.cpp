@@ -0,0 +1,193 @@
+#include <limits>
+#include <stdexcept>
+
+#include "compact_mesh.hpp"
+#include "vk_buffers.h"
+
+namespace sdf_raster {
+
+namespace {
+
+// Streams are padded to whole 32-bit words, the unit the shaders read them in.
+size_t padded_stream_size (size_t count, size_t stride) {
+    return (count * stride + 3) / 4 * 4;
+}
+
+template <typename T>
+void store_at (std::vector <uint8_t>& stream, size_t offset, const T& value) {
+    std::memcpy (stream.data () + offset, &value, sizeof (T));
+}
+
+int16_t quantize_snorm16 (float v) {
+    return static_cast <int16_t> (std::lround (std::clamp (v, -1.0f, 1.0f) * 32767.0f));
+}
+
+int8_t quantize_snorm8 (float v) {
+    return static_cast <int8_t> (std::lround (std::clamp (v, -1.0f, 1.0f) * 127.0f));
+}
+
+uint8_t quantize_unorm8 (float v) {
+    return static_cast <uint8_t> (std::lround (std::clamp (v, 0.0f, 1.0f) * 255.0f));
+}
+
+}
+
+CompactMesh::CompactMesh (const Mesh& mesh, const CompactMeshLayout& a_layout)
+    : layout (a_layout)
+    , count (mesh.get_vertices ().size ())
+    , indices (mesh.get_indices ()) {
+    const auto& vertices = mesh.get_vertices ();
+
+    this->positions.resize (padded_stream_size (this->count, position_stride (this->layout.positions)));
+    if (this->layout.positions == MeshPositionEncoding::Unorm16) {
+        LiteMath::float3 bounds_min {std::numeric_limits <float>::max ()};
+        LiteMath::float3 bounds_max {std::numeric_limits <float>::lowest ()};
+        for (const Vertex& vertex : vertices) {
+            bounds_min = LiteMath::min (bounds_min, vertex.position);
+            bounds_max = LiteMath::max (bounds_max, vertex.position);
+        }
+        if (this->count != 0) {
+            const LiteMath::float3 extent = bounds_max - bounds_min;
+            this->origin = bounds_min;
+            this->step = std::max ({extent.x, extent.y, extent.z}) / 65535.0f;
+        }
+
+        const float inverse_step = this->step > 0.0f ? 1.0f / this->step : 0.0f;
+        for (size_t i = 0; i < this->count; ++i) {
+            const LiteMath::float3 scaled = (vertices [i].position - this->origin) * inverse_step;
+            uint16_t q [3];
+            for (int axis = 0; axis < 3; ++axis) {
+                q [axis] = static_cast <uint16_t> (std::lround (std::clamp (scaled [axis], 0.0f, 65535.0f)));
+            }
+            store_at (this->positions, 6 * i, q);
+        }
+    } else {
+        for (size_t i = 0; i < this->count; ++i) {
+            std::memcpy (this->positions.data () + 12 * i, &vertices [i].position.x, 3 * sizeof (float));
+        }
+    }
+
+    this->normals.resize (padded_stream_size (this->count, normal_stride (this->layout.normals)));
+    for (size_t i = 0; i < this->count && this->layout.normals != MeshNormalEncoding::None; ++i) {
+        const LiteMath::float3& n = vertices [i].normal;
+        if (this->layout.normals == MeshNormalEncoding::Float32) {
+            std::memcpy (this->normals.data () + 12 * i, &n.x, 3 * sizeof (float));
+            continue;
+        }
+        const LiteMath::float2 oct = octahedral_encode (n);
+        if (this->layout.normals == MeshNormalEncoding::Octahedral16) {
+            const int16_t q [2] = {quantize_snorm16 (oct.x), quantize_snorm16 (oct.y)};
+            store_at (this->normals, 4 * i, q);
+        } else {
+            const int8_t q [2] = {quantize_snorm8 (oct.x), quantize_snorm8 (oct.y)};
+            store_at (this->normals, 2 * i, q);
+        }
+    }
+
+    if (this->layout.colors) {
+        this->colors.resize (4 * this->count);
+        for (size_t i = 0; i < this->count; ++i) {
+            const LiteMath::float3& c = vertices [i].color;
+            const uint8_t rgba [4] = {quantize_unorm8 (c.x), quantize_unorm8 (c.y), quantize_unorm8 (c.z), 255};
+            store_at (this->colors, 4 * i, rgba);
+        }
+    }
+}
+
+Mesh CompactMesh::to_mesh () const {
+    std::vector <Vertex> vertices (this->count);
+    for (size_t i = 0; i < this->count; ++i) {
+        vertices [i].position = this->position (i);
+        vertices [i].color = this->color (i);
+        vertices [i].normal = this->normal (i);
+    }
+    std::vector <uint32_t> mesh_indices = this->indices;
+    return Mesh (std::move (mesh_indices), std::move (vertices));
+}
+
+size_t CompactMesh::memory_bytes () const {
+    return this->positions.capacity () + this->normals.capacity () + this->colors.capacity ()
+         + this->indices.capacity () * sizeof (uint32_t);
+}
+
+size_t mesh_memory_bytes (const Mesh& mesh) {
+    return mesh.get_vertices ().capacity () * sizeof (Vertex) + mesh.get_indices ().capacity () * sizeof (uint32_t);
+}
+
+CompactMeshDescriptorSetInfo create_compact_mesh_descriptor_set (
+        VkDevice device
+        , VkPhysicalDevice physical_device
+        , const CompactMesh& mesh
+        , std::shared_ptr <vk_utils::ICopyEngine> copy_helper
+        , vk_utils::DescriptorMaker& ds_maker
+        , VkShaderStageFlags shader_stage_flags) {
+    CompactMeshDescriptorSetInfo info = {};
+
+    if (!copy_helper) {
+        throw std::runtime_error ("ICopyEngine shared_ptr cannot be null.");
+    }
+    if (mesh.is_empty () || mesh.get_indices ().empty ()) {
+        throw std::runtime_error ("CompactMesh is empty, cannot create descriptor set.");
+    }
+
+    // Streams in binding order; absent attributes keep a null buffer and take no binding.
+    struct Stream {
+        VkBuffer* buffer;
+        const void* data;
+        VkDeviceSize size;
+    };
+    const std::vector <Stream> streams = {
+        {&info.index_buffer, mesh.get_indices ().data (), mesh.get_indices ().size () * sizeof (uint32_t)}
+        , {&info.position_buffer, mesh.get_positions ().data (), mesh.get_positions ().size ()}
+        , {&info.normal_buffer, mesh.get_normals ().data (), mesh.get_normals ().size ()}
+        , {&info.color_buffer, mesh.get_colors ().data (), mesh.get_colors ().size ()}
+    };
+
+    std::vector <VkBuffer> buffers;
+    for (const Stream& stream : streams) {
+        if (stream.size == 0) {
+            continue;
+        }
+        VkMemoryRequirements memReq;
+        *stream.buffer = vk_utils::createBuffer (
+                device
+                , stream.size
+                , VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT
+                , &memReq
+                );
+        buffers.push_back (*stream.buffer);
+    }
+
+    info.memory = vk_utils::allocateAndBindWithPadding (device, physical_device, buffers);
+
+    ds_maker.BindBegin (shader_stage_flags);
+    uint32_t binding = 0;
+    for (const Stream& stream : streams) {
+        if (stream.size == 0) {
+            continue;
+        }
+        copy_helper->UpdateBuffer (*stream.buffer, 0, stream.data, stream.size);
+        ds_maker.BindBuffer (binding++, *stream.buffer, VK_NULL_HANDLE, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+    }
+    ds_maker.BindEnd (&info.descriptor_set, &info.descriptor_set_layout);
+
+    return info;
+}
+
+void cleanup_compact_mesh_descriptor_set (VkDevice device, CompactMeshDescriptorSetInfo& info) {
+    for (VkBuffer* buffer : {&info.index_buffer, &info.position_buffer, &info.normal_buffer, &info.color_buffer}) {
+        if (*buffer != VK_NULL_HANDLE) {
+            vkDestroyBuffer (device, *buffer, nullptr);
+            *buffer = VK_NULL_HANDLE;
+        }
+    }
+
+    if (info.memory != VK_NULL_HANDLE) {
+        vkFreeMemory (device, info.memory, nullptr);
+        info.memory = VK_NULL_HANDLE;
+    }
+
+    info = {};
+}
+
+}
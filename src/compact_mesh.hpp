@@ -0,0 +1,188 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "LiteMath.h"
+#include "mesh.hpp"
+#include "vk_copy.h"
+#include "vk_descriptor_sets.h"
+#include "vk_utils.h"
+
+namespace sdf_raster {
+
+enum class MeshPositionEncoding {
+    Float32, // 12 bytes: x, y, z
+    Unorm16, // 6 bytes: 16 bits per axis on a cubic lattice over the bounding box, one step for all axes
+};
+
+enum class MeshNormalEncoding {
+    None,
+    Float32,      // 12 bytes: x, y, z
+    Octahedral16, // 4 bytes: octahedral map, 16-bit snorm per coordinate, well under 0.1 degrees of error
+    Octahedral8,  // 2 bytes: octahedral map, 8-bit snorm per coordinate, about 1 degree of error
+};
+
+struct CompactMeshLayout {
+  MeshPositionEncoding positions = MeshPositionEncoding::Unorm16;
+  MeshNormalEncoding normals = MeshNormalEncoding::Octahedral16;
+  bool colors = false; // RGBA8, 4 bytes; extractors leave Vertex::color at zero
+};
+
+inline size_t position_stride (MeshPositionEncoding encoding) {
+    return encoding == MeshPositionEncoding::Unorm16 ? 3 * sizeof (uint16_t) : 3 * sizeof (float);
+}
+
+inline size_t normal_stride (MeshNormalEncoding encoding) {
+    switch (encoding) {
+        case MeshNormalEncoding::None: return 0;
+        case MeshNormalEncoding::Float32: return 3 * sizeof (float);
+        case MeshNormalEncoding::Octahedral16: return 2 * sizeof (int16_t);
+        case MeshNormalEncoding::Octahedral8: return 2 * sizeof (int8_t);
+    }
+    return 0;
+}
+
+// Octahedral map of a unit vector to [-1, 1]^2: the upper half projects straight down, the lower half is folded
+// over the diagonals.
+inline LiteMath::float2 octahedral_encode (const LiteMath::float3& n) {
+    const float sum = std::fabs (n.x) + std::fabs (n.y) + std::fabs (n.z);
+    if (sum == 0.0f) {
+        return {0.0f, 0.0f};
+    }
+    float x = n.x / sum;
+    float y = n.y / sum;
+    if (n.z < 0.0f) {
+        const float folded_x = (1.0f - std::fabs (y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        const float folded_y = (1.0f - std::fabs (x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = folded_x;
+        y = folded_y;
+    }
+    return {x, y};
+}
+
+inline LiteMath::float3 octahedral_decode (float x, float y) {
+    const float z = 1.0f - std::fabs (x) - std::fabs (y);
+    const float t = std::max (-z, 0.0f);
+    x += x >= 0.0f ? -t : t;
+    y += y >= 0.0f ? -t : t;
+    return LiteMath::normalize (LiteMath::float3 {x, y, z});
+}
+
+// Mesh with one tightly packed array per attribute and only the attributes the layout asks for, positions and
+// normals optionally quantized. Built from a Mesh once extraction (which needs the float vertices for welding and
+// normal estimation) is done; the exporters and the GPU upload read the streams as they are.
+//
+// Quantized positions decode to origin + q * step with the same step on every axis, so the decoded mesh is the
+// original one scaled uniformly and normals stay valid.
+class CompactMesh {
+public:
+  CompactMesh () = default;
+  explicit CompactMesh (const Mesh& mesh, const CompactMeshLayout& layout = {});
+
+  const CompactMeshLayout& get_layout () const { return this->layout; }
+  size_t vertex_count () const { return this->count; }
+  bool has_normals () const { return this->layout.normals != MeshNormalEncoding::None; }
+  bool has_colors () const { return this->layout.colors; }
+  bool is_empty () const { return this->count == 0; }
+
+  // Raw streams, `position_stride (layout.positions)` (and so on) bytes per vertex.
+  const std::vector <uint8_t>& get_positions () const { return this->positions; }
+  const std::vector <uint8_t>& get_normals () const { return this->normals; }
+  const std::vector <uint8_t>& get_colors () const { return this->colors; }
+  const std::vector <uint32_t>& get_indices () const { return this->indices; }
+
+  // Unorm16 only: decoded position = quantization_origin + q * quantization_step.
+  const LiteMath::float3& get_quantization_origin () const { return this->origin; }
+  float get_quantization_step () const { return this->step; }
+
+  LiteMath::float3 position (size_t i) const {
+      if (this->layout.positions == MeshPositionEncoding::Unorm16) {
+          uint16_t q [3];
+          std::memcpy (q, this->positions.data () + 6 * i, sizeof (q));
+          return this->origin + LiteMath::float3 {float (q [0]), float (q [1]), float (q [2])} * this->step;
+      }
+      LiteMath::float3 p;
+      std::memcpy (&p.x, this->positions.data () + 12 * i, 3 * sizeof (float));
+      return p;
+  }
+
+  LiteMath::float3 normal (size_t i) const {
+      switch (this->layout.normals) {
+          case MeshNormalEncoding::Float32: {
+              LiteMath::float3 n;
+              std::memcpy (&n.x, this->normals.data () + 12 * i, 3 * sizeof (float));
+              return n;
+          }
+          case MeshNormalEncoding::Octahedral16: {
+              int16_t q [2];
+              std::memcpy (q, this->normals.data () + 4 * i, sizeof (q));
+              return octahedral_decode (q [0] / 32767.0f, q [1] / 32767.0f);
+          }
+          case MeshNormalEncoding::Octahedral8: {
+              const int8_t* q = reinterpret_cast <const int8_t*> (this->normals.data () + 2 * i);
+              return octahedral_decode (q [0] / 127.0f, q [1] / 127.0f);
+          }
+          case MeshNormalEncoding::None:
+              break;
+      }
+      return LiteMath::float3 {0.0f};
+  }
+
+  LiteMath::float3 color (size_t i) const {
+      if (!this->layout.colors) {
+          return LiteMath::float3 {0.0f};
+      }
+      const uint8_t* rgba = this->colors.data () + 4 * i;
+      return LiteMath::float3 {rgba [0] / 255.0f, rgba [1] / 255.0f, rgba [2] / 255.0f};
+  }
+
+  // Decodes every vertex back to the float layout; attributes left out come back as zero.
+  Mesh to_mesh () const;
+
+  // Bytes held by the streams and indices.
+  size_t memory_bytes () const;
+
+private:
+  CompactMeshLayout layout;
+  size_t count = 0;
+  std::vector <uint8_t> positions;
+  std::vector <uint8_t> normals;
+  std::vector <uint8_t> colors;
+  std::vector <uint32_t> indices;
+  LiteMath::float3 origin {0.0f};
+  float step = 0.0f;
+};
+
+// Bytes the float Mesh holds for the same data, for comparison with CompactMesh::memory_bytes.
+size_t mesh_memory_bytes (const Mesh& mesh);
+
+// Storage buffers of a CompactMesh for the shaders: binding 0 holds the indices, 1 the positions, then the normals
+// and the colors when the layout has them, each stream exactly as it is laid out in memory. shaders/common.h
+// decodes them.
+struct CompactMeshDescriptorSetInfo {
+  VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
+  VkDescriptorSetLayout descriptor_set_layout = VK_NULL_HANDLE;
+
+  VkBuffer index_buffer = VK_NULL_HANDLE;
+  VkBuffer position_buffer = VK_NULL_HANDLE;
+  VkBuffer normal_buffer = VK_NULL_HANDLE;
+  VkBuffer color_buffer = VK_NULL_HANDLE;
+  VkDeviceMemory memory = VK_NULL_HANDLE;
+};
+
+CompactMeshDescriptorSetInfo create_compact_mesh_descriptor_set (
+    VkDevice device
+    , VkPhysicalDevice physical_device
+    , const CompactMesh& mesh
+    , std::shared_ptr <vk_utils::ICopyEngine> copy_helper
+    , vk_utils::DescriptorMaker& ds_maker
+    , VkShaderStageFlags shader_stage_flags);
+
+void cleanup_compact_mesh_descriptor_set (VkDevice device, CompactMeshDescriptorSetInfo& info);
+
+}
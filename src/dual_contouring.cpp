@@ -0,0 +1,288 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "dual_contouring.hpp"
+#include "mesh_weld.hpp"
+#include "octree_traversal.hpp"
+
+namespace sdf_raster {
+
+namespace {
+
+constexpr unsigned int TASK_SPAWN_DEPTH = 3;
+constexpr float QEF_REGULARIZATION = 0.05f; // pull towards the mass point, keeps near-planar quadrics well conditioned
+
+// Cube edges as (corner, axis): the other end of the edge is corner | (1 << axis).
+constexpr int cube_edges [12] [2] = {
+    {0, 0}, {2, 0}, {4, 0}, {6, 0}
+    , {0, 1}, {1, 1}, {4, 1}, {5, 1}
+    , {0, 2}, {1, 2}, {2, 2}, {3, 2}
+};
+
+// Max |field - trilinear patch of the node| over each subtree, bounded through the children: the difference between
+// a child's patch and its parent's is trilinear on the child, so it peaks at the child's corners.
+template <typename Octree>
+ScratchVector <float> subtree_deviations (const Octree& scene, ScratchArena& arena) {
+    ScratchVector <VoxelInfo> order (1, octree_root_voxel_info (), &arena);
+    for (size_t i = 0; i < order.size (); ++i) {
+        const uint32_t offset = scene [order [i].node_index].offset;
+        if (offset == 0) {
+            continue;
+        }
+        if (order.size () + 8 > scene.size ()) {
+            throw std::runtime_error {"[create_mesh_dual_contouring]: node is reachable twice."};
+        }
+        for (unsigned int k = 0; k < 8; ++k) {
+            order.push_back (child_voxel_info (scene, order [i], offset, k));
+        }
+    }
+
+    ScratchVector <float> deviations (scene.size (), 0.0f, &arena);
+    for (size_t i = order.size (); i-- > 0;) {
+        const uint32_t offset = scene [order [i].node_index].offset;
+        if (offset == 0) {
+            continue;
+        }
+
+        float parent_values [8];
+        load_leaf_values (scene, order [i], parent_values);
+
+        float deviation = 0.0f;
+        for (unsigned int k = 0; k < 8; ++k) {
+            VoxelInfo child = child_voxel_info (scene, order [i], offset, k);
+            float child_values [8];
+            load_leaf_values (scene, child, child_values);
+
+            float local = 0.0f;
+            for (unsigned int c = 0; c < 8; ++c) {
+                const LiteMath::float3 position {
+                    0.5f * static_cast <float> (((k >> 0) & 1) + ((c >> 0) & 1))
+                    , 0.5f * static_cast <float> (((k >> 1) & 1) + ((c >> 1) & 1))
+                    , 0.5f * static_cast <float> (((k >> 2) & 1) + ((c >> 2) & 1))
+                };
+                local = std::max (local, std::fabs (child_values [c] - interpolate_trilinear (parent_values, position)));
+            }
+            deviation = std::max (deviation, deviations [child.node_index] + local);
+        }
+        deviations [order [i].node_index] = deviation;
+    }
+    return deviations;
+}
+
+// Solves the 3x3 system by Cramer's rule; returns false when it is singular.
+bool solve_symmetric_3x3 (const float (&a) [6], const LiteMath::float3& b, LiteMath::float3& x) {
+    // a = {xx, xy, xz, yy, yz, zz}
+    const float c00 = a [3] * a [5] - a [4] * a [4];
+    const float c01 = a [2] * a [4] - a [1] * a [5];
+    const float c02 = a [1] * a [4] - a [2] * a [3];
+    const float determinant = a [0] * c00 + a [1] * c01 + a [2] * c02;
+    if (std::fabs (determinant) < 1e-12f) {
+        return false;
+    }
+
+    const float c11 = a [0] * a [5] - a [2] * a [2];
+    const float c12 = a [1] * a [2] - a [0] * a [4];
+    const float c22 = a [0] * a [3] - a [1] * a [1];
+    x.x = (c00 * b.x + c01 * b.y + c02 * b.z) / determinant;
+    x.y = (c01 * b.x + c11 * b.y + c12 * b.z) / determinant;
+    x.z = (c02 * b.x + c12 * b.y + c22 * b.z) / determinant;
+    return true;
+}
+
+Vertex leaf_vertex (const VoxelInfo& voxel_info, const float (&values) [8], const DualContouringSettings& settings) {
+    LiteMath::float3 crossings [12];
+    LiteMath::float3 normals [12];
+    int crossings_count = 0;
+    LiteMath::float3 mass_point {0.0f, 0.0f, 0.0f};
+
+    for (const auto& edge : cube_edges) {
+        const int c0 = edge [0];
+        const int c1 = edge [0] | (1 << edge [1]);
+        if ((values [c0] < settings.iso_level) == (values [c1] < settings.iso_level)) {
+            continue;
+        }
+
+        LiteMath::float3 local {
+            static_cast <float> ((c0 >> 0) & 1)
+            , static_cast <float> ((c0 >> 1) & 1)
+            , static_cast <float> ((c0 >> 2) & 1)
+        };
+        const float t = (settings.iso_level - values [c0]) / (values [c1] - values [c0]);
+        local [edge [1]] = t;
+
+        crossings [crossings_count] = local;
+        normals [crossings_count] = LiteMath::normalize (interpolate_trilinear_with_gradient (values, local, 1.0f).gradient);
+        mass_point += local;
+        ++crossings_count;
+    }
+    mass_point /= static_cast <float> (std::max (crossings_count, 1));
+
+    // Solved in the leaf's unit cube around the mass point, so the regularization does not depend on leaf size.
+    LiteMath::float3 local = mass_point;
+    if (settings.vertex_placement == DualContouringVertex::Qef && crossings_count > 0) {
+        float ata [6] = {QEF_REGULARIZATION, 0.0f, 0.0f, QEF_REGULARIZATION, 0.0f, QEF_REGULARIZATION};
+        LiteMath::float3 atb {0.0f, 0.0f, 0.0f};
+        for (int i = 0; i < crossings_count; ++i) {
+            const LiteMath::float3& n = normals [i];
+            const float d = LiteMath::dot (n, crossings [i] - mass_point);
+            ata [0] += n.x * n.x; ata [1] += n.x * n.y; ata [2] += n.x * n.z;
+            ata [3] += n.y * n.y; ata [4] += n.y * n.z; ata [5] += n.z * n.z;
+            atb += n * d;
+        }
+
+        LiteMath::float3 offset;
+        if (solve_symmetric_3x3 (ata, atb, offset)) {
+            local = mass_point + offset;
+            for (int axis = 0; axis < 3; ++axis) {
+                local [axis] = std::clamp (local [axis], 0.0f, 1.0f);
+            }
+        }
+    }
+
+    Vertex vertex {};
+    vertex.position = voxel_info.min_corner + local * voxel_info.voxel_size;
+    vertex.normal = LiteMath::normalize (interpolate_trilinear_with_gradient (values, local, voxel_info.voxel_size).gradient);
+    return vertex;
+}
+
+// Minimal edges shared by 4 leaves: the edge belongs to the smallest of them, its sign change decides the quad.
+template <typename Octree>
+void emit_quad (const Octree& scene
+                , const VoxelInfo (&nodes) [8]
+                , unsigned int axis
+                , const DualContouringSettings& settings
+                , ThreadMesh& output) {
+    const unsigned int u = axis == 0 ? 1 : 0;
+    const unsigned int v = axis == 2 ? 1 : 2;
+    const unsigned int ring [4] = {0, 1u << u, (1u << u) | (1u << v), 1u << v};
+
+    unsigned int smallest = ring [0];
+    for (unsigned int k : ring) {
+        if (nodes [k].depth > nodes [smallest].depth) {
+            smallest = k;
+        }
+    }
+
+    float values [8];
+    load_leaf_values (scene, nodes [smallest], values);
+    const unsigned int c0 = ~smallest & ((1u << u) | (1u << v));
+    const bool inside_below = values [c0] < settings.iso_level;
+    if (inside_below == (values [c0 | (1u << axis)] < settings.iso_level)) {
+        return;
+    }
+
+    uint32_t indices [4];
+    for (int i = 0; i < 4; ++i) {
+        const VoxelInfo& leaf = nodes [ring [i]];
+        bool inserted = false;
+        uint32_t& index = output.vertex_table.find_or_insert (leaf.node_index, inserted);
+        if (inserted) {
+            float leaf_values [8];
+            load_leaf_values (scene, leaf, leaf_values);
+            index = static_cast <uint32_t> (output.mesh.get_vertices ().size ());
+            output.mesh.get_mutable_vertices ().push_back (leaf_vertex (leaf, leaf_values, settings));
+            output.vertex_keys.push_back (leaf.node_index);
+        }
+        indices [i] = index;
+    }
+
+    // The ring runs counter-clockwise around +axis except for the y axis (x, z is a left-handed pair); faces point
+    // from inside to outside like the marching cubes tables.
+    if ((axis != 1) != inside_below) {
+        std::swap (indices [1], indices [3]);
+    }
+
+    auto& mesh_indices = output.mesh.get_mutable_indices ();
+    const uint32_t triangles [2] [3] = {{indices [0], indices [1], indices [2]}, {indices [0], indices [2], indices [3]}};
+    for (const auto& triangle : triangles) {
+        if (triangle [0] != triangle [1] && triangle [1] != triangle [2] && triangle [0] != triangle [2]) {
+            mesh_indices.insert (mesh_indices.end (), std::begin (triangle), std::end (triangle));
+        }
+    }
+}
+
+template <typename Octree>
+Mesh dual_contouring (const DualContouringSettings& settings, const Octree& scene) {
+    if (scene.empty ()) {
+        throw std::runtime_error {"[create_mesh_dual_contouring]: empty sdf"};
+    }
+    if (settings.range_index != nullptr && settings.range_index->size () != scene.size ()) {
+        throw std::runtime_error {"[create_mesh_dual_contouring]: range index does not match the octree"};
+    }
+
+    Executor& executor = settings.get_executor ();
+    const unsigned int concurrency = static_cast <unsigned int> (std::max (1, settings.max_threads));
+    ExtractionWorkspace& workspace = settings.workspace != nullptr ? *settings.workspace : ExtractionWorkspace::for_current_thread ();
+    workspace.begin (concurrency);
+    ScratchArena& arena = workspace.arena ();
+
+    const ScratchVector <float> deviations = settings.simplify_tolerance > 0.0f ? subtree_deviations (scene, arena) : ScratchVector <float> (&arena);
+    std::vector <ThreadMesh>& thread_meshes = workspace.thread_meshes ();
+
+    const VoxelInfo root = octree_root_voxel_info ();
+    const VoxelInfo nodes [8] = {root, root, root, root, root, root, root, root};
+
+    auto is_leaf = [&] (const VoxelInfo& voxel_info) {
+        return scene [voxel_info.node_index].offset == 0
+            || voxel_info.depth >= settings.max_depth
+            || (!deviations.empty () && deviations [voxel_info.node_index] <= settings.simplify_tolerance);
+    };
+    auto prune = [&] (const VoxelInfo (&block) [8]) {
+        if (settings.range_index == nullptr) {
+            return false;
+        }
+        SdfOctreeRange range = settings.range_index->ranges [block [0].node_index];
+        for (int k = 1; k < 8; ++k) {
+            range.min = std::min (range.min, settings.range_index->ranges [block [k].node_index].min);
+            range.max = std::max (range.max, settings.range_index->ranges [block [k].node_index].max);
+        }
+        return !(range.min < settings.iso_level && range.max >= settings.iso_level);
+    };
+    auto visit = [&] (const VoxelInfo (&block) [8], unsigned int split_mask, unsigned int slot) {
+        // Edge features have exactly two split axes; the remaining one is the edge direction.
+        if (split_mask == 3 || split_mask == 5 || split_mask == 6) {
+            const unsigned int axis = split_mask == 6 ? 0 : (split_mask == 5 ? 1 : 2);
+            emit_quad (scene, block, axis, settings, thread_meshes [slot]);
+        }
+    };
+
+    TaskGroup group (executor, concurrency);
+    group.run ([&] (unsigned int slot) {
+        dual_procedure (scene, nodes, 0, 0, slot, group, TASK_SPAWN_DEPTH, is_leaf, prune, visit);
+    });
+    group.wait ();
+
+    ScratchVector <uint64_t> keys (&arena);
+    Mesh mesh = merge_welded_meshes (thread_meshes, executor, concurrency, arena, settings.deterministic ? &keys : nullptr);
+    if (settings.deterministic) {
+        canonicalize_welded_mesh (mesh, keys, arena);
+    }
+
+    printf ("Dual Contouring: %u vertices, %u triangles\n"
+            , (unsigned) mesh.get_vertices ().size ()
+            , (unsigned) mesh.get_indices ().size () / 3
+            );
+
+    return mesh;
+}
+
+}
+
+Mesh create_mesh_dual_contouring (const DualContouringSettings& settings, const SdfOctreeView& scene) {
+    return dual_contouring (settings, scene);
+}
+
+Mesh create_mesh_dual_contouring (const DualContouringSettings& settings, const SdfOctreeQ8& scene) {
+    return dual_contouring (settings, scene);
+}
+
+Mesh create_mesh_dual_contouring (const DualContouringSettings& settings, const SdfOctreeQ16& scene) {
+    return dual_contouring (settings, scene);
+}
+
+Mesh create_mesh_dual_contouring (const DualContouringSettings& settings, const SharedCornerSdfOctree& scene) {
+    return dual_contouring (settings, scene);
+}
+
+}
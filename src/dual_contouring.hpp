@@ -0,0 +1,33 @@
+#pragma once
+
+#include "executor.hpp"
+#include "extraction_workspace.hpp"
+#include "mesh.hpp"
+#include "sdf_octree_formats.hpp"
+#include "sdf_octree_range.hpp"
+
+namespace sdf_raster {
+
+enum class DualContouringVertex {
+    Qef,       // minimizer of the quadric built from the edge crossings and their normals: keeps sharp features
+    MassPoint, // mean of the edge crossings (surface nets): smoother, no linear solve
+};
+
+// Dual contouring: one vertex per leaf the surface passes through, one quad per octree edge it crosses. Large leaves
+// yield one vertex however big they are, so flat regions come out with far fewer triangles than marching cubes.
+struct DualContouringSettings : ParallelSettings {
+    float iso_level = 0.5f;
+    ExtractionWorkspace* workspace = nullptr; // scratch memory reused across calls; the calling thread's when null
+    DualContouringVertex vertex_placement = DualContouringVertex::Qef;
+    unsigned int max_depth = ~0u;     // level of detail: deeper nodes are contoured as leaves from their own corner values
+    float simplify_tolerance = 0.0f;  // subtrees whose field the node's trilinear patch reproduces within this distance act as one leaf
+    bool deterministic = false;       // same output for any max_threads (canonical vertex and triangle order)
+    const SdfOctreeRangeIndex* range_index = nullptr; // optional, built from the same octree; prunes subtrees without surface
+};
+
+Mesh create_mesh_dual_contouring (const DualContouringSettings& settings, const SdfOctreeView& sdf_octree);
+Mesh create_mesh_dual_contouring (const DualContouringSettings& settings, const SdfOctreeQ8& sdf_octree);
+Mesh create_mesh_dual_contouring (const DualContouringSettings& settings, const SdfOctreeQ16& sdf_octree);
+Mesh create_mesh_dual_contouring (const DualContouringSettings& settings, const SharedCornerSdfOctree& sdf_octree);
+
+}
@@ -0,0 +1,324 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "executor.hpp"
+
+namespace sdf_raster {
+
+namespace {
+
+thread_local const Executor* current_executor = nullptr;
+thread_local size_t current_worker = 0;
+
+thread_local const void* current_group = nullptr;
+thread_local unsigned int current_slot = 0;
+
+std::vector <int> allowed_cpus () {
+    std::vector <int> cpus;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO (&set);
+    if (sched_getaffinity (0, sizeof (set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET (cpu, &set)) {
+                cpus.push_back (cpu);
+            }
+        }
+    }
+#endif
+    return cpus;
+}
+
+void pin_thread (std::thread& thread, int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO (&set);
+    CPU_SET (cpu, &set);
+    if (pthread_setaffinity_np (thread.native_handle (), sizeof (set), &set) != 0) {
+        printf ("Executor: failed to pin a worker to CPU %d\n", cpu);
+    }
+#else
+    (void) thread;
+    (void) cpu;
+#endif
+}
+
+}
+
+std::vector <int> numa_node_cpus (int node) {
+    std::vector <int> cpus;
+    std::ifstream fs ("/sys/devices/system/node/node" + std::to_string (node) + "/cpulist");
+    std::string list;
+    if (!fs || !std::getline (fs, list)) {
+        return cpus;
+    }
+
+    // Comma-separated CPUs and ranges, e.g. "0-3,8-11".
+    std::stringstream ss (list);
+    std::string range;
+    while (std::getline (ss, range, ',')) {
+        const size_t dash = range.find ('-');
+        const int first = std::stoi (range.substr (0, dash));
+        const int last = dash == std::string::npos ? first : std::stoi (range.substr (dash + 1));
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back (cpu);
+        }
+    }
+    return cpus;
+}
+
+Executor::Executor (const ExecutorOptions& options) {
+    const unsigned int thread_count = options.threads != 0 ? options.threads : std::max (1u, std::thread::hardware_concurrency ());
+    const std::vector <int> cpus = options.cpus.empty () ? allowed_cpus () : options.cpus;
+    if (options.affinity != ExecutorAffinity::None && cpus.empty ()) {
+        throw std::runtime_error {"[Executor]: no CPUs to pin workers to"};
+    }
+
+    this->workers.reserve (thread_count);
+    for (unsigned int i = 0; i < thread_count; ++i) {
+        this->workers.push_back (std::make_unique <Worker> ());
+    }
+    for (unsigned int i = 0; i < thread_count; ++i) {
+        Worker& worker = *this->workers [i];
+        worker.thread = std::thread ([this, i] { this->worker_loop (i); });
+
+        if (options.affinity == ExecutorAffinity::Compact) {
+            pin_thread (worker.thread, cpus [i % cpus.size ()]);
+        } else if (options.affinity == ExecutorAffinity::Scatter) {
+            pin_thread (worker.thread, cpus [(static_cast <size_t> (i) * cpus.size () / thread_count) % cpus.size ()]);
+        }
+    }
+}
+
+Executor::~Executor () {
+    {
+        std::lock_guard <std::mutex> lock (this->sleep_mutex);
+        this->stopping = true;
+    }
+    this->sleep_condition.notify_all ();
+    for (auto& worker : this->workers) {
+        worker->thread.join ();
+    }
+}
+
+void Executor::submit (std::function <void ()> job) {
+    // Jobs submitted from a worker stay on it; others are dealt round-robin.
+    const size_t index = current_executor == this ? current_worker : this->next_worker++ % this->workers.size ();
+    {
+        // Counted before it is visible to pop_job, so queued_jobs never drops below the jobs actually queued; the
+        // push stays under sleep_mutex so no waking worker sees the count before the job.
+        std::lock_guard <std::mutex> sleep_lock (this->sleep_mutex);
+        ++this->queued_jobs;
+        std::lock_guard <std::mutex> lock (this->workers [index]->mutex);
+        this->workers [index]->jobs.push_back (std::move (job));
+    }
+    this->sleep_condition.notify_one ();
+}
+
+bool Executor::pop_job (size_t worker_index, std::function <void ()>& job) {
+    const size_t count = this->workers.size ();
+    for (size_t k = 0; k < count; ++k) {
+        Worker& worker = *this->workers [(worker_index + k) % count];
+        std::lock_guard <std::mutex> lock (worker.mutex);
+        if (worker.jobs.empty ()) {
+            continue;
+        }
+        if (k == 0) {
+            job = std::move (worker.jobs.back ());
+            worker.jobs.pop_back ();
+        } else {
+            job = std::move (worker.jobs.front ());
+            worker.jobs.pop_front ();
+        }
+        --this->queued_jobs;
+        return true;
+    }
+    return false;
+}
+
+void Executor::worker_loop (size_t worker_index) {
+    current_executor = this;
+    current_worker = worker_index;
+
+    while (true) {
+        std::function <void ()> job;
+        if (this->pop_job (worker_index, job)) {
+            job ();
+            continue;
+        }
+
+        std::unique_lock <std::mutex> lock (this->sleep_mutex);
+        this->sleep_condition.wait (lock, [this] { return this->stopping || this->queued_jobs > 0; });
+        if (this->stopping && this->queued_jobs == 0) {
+            return;
+        }
+    }
+}
+
+Executor& Executor::shared () {
+    static Executor executor;
+    return executor;
+}
+
+// All bookkeeping is guarded by one mutex: tasks are coarse (whole subtrees, chunks of leaves), so it is rarely hot.
+struct TaskGroup::State {
+    explicit State (unsigned int a_concurrency)
+        : concurrency (std::max (1u, a_concurrency))
+        , slots (concurrency) {
+        for (unsigned int slot = concurrency; slot-- > 1;) {
+            this->free_slots.push_back (slot);
+        }
+    }
+
+    // Own deque from the back, then the other deques from the front.
+    bool take (unsigned int slot, std::function <void (unsigned int)>& task) {
+        for (unsigned int k = 0; k < this->concurrency; ++k) {
+            auto& tasks = this->slots [(slot + k) % this->concurrency];
+            if (tasks.empty ()) {
+                continue;
+            }
+            if (k == 0) {
+                task = std::move (tasks.back ());
+                tasks.pop_back ();
+            } else {
+                task = std::move (tasks.front ());
+                tasks.pop_front ();
+            }
+            --this->queued;
+            return true;
+        }
+        return false;
+    }
+
+    // Runs tasks on `slot` while there are any; the waiter keeps going until every task has finished.
+    void work (unsigned int slot, bool waiter) {
+        const void* previous_group = current_group;
+        const unsigned int previous_slot = current_slot;
+        current_group = this;
+        current_slot = slot;
+
+        std::unique_lock <std::mutex> lock (this->mutex);
+        while (true) {
+            std::function <void (unsigned int)> task;
+            if (this->take (slot, task)) {
+                const bool skip = this->error != nullptr;
+                lock.unlock ();
+                if (!skip) {
+                    try {
+                        task (slot);
+                    } catch (...) {
+                        lock.lock ();
+                        if (this->error == nullptr) {
+                            this->error = std::current_exception ();
+                        }
+                        lock.unlock ();
+                    }
+                }
+                task = nullptr;
+                lock.lock ();
+                if (--this->pending == 0) {
+                    this->condition.notify_all ();
+                }
+                continue;
+            }
+
+            if (!waiter || this->pending == 0) {
+                break;
+            }
+            this->condition.wait (lock, [this] { return this->queued > 0 || this->pending == 0; });
+        }
+
+        if (!waiter) {
+            this->free_slots.push_back (slot);
+            --this->active_runners;
+        }
+        lock.unlock ();
+
+        current_group = previous_group;
+        current_slot = previous_slot;
+    }
+
+    const unsigned int concurrency;
+    std::vector <std::deque <std::function <void (unsigned int)>>> slots;
+    std::vector <unsigned int> free_slots;
+    std::mutex mutex;
+    std::condition_variable condition;
+    size_t pending = 0; // added and not finished
+    size_t queued = 0;  // still in a deque
+    unsigned int active_runners = 0;
+    std::exception_ptr error;
+};
+
+TaskGroup::TaskGroup (Executor& a_executor, unsigned int concurrency)
+    : executor (a_executor)
+    , state (std::make_shared <State> (concurrency)) {
+}
+
+TaskGroup::~TaskGroup () {
+    // Tasks may reference the caller's stack, so they must be finished even when the caller is unwinding.
+    try {
+        this->wait ();
+    } catch (...) {
+    }
+}
+
+unsigned int TaskGroup::concurrency () const {
+    return this->state->concurrency;
+}
+
+void TaskGroup::run (std::function <void (unsigned int slot)> task) {
+    State& state = *this->state;
+    bool spawn_runner = false;
+    {
+        std::lock_guard <std::mutex> lock (state.mutex);
+        const unsigned int slot = current_group == &state ? current_slot : 0;
+        state.slots [slot].push_back (std::move (task));
+        ++state.pending;
+        ++state.queued;
+
+        // Runners leave as soon as they find no task, so they never hold a worker idle; new tasks bring them back.
+        if (state.active_runners + 1 < state.concurrency && state.active_runners < state.queued) {
+            ++state.active_runners;
+            spawn_runner = true;
+        }
+    }
+    state.condition.notify_one ();
+
+    if (spawn_runner) {
+        this->executor.submit ([shared_state = this->state] {
+            unsigned int slot = 0;
+            {
+                std::lock_guard <std::mutex> lock (shared_state->mutex);
+                slot = shared_state->free_slots.back ();
+                shared_state->free_slots.pop_back ();
+            }
+            shared_state->work (slot, false);
+        });
+    }
+}
+
+void TaskGroup::wait () {
+    State& state = *this->state;
+    if (current_group == &state) {
+        throw std::logic_error {"[TaskGroup::wait]: called from one of the group's own tasks"};
+    }
+    state.work (0, true);
+
+    std::lock_guard <std::mutex> lock (state.mutex);
+    if (state.error != nullptr) {
+        std::exception_ptr error = state.error;
+        state.error = nullptr;
+        std::rethrow_exception (error);
+    }
+}
+
+}
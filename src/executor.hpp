@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sdf_raster {
+
+enum class ExecutorAffinity {
+    None,    // workers float, the OS places them
+    Compact, // worker i on the i-th allowed CPU, so neighbouring workers share caches
+    Scatter, // workers spread evenly over the allowed CPUs
+};
+
+struct ExecutorOptions {
+  unsigned int threads = 0; // 0: one worker per hardware thread
+  ExecutorAffinity affinity = ExecutorAffinity::None;
+  std::vector <int> cpus;   // CPUs to pin to, e.g. numa_node_cpus (node); empty means the process affinity mask
+};
+
+// CPUs of a NUMA node as listed by sysfs; empty when the node (or sysfs) does not exist.
+std::vector <int> numa_node_cpus (int node);
+
+// Persistent pool of worker threads with one job deque per worker. Workers pop their own deque from the back and
+// steal from the front of the others, so jobs submitted by a job stay on its worker while it is busy.
+//
+// Jobs are the unit the pool schedules; extraction code does not submit them directly but goes through TaskGroup,
+// which caps how many workers one call occupies. Several calls share the pool without oversubscribing the cores.
+class Executor {
+public:
+  explicit Executor (const ExecutorOptions& options = {});
+  ~Executor ();
+
+  Executor (const Executor&) = delete;
+  Executor& operator = (const Executor&) = delete;
+
+  unsigned int size () const { return static_cast <unsigned int> (this->workers.size ()); }
+
+  // Runs `job` on some worker. Jobs must not block on other jobs; TaskGroup::wait works instead of blocking.
+  void submit (std::function <void ()> job);
+
+  // Process-wide pool with default options, created on first use.
+  static Executor& shared ();
+
+private:
+  struct Worker {
+    std::thread thread;
+    std::mutex mutex;
+    std::deque <std::function <void ()>> jobs;
+  };
+
+  bool pop_job (size_t worker_index, std::function <void ()>& job);
+  void worker_loop (size_t worker_index);
+
+  std::vector <std::unique_ptr <Worker>> workers;
+  std::mutex sleep_mutex;
+  std::condition_variable sleep_condition;
+  std::atomic <size_t> queued_jobs {0};
+  std::atomic <size_t> next_worker {0};
+  bool stopping = false;
+};
+
+// How one call of a parallel algorithm uses the pool; every settings struct of those algorithms derives from it.
+struct ParallelSettings {
+  int max_threads = 1;          // most threads the call runs on at once, the calling thread included
+  Executor* executor = nullptr; // pool the call runs on; Executor::shared () when null
+
+  Executor& get_executor () const { return this->executor != nullptr ? *this->executor : Executor::shared (); }
+};
+
+// A set of tasks run by at most `concurrency` threads: the thread calling wait () and up to concurrency - 1 pool
+// workers. Every running task gets a slot in [0, concurrency) that no other task holds at the same time, so slots
+// index per-thread outputs. Tasks may call run () to add more tasks; they go to the deque of the running slot and
+// idle slots steal them. The first exception thrown by a task is rethrown by wait (); later tasks are skipped.
+class TaskGroup {
+public:
+  TaskGroup (Executor& executor, unsigned int concurrency);
+  ~TaskGroup ();
+
+  TaskGroup (const TaskGroup&) = delete;
+  TaskGroup& operator = (const TaskGroup&) = delete;
+
+  unsigned int concurrency () const;
+
+  void run (std::function <void (unsigned int slot)> task);
+
+  // Runs tasks on the calling thread (slot 0) until every task has finished.
+  void wait ();
+
+private:
+  struct State;
+
+  Executor& executor;
+  std::shared_ptr <State> state;
+};
+
+// Calls function (first, last, slot) on consecutive chunks of [0, count) of `grain` items, at most `concurrency`
+// chunks at once, and returns when all are done. One task per slot claims chunks in order from a shared counter, so
+// uneven chunks balance out and the number of tasks does not grow with `count`.
+template <typename Function>
+void parallel_for (Executor& executor, unsigned int concurrency, size_t count, size_t grain, const Function& function) {
+    if (count == 0) {
+        return;
+    }
+    grain = grain == 0 ? 1 : grain;
+    const size_t chunk_count = (count + grain - 1) / grain;
+    std::atomic <size_t> next_chunk {0};
+    auto run_chunks = [&] (unsigned int slot) {
+        for (size_t chunk = next_chunk++; chunk < chunk_count; chunk = next_chunk++) {
+            const size_t first = chunk * grain;
+            function (first, count - first < grain ? count : first + grain, slot);
+        }
+    };
+
+    if (concurrency <= 1 || chunk_count == 1) {
+        run_chunks (0u);
+        return;
+    }
+
+    TaskGroup group (executor, concurrency);
+    const size_t task_count = chunk_count < concurrency ? chunk_count : concurrency;
+    for (size_t i = 0; i < task_count; ++i) {
+        group.run ([&run_chunks] (unsigned int slot) { run_chunks (slot); });
+    }
+    group.wait ();
+}
+
+}
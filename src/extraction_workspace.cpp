@@ -0,0 +1,57 @@
+#include "extraction_workspace.hpp"
+
+namespace sdf_raster {
+
+namespace {
+
+void add_arena_stats (ScratchArenaStats& total, const ScratchArenaStats& stats) {
+    total.bytes_in_use += stats.bytes_in_use;
+    total.peak_bytes += stats.peak_bytes;
+    total.bytes_allocated += stats.bytes_allocated;
+    total.reserved_bytes += stats.reserved_bytes;
+    total.heap_allocations += stats.heap_allocations;
+}
+
+}
+
+void ExtractionWorkspace::begin (unsigned int concurrency) {
+    this->shared_arena.reset ();
+    while (this->slot_arenas.size () < concurrency) {
+        this->slot_arenas.push_back (std::make_unique <ScratchArena> ());
+    }
+    for (auto& arena : this->slot_arenas) {
+        arena->reset ();
+    }
+
+    this->meshes.resize (concurrency);
+    for (ThreadMesh& thread_mesh : this->meshes) {
+        thread_mesh.mesh.clear ();
+        thread_mesh.vertex_keys.clear ();
+        thread_mesh.vertex_table.clear ();
+        thread_mesh.too_deep = false;
+    }
+    ++this->extractions;
+}
+
+ExtractionWorkspaceStats ExtractionWorkspace::stats () const {
+    ExtractionWorkspaceStats stats;
+    add_arena_stats (stats.arenas, this->shared_arena.stats ());
+    for (const auto& arena : this->slot_arenas) {
+        add_arena_stats (stats.arenas, arena->stats ());
+    }
+    for (const ThreadMesh& thread_mesh : this->meshes) {
+        stats.thread_mesh_bytes += thread_mesh.mesh.get_vertices ().capacity () * sizeof (Vertex)
+                                 + thread_mesh.mesh.get_indices ().capacity () * sizeof (uint32_t)
+                                 + thread_mesh.vertex_keys.capacity () * sizeof (uint64_t)
+                                 + thread_mesh.vertex_table.capacity () * (sizeof (uint64_t) + sizeof (uint32_t));
+    }
+    stats.extractions = this->extractions;
+    return stats;
+}
+
+ExtractionWorkspace& ExtractionWorkspace::for_current_thread () {
+    thread_local ExtractionWorkspace workspace;
+    return workspace;
+}
+
+}
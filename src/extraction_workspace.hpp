@@ -0,0 +1,50 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "mesh_weld.hpp"
+#include "scratch_arena.hpp"
+
+namespace sdf_raster {
+
+struct ExtractionWorkspaceStats {
+  ScratchArenaStats arenas;      // summed over the shared and the per-slot arenas
+  size_t thread_mesh_bytes = 0;  // storage kept by the per-slot thread meshes
+  size_t extractions = 0;        // calls that used the workspace
+};
+
+// Scratch memory of surface extraction, kept from one call to the next: leaf lists, per-pass buffers, weld tables
+// and the per-slot thread meshes. Once a call has sized everything, repeating it with max_threads = 1 allocates only
+// the output mesh. Parallel calls still allocate task bookkeeping in TaskGroup and Executor (closures and deque
+// nodes), a few thousand allocations per call that do not grow with the octree; the scratch data itself is reused.
+//
+// The shared arena belongs to the calling thread between parallel phases; inside a phase, a task allocates from the
+// arena of the slot it runs on. A workspace serves one extraction at a time.
+class ExtractionWorkspace {
+public:
+  ExtractionWorkspace () = default;
+
+  ExtractionWorkspace (const ExtractionWorkspace&) = delete;
+  ExtractionWorkspace& operator = (const ExtractionWorkspace&) = delete;
+
+  // Rewinds every arena and empties `concurrency` thread meshes, keeping all storage. Extractors call it first.
+  void begin (unsigned int concurrency);
+
+  ScratchArena& arena () { return this->shared_arena; }
+  ScratchArena& slot_arena (unsigned int slot) { return *this->slot_arenas [slot]; }
+  std::vector <ThreadMesh>& thread_meshes () { return this->meshes; }
+
+  ExtractionWorkspaceStats stats () const;
+
+  // Workspace of the calling thread, for calls that do not bring their own.
+  static ExtractionWorkspace& for_current_thread ();
+
+private:
+  ScratchArena shared_arena;
+  std::vector <std::unique_ptr <ScratchArena>> slot_arenas;
+  std::vector <ThreadMesh> meshes;
+  size_t extractions = 0;
+};
+
+}
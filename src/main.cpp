@@ -10,12 +10,47 @@ int main (int argc, char* argv[]) {
         int height = 600;
         std::string filename = "";
         bool headless_mode = false;
+        bool benchmark_mode = false;
+        size_t stream_memory_mib = 0;
+        float simplify_ratio = 1.0f;
+        bool meshlets = false;
+        bool dual_grid = false;
+        sdf_raster::SdfOctreeEncoding octree_encoding = sdf_raster::SdfOctreeEncoding::Float32;
+        std::string expression_filename = "";
+        std::string mesh_filename = "";
+        std::string octree_filename = "./assets/sdf/example_octree_large.octree";
+        unsigned int max_depth = 8;
+        float max_error = 1e-3f;
 
         for (int i = 1; i < argc; ++i) {
             std::string arg = argv[i];
             if (arg == "-out" && i + 1 < argc) {
                 headless_mode = true;
                 filename = argv[++i];
+            } else if (arg == "-stream" && i + 1 < argc) {
+                stream_memory_mib = std::stoul(argv[++i]);
+            } else if (arg == "-simplify" && i + 1 < argc) {
+                simplify_ratio = std::stof(argv[++i]);
+            } else if (arg == "-meshlets") {
+                meshlets = true;
+            } else if (arg == "-dual") {
+                dual_grid = true;
+            } else if (arg == "-q8") {
+                octree_encoding = sdf_raster::SdfOctreeEncoding::Q8;
+            } else if (arg == "-q16") {
+                octree_encoding = sdf_raster::SdfOctreeEncoding::Q16;
+            } else if (arg == "-sdf" && i + 1 < argc) {
+                expression_filename = argv[++i];
+            } else if (arg == "-mesh" && i + 1 < argc) {
+                mesh_filename = argv[++i];
+            } else if (arg == "-octree" && i + 1 < argc) {
+                octree_filename = argv[++i];
+            } else if (arg == "-depth" && i + 1 < argc) {
+                max_depth = std::stoul(argv[++i]);
+            } else if (arg == "-error" && i + 1 < argc) {
+                max_error = std::stof(argv[++i]);
+            } else if (arg == "-bench") {
+                benchmark_mode = true;
             } else if (arg == "-w" && i + 1 < argc) {
                 width = std::stoi(argv[++i]);
             } else if (arg == "-h" && i + 1 < argc) {
@@ -23,11 +58,24 @@ int main (int argc, char* argv[]) {
             }
         }
 
-        if (headless_mode) {
+        if (!expression_filename.empty ()) {
             sdf_raster::Application app (width, height);
-            app.marching_cubes_cpu ("./assets/sdf/example_octree_large.octree", filename);
+            app.build_sdf_octree_cpu (expression_filename, octree_filename, max_depth, max_error);
+        } else if (!mesh_filename.empty ()) {
+            sdf_raster::Application app (width, height);
+            app.mesh_to_sdf_octree_cpu (mesh_filename, octree_filename, max_depth, max_error);
+        } else if (benchmark_mode) {
+            sdf_raster::Application app (width, height);
+            app.run_benchmarks ("./assets/sdf/example_octree_large.octree");
+        } else if (headless_mode && stream_memory_mib > 0) {
+            sdf_raster::Application app (width, height);
+            app.stream_marching_cubes_cpu ("./assets/sdf/example_octree_large.octree", filename, stream_memory_mib << 20);
+        } else if (headless_mode) {
+            sdf_raster::Application app (width, height);
+            app.marching_cubes_cpu ("./assets/sdf/example_octree_large.octree", filename, simplify_ratio, meshlets
+                    , dual_grid ? sdf_raster::MarchingCubesGrid::Dual : sdf_raster::MarchingCubesGrid::Primal);
         } else {
-            sdf_raster::Application app (width, height, "sdf_raster");
+            sdf_raster::Application app (width, height, "sdf_raster", meshlets, octree_encoding);
             app.run ();
         }
     } catch (const std::exception& e) {
@@ -1,107 +1,99 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <utility>
 
-#include "omp.h"
-
+#include "extraction_workspace.hpp"
+#include "marching_cubes_cases.hpp"
 #include "marching_cubes_lookup_table.hpp"
 #include "marching_cubes.hpp"
+#include "mesh_weld.hpp"
+#include "octree_traversal.hpp"
 
 namespace sdf_raster {
 
-struct VoxelInfo {
-    LiteMath::float3 min_corner;
-    float voxel_size;
-    const float (*sdf_values)[8];
-};
-
-struct NodeContext {
-    const SdfOctreeNode* node;
-    VoxelInfo voxel_info;
-};
-
 struct ThreadLocalBucket {
-    std::vector <VoxelInfo> found_leaves;
-    std::vector <NodeContext> children_contexts;
-};
+    explicit ThreadLocalBucket (std::pmr::memory_resource* resource)
+        : found_leaves (resource)
+        , children_contexts (resource) {
+    }
 
-std::vector <NodeContext> init_octree_root_context (const SdfOctreeNode* root) {
-    NodeContext root_context;
-    root_context.node = root;
-    root_context.voxel_info.voxel_size = 2.f;
-    root_context.voxel_info.min_corner = {-1.0f, -1.0f, -1.0f};
-    root_context.voxel_info.sdf_values = nullptr;
-    return {root_context};
-}
+    ScratchVector <VoxelInfo> found_leaves;
+    ScratchVector <VoxelInfo> children_contexts;
+};
 
-std::vector <VoxelInfo> collect_all_leaf_info (const SdfOctree& scene) {
-    if (scene.nodes.empty ()) {
+// With a range index, subtrees that cannot cross iso_level are skipped along with their leaves. The list and the
+// per-level buffers live in the workspace; each bucket grows in the arena of the slot that fills it.
+template <typename Octree>
+ScratchVector <VoxelInfo> collect_all_leaf_info (const Octree& scene
+                                                 , Executor& executor
+                                                 , unsigned int concurrency
+                                                 , ExtractionWorkspace& workspace
+                                                 , const SdfOctreeRangeIndex* range_index = nullptr
+                                                 , float iso_level = 0.0f) {
+    if (scene.empty ()) {
         throw std::runtime_error {"[collect_all_leaf_info]: empty sdf"};
     }
+    if (range_index != nullptr && range_index->size () != scene.size ()) {
+        throw std::runtime_error {"[collect_all_leaf_info]: range index does not match the octree"};
+    }
 
-    std::vector <NodeContext> current_level_contexts = init_octree_root_context (&scene.nodes [0]);
-    std::vector <VoxelInfo> all_leaf_info;
+    ScratchArena& arena = workspace.arena ();
+    ScratchVector <VoxelInfo> current_level_contexts (1, octree_root_voxel_info (), &arena);
+    ScratchVector <VoxelInfo> next_level_contexts (&arena);
+    ScratchVector <VoxelInfo> all_leaf_info (&arena);
 
-    while (!current_level_contexts.empty ()) {
-        std::vector <ThreadLocalBucket> thread_local_bucket (omp_get_max_threads ());
+    // One bucket per slot, kept across levels so their storage is reused.
+    ScratchVector <ThreadLocalBucket> thread_local_bucket (&arena);
+    thread_local_bucket.reserve (concurrency);
+    for (unsigned int slot = 0; slot < concurrency; ++slot) {
+        thread_local_bucket.emplace_back (&workspace.slot_arena (slot));
+    }
 
-        #pragma omp parallel
-        {
-            int thread_id = omp_get_thread_num ();
+    while (!current_level_contexts.empty ()) {
+        for (auto& bucket : thread_local_bucket) {
+            bucket.found_leaves.clear ();
+            bucket.children_contexts.clear ();
+        }
 
-            #pragma omp for schedule(dynamic)
-            for (size_t i = 0; i < current_level_contexts.size (); ++i) {
-                const NodeContext& current_context = current_level_contexts [i];
+        constexpr size_t grain = 1024;
+        parallel_for (executor, concurrency, current_level_contexts.size (), grain, [&] (size_t first, size_t last, unsigned int slot) {
+            ThreadLocalBucket& bucket = thread_local_bucket [slot];
+            for (size_t i = first; i < last; ++i) {
+                const VoxelInfo& current_context = current_level_contexts [i];
+                if (range_index != nullptr && !range_index->may_contain_surface (current_context.node_index, iso_level)) {
+                    continue;
+                }
+                const auto& node = scene [current_context.node_index];
 
-                if (current_context.node->offset == 0) {
-                    VoxelInfo leaf_info = current_context.voxel_info;
-                    leaf_info.sdf_values = &(current_context.node->values);
-                    thread_local_bucket [thread_id].found_leaves.push_back (leaf_info);
+                if (node.offset == 0) {
+                    bucket.found_leaves.push_back (current_context);
                 } else {
-                    float child_voxel_size = current_context.voxel_info.voxel_size * 0.5f;
-
                     for (unsigned int k = 0; k < 8; ++k) {
-                        size_t child_index = current_context.node->offset + k;
-                        if (child_index >= scene.nodes.size ()) {
-                            throw std::runtime_error {"[collect_all_leaf_info]: out of bounds."};
-                        }
-
-                        LiteMath::float3 corner_offset = {0.0f, 0.0f, 0.0f};
-                        if ((k >> 0) & 1) corner_offset.x = child_voxel_size;
-                        if ((k >> 1) & 1) corner_offset.y = child_voxel_size;
-                        if ((k >> 2) & 1) corner_offset.z = child_voxel_size;
-
-                        NodeContext child_context;
-                        child_context.node = &scene.nodes [child_index];
-                        child_context.voxel_info.min_corner = current_context.voxel_info.min_corner + corner_offset;
-                        child_context.voxel_info.voxel_size = child_voxel_size;
-                        child_context.voxel_info.sdf_values = nullptr;
-                        thread_local_bucket [thread_id].children_contexts.push_back (child_context);
+                        bucket.children_contexts.push_back (child_voxel_info (scene, current_context, node.offset, k));
                     }
                 }
             }
-        }
+        });
 
         size_t total_leaves_found_this_level = 0;
-        for (int tid = 0; tid < omp_get_max_threads (); ++tid) {
-            total_leaves_found_this_level += thread_local_bucket [tid].found_leaves.size ();
+        for (const auto& bucket : thread_local_bucket) {
+            total_leaves_found_this_level += bucket.found_leaves.size ();
         }
         all_leaf_info.reserve (all_leaf_info.size () + total_leaves_found_this_level);
 
-        for (int tid = 0; tid < omp_get_max_threads (); ++tid) {
-            all_leaf_info.insert (all_leaf_info.end ()
-                                   , thread_local_bucket [tid].found_leaves.begin ()
-                                   , thread_local_bucket [tid].found_leaves.end ()
-                                   );
-        }
-
-        std::vector <NodeContext> next_level_contexts;
-        for (int tid = 0; tid < omp_get_max_threads (); ++tid) {
-            next_level_contexts.insert (next_level_contexts.end ()
-                                     , thread_local_bucket [tid].children_contexts.begin ()
-                                     , thread_local_bucket [tid].children_contexts.end ()
-                                     );
+        next_level_contexts.clear ();
+        for (const auto& bucket : thread_local_bucket) {
+            all_leaf_info.insert (all_leaf_info.end (), bucket.found_leaves.begin (), bucket.found_leaves.end ());
+            next_level_contexts.insert (next_level_contexts.end (), bucket.children_contexts.begin (), bucket.children_contexts.end ());
         }
 
-        current_level_contexts = std::move (next_level_contexts);
+        std::swap (current_level_contexts, next_level_contexts);
     }
 
     return all_leaf_info;
@@ -124,94 +116,925 @@ LiteMath::float3 interpolate_vertex (float isolevel, LiteMath::float3 p1, LiteMa
     return (p);
 }
 
-LiteMath::float3 estimate_normal (const SdfOctree& scene, const LiteMath::float3& p, float eps = 1e-4f) {
-    float dx = sample_sdf (scene, {p.x + eps, p.y, p.z}) - sample_sdf (scene, {p.x - eps, p.y, p.z});
-    float dy = sample_sdf (scene, {p.x, p.y + eps, p.z}) - sample_sdf (scene, {p.x, p.y - eps, p.z});
-    float dz = sample_sdf (scene, {p.x, p.y, p.z + eps}) - sample_sdf (scene, {p.x, p.y, p.z - eps});
-    LiteMath::float3 n = {dx, dy, dz};
-    return LiteMath::normalize (n);
+template <typename Octree>
+void sample_distances (const Octree& scene, const float* xs, const float* ys, const float* zs, float* distances, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        distances [i] = sample_sdf (scene, {xs [i], ys [i], zs [i]});
+    }
+}
+
+void sample_distances (const SdfOctreeView& scene, const float* xs, const float* ys, const float* zs, float* distances, size_t count) {
+    sample_sdf_batch (scene, xs, ys, zs, distances, count);
 }
 
-void process_leaf_node (const VoxelInfo& voxel_info , Mesh& mesh , const float iso_level , const SdfOctree& scene) {
-    float corner_values [8];
-    for (int i = 0; i < 8; ++i) {
-        corner_values [i] = (*voxel_info.sdf_values) [i];
+// Central differences for a whole vertex array: the 6 taps of every vertex are laid out as SoA
+// and go through the batched sampler in chunks.
+template <typename Octree>
+void estimate_normals (const Octree& scene, Vertex* vertices, size_t count, ScratchArena& arena, float eps = 1e-4f) {
+    constexpr size_t chunk_size = 1024;
+    const ScratchScope scope (arena);
+    float* xs = allocate_scratch_array <float> (arena, 6 * chunk_size);
+    float* ys = allocate_scratch_array <float> (arena, 6 * chunk_size);
+    float* zs = allocate_scratch_array <float> (arena, 6 * chunk_size);
+    float* distances = allocate_scratch_array <float> (arena, 6 * chunk_size);
+
+    for (size_t first = 0; first < count; first += chunk_size) {
+        const size_t n = std::min (chunk_size, count - first);
+
+        for (size_t i = 0; i < n; ++i) {
+            const LiteMath::float3& p = vertices [first + i].position;
+            for (size_t tap = 0; tap < 6; ++tap) {
+                const float delta = (tap & 1) ? -eps : eps;
+                xs [tap * n + i] = tap / 2 == 0 ? p.x + delta : p.x;
+                ys [tap * n + i] = tap / 2 == 1 ? p.y + delta : p.y;
+                zs [tap * n + i] = tap / 2 == 2 ? p.z + delta : p.z;
+            }
+        }
+
+        sample_distances (scene, xs, ys, zs, distances, 6 * n);
+
+        for (size_t i = 0; i < n; ++i) {
+            LiteMath::float3 gradient = {
+                distances [0 * n + i] - distances [1 * n + i]
+                , distances [2 * n + i] - distances [3 * n + i]
+                , distances [4 * n + i] - distances [5 * n + i]
+            };
+            vertices [first + i].normal = LiteMath::normalize (gradient);
+        }
     }
+}
 
-    const LiteMath::float3 voxel_size_modifier {voxel_info.voxel_size};
-    int cube_index = 0;
-    LiteMath::float3 corners [8];
+// Vertices on the same octree edge are shared when welding. A key packs the leaf level (5 bits), the edge axis
+// (2 bits) and the Morton code of the edge's lower end on that level's lattice (19 bits per axis).
+constexpr unsigned int MAX_WELD_DEPTH = 18;
+
+uint64_t spread_bits_3 (uint64_t v) {
+    v &= 0x1fffff;
+    v = (v | v << 32) & 0x1f00000000ffffull;
+    v = (v | v << 16) & 0x1f0000ff0000ffull;
+    v = (v | v << 8) & 0x100f00f00f00f00full;
+    v = (v | v << 4) & 0x10c30c30c30c30c3ull;
+    v = (v | v << 2) & 0x1249249249249249ull;
+    return v;
+}
+
+uint64_t edge_key (const VoxelInfo& voxel_info, int edge) {
+    const LiteMath::uint2 corners = edge_corners [edge];
+    const uint32_t lower = corners.x & corners.y;
+    const uint32_t axis = (corners.x ^ corners.y) >> 1;
+
+    const uint64_t x = std::lround ((voxel_info.min_corner.x + 1.0f) / voxel_info.voxel_size) + (lower & 1);
+    const uint64_t y = std::lround ((voxel_info.min_corner.y + 1.0f) / voxel_info.voxel_size) + ((lower >> 1) & 1);
+    const uint64_t z = std::lround ((voxel_info.min_corner.z + 1.0f) / voxel_info.voxel_size) + ((lower >> 2) & 1);
+
+    return (uint64_t (voxel_info.depth) << 59) | (uint64_t (axis) << 57)
+         | spread_bits_3 (x) | (spread_bits_3 (y) << 1) | (spread_bits_3 (z) << 2);
+}
 
+template <typename Octree>
+int classify_leaf (const Octree& scene, const VoxelInfo& voxel_info, float iso_level, float (&corner_values) [8]) {
+    load_leaf_values (scene, voxel_info, corner_values);
+
+    int cube_index = 0;
     for (int i = 0; i < 8; ++i) {
-        LiteMath::float3 corner_offset = {0.0f, 0.0f, 0.0f};
-        if ((i >> 0) & 1) corner_offset.x = voxel_info.voxel_size;
-        if ((i >> 1) & 1) corner_offset.y = voxel_info.voxel_size;
-        if ((i >> 2) & 1) corner_offset.z = voxel_info.voxel_size;
-        corners [i] = voxel_info.min_corner + corner_offset;
+        cube_index |= static_cast <int> (corner_values [i] < iso_level) << i;
+    }
+    return cube_index;
+}
+
+// Table-driven polygonization: walks the edge mask and the -1 terminated triangle list at run time.
+int polygonize_leaf_table_driven (const VoxelInfo& voxel_info
+                     , const float (&corner_values) [8]
+                     , int cube_index
+                     , const MarchingCubesSettings& settings
+                     , Vertex* vertices
+                     , uint64_t* keys) {
+    const int edge_mask = cube_index_2_edge_mask [cube_index];
+    if (edge_mask == 0) {
+        return 0;
+    }
 
-        if (corner_values [i] < iso_level) {
-            cube_index |= (1 << i);
+    // Only the edges the surface crosses (3 to 12, mostly 3 to 6) are interpolated. Their end points go to SoA
+    // slots so the interpolation runs as one SIMD loop; edge_slots maps an edge to its slot.
+    int edge_slots [12];
+    float x1 [12], y1 [12], z1 [12], x2 [12], y2 [12], z2 [12], v1 [12], v2 [12];
+    int active_count = 0;
+    for (int edge = 0; edge < 12; ++edge) {
+        if ((edge_mask & (1 << edge)) == 0) {
+            continue;
         }
+
+        const auto corner_indices = edge_corners [edge];
+        x1 [active_count] = voxel_info.min_corner.x + ((corner_indices.x >> 0) & 1 ? voxel_info.voxel_size : 0.0f);
+        y1 [active_count] = voxel_info.min_corner.y + ((corner_indices.x >> 1) & 1 ? voxel_info.voxel_size : 0.0f);
+        z1 [active_count] = voxel_info.min_corner.z + ((corner_indices.x >> 2) & 1 ? voxel_info.voxel_size : 0.0f);
+        x2 [active_count] = voxel_info.min_corner.x + ((corner_indices.y >> 0) & 1 ? voxel_info.voxel_size : 0.0f);
+        y2 [active_count] = voxel_info.min_corner.y + ((corner_indices.y >> 1) & 1 ? voxel_info.voxel_size : 0.0f);
+        z2 [active_count] = voxel_info.min_corner.z + ((corner_indices.y >> 2) & 1 ? voxel_info.voxel_size : 0.0f);
+        v1 [active_count] = corner_values [corner_indices.x];
+        v2 [active_count] = corner_values [corner_indices.y];
+        edge_slots [edge] = active_count++;
     }
 
-    int edge_mask = cube_index_2_edge_mask [cube_index];
-    if (edge_mask == 0) {
+    // Branch-free interpolate_vertex: the same snapping to an end point near the iso level, as selects.
+    const float iso_level = settings.iso_level;
+    LiteMath::float3 edge_vertices [12];
+    float px [12], py [12], pz [12];
+    #pragma omp simd
+    for (int i = 0; i < active_count; ++i) {
+        float mu = (iso_level - v1 [i]) / (v2 [i] - v1 [i]);
+        mu = std::fabs (v1 [i] - v2 [i]) < 0.00001f ? 0.0f : mu;
+        mu = std::fabs (iso_level - v2 [i]) < 0.00001f ? 1.0f : mu;
+        mu = std::fabs (iso_level - v1 [i]) < 0.00001f ? 0.0f : mu;
+        px [i] = x1 [i] + mu * (x2 [i] - x1 [i]);
+        py [i] = y1 [i] + mu * (y2 [i] - y1 [i]);
+        pz [i] = z1 [i] + mu * (z2 [i] - z1 [i]);
+    }
+    for (int i = 0; i < active_count; ++i) {
+        edge_vertices [i] = {px [i], py [i], pz [i]};
+    }
+
+    LiteMath::float3 edge_normals [12];
+    if (settings.normals == MarchingCubesNormals::LeafGradient) {
+        for (int i = 0; i < active_count; ++i) {
+            const LiteMath::float3 local = (edge_vertices [i] - voxel_info.min_corner) / voxel_info.voxel_size;
+            edge_normals [i] = LiteMath::normalize (interpolate_trilinear_with_gradient (corner_values, local, voxel_info.voxel_size).gradient);
+        }
+    }
+
+    const int *triangle_indices = cube_index_2_triangle_indices [cube_index];
+    int i = 0;
+    for (; triangle_indices [i] != -1; ++i) {
+        const int slot = edge_slots [triangle_indices [i]];
+        Vertex vertex {};
+        vertex.position = edge_vertices [slot];
+        if (settings.normals == MarchingCubesNormals::LeafGradient) {
+            vertex.normal = edge_normals [slot];
+        }
+        vertices [i] = vertex;
+        if (keys != nullptr) {
+            keys [i] = edge_key (voxel_info, triangle_indices [i]);
+        }
+    }
+    return i;
+}
+
+// Specialized polygonization: the case's crossed edges and triangles are constants, so every kernel below is
+// straight-line code for exactly its edges and triangles. Results match the table-driven path bit for bit.
+template <int Edge>
+LiteMath::float3 interpolate_edge (const VoxelInfo& voxel_info, const float (&corner_values) [8], float iso_level) {
+    constexpr int c0 = edge_corner_indices [Edge] [0];
+    constexpr int c1 = edge_corner_indices [Edge] [1];
+    constexpr int axis = (c0 ^ c1) == 1 ? 0 : ((c0 ^ c1) == 2 ? 1 : 2);
+
+    LiteMath::float3 p1 = voxel_info.min_corner;
+    LiteMath::float3 p2 = voxel_info.min_corner;
+    for (int i = 0; i < 3; ++i) {
+        p1 [i] += ((c0 >> i) & 1) ? voxel_info.voxel_size : 0.0f;
+        p2 [i] += ((c1 >> i) & 1) ? voxel_info.voxel_size : 0.0f;
+    }
+
+    const float v1 = corner_values [c0];
+    const float v2 = corner_values [c1];
+    float mu = (iso_level - v1) / (v2 - v1);
+    mu = std::fabs (v1 - v2) < 0.00001f ? 0.0f : mu;
+    mu = std::fabs (iso_level - v2) < 0.00001f ? 1.0f : mu;
+    mu = std::fabs (iso_level - v1) < 0.00001f ? 0.0f : mu;
+
+    // Off-axis coordinates of the two end points are equal, only the axis one moves.
+    p1 [axis] = p1 [axis] + mu * (p2 [axis] - p1 [axis]);
+    return p1;
+}
+
+template <int CubeIndex, size_t... Slots>
+void interpolate_case_edges (const VoxelInfo& voxel_info
+                             , const float (&corner_values) [8]
+                             , float iso_level
+                             , LiteMath::float3* edge_vertices
+                             , std::index_sequence <Slots...>) {
+    constexpr CaseEdges edges = case_edges (CubeIndex);
+    ((edge_vertices [Slots] = interpolate_edge <edges.edges [Slots]> (voxel_info, corner_values, iso_level)), ...);
+}
+
+template <int CubeIndex, size_t... Slots>
+void key_case_edges (const VoxelInfo& voxel_info, uint64_t* edge_keys, std::index_sequence <Slots...>) {
+    constexpr CaseEdges edges = case_edges (CubeIndex);
+    ((edge_keys [Slots] = edge_key (voxel_info, edges.edges [Slots])), ...);
+}
+
+template <int CubeIndex, size_t... Vertices>
+void emit_case_vertices (const LiteMath::float3* edge_vertices
+                         , const LiteMath::float3* edge_normals
+                         , const uint64_t* edge_keys
+                         , Vertex* vertices
+                         , uint64_t* keys
+                         , std::index_sequence <Vertices...>) {
+    constexpr CaseEdges edges = case_edges (CubeIndex);
+    constexpr int slots [] = {edges.slots [cube_index_2_triangle_indices [CubeIndex] [Vertices]]...};
+
+    auto emit = [&] (int i, int slot) {
+        Vertex vertex {};
+        vertex.position = edge_vertices [slot];
+        if (edge_normals != nullptr) {
+            vertex.normal = edge_normals [slot];
+        }
+        vertices [i] = vertex;
+        if (keys != nullptr) {
+            keys [i] = edge_keys [slot];
+        }
+    };
+    (emit (static_cast <int> (Vertices), slots [Vertices]), ...);
+}
+
+template <int CubeIndex>
+int polygonize_case (const VoxelInfo& voxel_info
+                     , const float (&corner_values) [8]
+                     , const MarchingCubesSettings& settings
+                     , Vertex* vertices
+                     , uint64_t* keys) {
+    constexpr CaseEdges edges = case_edges (CubeIndex);
+    constexpr int vertex_count = case_vertex_count (CubeIndex);
+
+    if constexpr (vertex_count == 0) {
+        return 0;
+    } else {
+        LiteMath::float3 edge_vertices [edges.count];
+        interpolate_case_edges <CubeIndex> (voxel_info, corner_values, settings.iso_level, edge_vertices
+                                            , std::make_index_sequence <edges.count> {});
+
+        LiteMath::float3 edge_normals [edges.count];
+        const bool leaf_gradient = settings.normals == MarchingCubesNormals::LeafGradient;
+        if (leaf_gradient) {
+            for (int i = 0; i < edges.count; ++i) {
+                const LiteMath::float3 local = (edge_vertices [i] - voxel_info.min_corner) / voxel_info.voxel_size;
+                edge_normals [i] = LiteMath::normalize (interpolate_trilinear_with_gradient (corner_values, local, voxel_info.voxel_size).gradient);
+            }
+        }
+
+        uint64_t edge_keys [edges.count] = {};
+        if (keys != nullptr) {
+            key_case_edges <CubeIndex> (voxel_info, edge_keys, std::make_index_sequence <edges.count> {});
+        }
+
+        emit_case_vertices <CubeIndex> (edge_vertices, leaf_gradient ? edge_normals : nullptr, edge_keys, vertices, keys
+                                        , std::make_index_sequence <vertex_count> {});
+        return vertex_count;
+    }
+}
+
+using CaseKernel = int (*) (const VoxelInfo&, const float (&) [8], const MarchingCubesSettings&, Vertex*, uint64_t*);
+
+template <size_t... CubeIndices>
+constexpr std::array <CaseKernel, 256> make_case_kernels (std::index_sequence <CubeIndices...>) {
+    return {{&polygonize_case <static_cast <int> (CubeIndices)>...}};
+}
+
+// Jump table: one indirect call per leaf replaces every branch on table contents.
+constexpr std::array <CaseKernel, 256> case_kernels = make_case_kernels (std::make_index_sequence <256> {});
+
+// Writes the triangle soup of one leaf, 3 vertices per triangle in cube_index_2_triangle_indices order,
+// and the edge key of every vertex when `keys` is set. Returns the number of vertices written (at most 15).
+int polygonize_leaf (const VoxelInfo& voxel_info
+                     , const float (&corner_values) [8]
+                     , int cube_index
+                     , const MarchingCubesSettings& settings
+                     , Vertex* vertices
+                     , uint64_t* keys) {
+    if (settings.cases == MarchingCubesCases::Specialized) {
+        return case_kernels [cube_index] (voxel_info, corner_values, settings, vertices, keys);
+    }
+    return polygonize_leaf_table_driven (voxel_info, corner_values, cube_index, settings, vertices, keys);
+}
+
+template <typename Octree>
+void process_leaf_node (const VoxelInfo& voxel_info , ThreadMesh& output , const MarchingCubesSettings& settings , const Octree& scene) {
+    float corner_values [8];
+    const int cube_index = classify_leaf (scene, voxel_info, settings.iso_level, corner_values);
+
+    Vertex vertices [15];
+    uint64_t keys [15];
+    const int count = polygonize_leaf (voxel_info, corner_values, cube_index, settings, vertices, settings.weld_vertices ? keys : nullptr);
+
+    if (settings.weld_vertices) {
+        weld_vertices (output, vertices, keys, count);
+    } else {
+        for (int i = 0; i < count; ++i) {
+            output.mesh.add_vertex_fast (vertices [i]);
+        }
+    }
+}
+
+// Subtrees rooted above this depth are spawned as tasks, deeper ones are walked inline by the task that reached them.
+// 8^5 potential tasks is plenty to balance many cores while keeping the task overhead far below the per-leaf work.
+constexpr unsigned int TASK_SPAWN_DEPTH = 5;
+
+// Single-pass traversal: leaves go straight to extraction, no leaf list and no per-level barriers.
+// Each worker only holds the recursion stack of the subtree it is in, so memory stays O(depth) per worker.
+template <typename Octree>
+void extract_subtree (const Octree& scene
+                      , const VoxelInfo& voxel_info
+                      , const MarchingCubesSettings& settings
+                      , unsigned int slot
+                      , TaskGroup& group
+                      , std::vector <ThreadMesh>& thread_meshes) {
+    if (settings.range_index != nullptr && !settings.range_index->may_contain_surface (voxel_info.node_index, settings.iso_level)) {
         return;
     }
 
-    LiteMath::float3 edge_vertices [12];
-    int edge_bit = 1;
-    for (int i = 0; i < 12; ++i) {
-        // if ((edge_mask & edge_bit) == 0) {
-        //     continue;
-        // }
-
-        const auto corner_indices = edge_corners [i];
-        edge_vertices [i] = interpolate_vertex (iso_level
-                                                , corners [corner_indices.x]
-                                                , corners [corner_indices.y]
-                                                , corner_values [corner_indices.x]
-                                                , corner_values [corner_indices.y]
-                                                );
-        edge_bit <<= 1;
+    const auto& node = scene [voxel_info.node_index];
+    if (node.offset == 0) {
+        // No other task holds this slot while we run, so its mesh needs no locking.
+        ThreadMesh& output = thread_meshes [slot];
+        if (settings.weld_vertices && voxel_info.depth > MAX_WELD_DEPTH) {
+            output.too_deep = true;
+            return;
+        }
+        process_leaf_node (voxel_info, output, settings, scene);
+        return;
+    }
+
+    for (unsigned int k = 0; k < 8; ++k) {
+        const VoxelInfo child_context = child_voxel_info (scene, voxel_info, node.offset, k);
+        if (voxel_info.depth < TASK_SPAWN_DEPTH && group.concurrency () > 1) {
+            group.run ([&scene, child_context, &settings, &group, &thread_meshes] (unsigned int task_slot) {
+                extract_subtree (scene, child_context, settings, task_slot, group, thread_meshes);
+            });
+        } else {
+            extract_subtree (scene, child_context, settings, slot, group, thread_meshes);
+        }
+    }
+}
+
+// Central-difference normals for every thread mesh, one task per mesh.
+template <typename Octree>
+void estimate_thread_mesh_normals (const Octree& scene, ExtractionWorkspace& workspace, Executor& executor, unsigned int concurrency) {
+    std::vector <ThreadMesh>& thread_meshes = workspace.thread_meshes ();
+    parallel_for (executor, concurrency, thread_meshes.size (), 1, [&] (size_t first, size_t last, unsigned int slot) {
+        for (size_t t = first; t < last; ++t) {
+            auto& vertices = thread_meshes [t].mesh.get_mutable_vertices ();
+            estimate_normals (scene, vertices.data (), vertices.size (), workspace.slot_arena (slot));
+        }
+    });
+}
+
+template <typename Octree>
+Mesh marching_cubes_single_pass (const MarchingCubesSettings& settings
+                                 , const Octree& scene
+                                 , Executor& executor
+                                 , unsigned int concurrency
+                                 , ExtractionWorkspace& workspace) {
+    // Thread meshes keep their storage in the workspace, so they only grow on the first calls.
+    std::vector <ThreadMesh>& thread_meshes = workspace.thread_meshes ();
+    TaskGroup group (executor, concurrency);
+    group.run ([&] (unsigned int slot) { extract_subtree (scene, octree_root_voxel_info (), settings, slot, group, thread_meshes); });
+    group.wait ();
+
+    if (settings.normals == MarchingCubesNormals::CentralDifferences) {
+        estimate_thread_mesh_normals (scene, workspace, executor, concurrency);
     }
 
+    for (const auto& thread_mesh : thread_meshes) {
+        if (thread_mesh.too_deep) {
+            throw std::runtime_error {"[marching_cubes]: vertex welding supports octrees up to " + std::to_string (MAX_WELD_DEPTH) + " levels deep"};
+        }
+    }
+
+    return settings.weld_vertices
+        ? merge_welded_meshes (thread_meshes, executor, concurrency, workspace.arena ())
+        : concatenate_meshes (thread_meshes, executor, concurrency, workspace.arena ());
+}
+
+constexpr size_t CLASSIFY_BATCH_SIZE = 256;
+
+// Count-then-write extraction. Leaves are listed and sorted by node index, a count pass sizes every leaf's output
+// from cube_index_2_mesh_output_counts, an exclusive prefix sum turns the counts into offsets and a write pass fills
+// the exact-size buffers in place. Output order is the leaf order, so the mesh is the same for any thread count.
+template <typename Octree>
+Mesh marching_cubes_two_pass (const MarchingCubesSettings& settings
+                              , const Octree& scene
+                              , Executor& executor
+                              , unsigned int concurrency
+                              , ExtractionWorkspace& workspace) {
+    ScratchArena& arena = workspace.arena ();
+    ScratchVector <VoxelInfo> leaves = collect_all_leaf_info (scene, executor, concurrency, workspace, settings.range_index, settings.iso_level);
+    std::sort (leaves.begin (), leaves.end (), [] (const VoxelInfo& a, const VoxelInfo& b) { return a.node_index < b.node_index; });
+
+    uint8_t* cube_indices = allocate_scratch_array <uint8_t> (arena, leaves.size ());
+    ScratchVector <size_t> offsets (leaves.size () + 1, 0, &arena);
+    std::atomic <bool> too_deep {false};
+
+    // Leaves are classified in batches: corner values are transposed to SoA and go through classify_leaves.
+    parallel_for (executor, concurrency, leaves.size (), CLASSIFY_BATCH_SIZE, [&] (size_t first, size_t last, unsigned int) {
+        const size_t count = last - first;
+        float values [8 * CLASSIFY_BATCH_SIZE];
+        for (size_t i = 0; i < count; ++i) {
+            float corner_values [8];
+            load_leaf_values (scene, leaves [first + i], corner_values);
+            for (size_t c = 0; c < 8; ++c) {
+                values [c * CLASSIFY_BATCH_SIZE + i] = corner_values [c];
+            }
+        }
+        classify_leaves (values, CLASSIFY_BATCH_SIZE, count, settings.iso_level, cube_indices + first);
+
+        for (size_t i = first; i < last; ++i) {
+            offsets [i + 1] = 3 * cube_index_2_mesh_output_counts [cube_indices [i]].y;
+            if (settings.weld_vertices && offsets [i + 1] != 0 && leaves [i].depth > MAX_WELD_DEPTH) {
+                too_deep = true;
+            }
+        }
+    });
+    if (too_deep) {
+        throw std::runtime_error {"[marching_cubes]: vertex welding supports octrees up to " + std::to_string (MAX_WELD_DEPTH) + " levels deep"};
+    }
+
+    for (size_t i = 0; i < leaves.size (); ++i) {
+        offsets [i + 1] += offsets [i];
+    }
+    const size_t vertex_count = offsets [leaves.size ()];
+
+    // A soup is the output itself; a welded mesh is built from a soup that only lives in the arena.
+    std::vector <Vertex> output_vertices (settings.weld_vertices ? 0 : vertex_count);
+    Vertex* vertices = settings.weld_vertices ? allocate_scratch_array <Vertex> (arena, vertex_count) : output_vertices.data ();
+    uint64_t* keys = settings.weld_vertices ? allocate_scratch_array <uint64_t> (arena, vertex_count) : nullptr;
+
+    constexpr size_t write_grain = 256;
+    parallel_for (executor, concurrency, leaves.size (), write_grain, [&] (size_t first, size_t last, unsigned int) {
+        for (size_t i = first; i < last; ++i) {
+            if (offsets [i + 1] == offsets [i]) {
+                continue;
+            }
+            float corner_values [8];
+            load_leaf_values (scene, leaves [i], corner_values);
+            polygonize_leaf (leaves [i], corner_values, cube_indices [i], settings
+                             , vertices + offsets [i]
+                             , settings.weld_vertices ? keys + offsets [i] : nullptr);
+        }
+    });
+
+    if (settings.normals == MarchingCubesNormals::CentralDifferences) {
+        constexpr size_t block_size = 4096;
+        parallel_for (executor, concurrency, vertex_count, block_size, [&] (size_t first, size_t last, unsigned int slot) {
+            estimate_normals (scene, vertices + first, last - first, workspace.slot_arena (slot));
+        });
+    }
+
+    if (!settings.weld_vertices) {
+        std::vector <uint32_t> indices (vertex_count);
+        constexpr size_t index_grain = 1 << 16;
+        parallel_for (executor, concurrency, vertex_count, index_grain, [&] (size_t first, size_t last, unsigned int) {
+            for (size_t i = first; i < last; ++i) {
+                indices [i] = static_cast <uint32_t> (i);
+            }
+        });
+        return Mesh (std::move (indices), std::move (output_vertices));
+    }
+
+    // Each thread welds one contiguous slice of the soup; merge_welded_meshes keeps the lowest slice per key, so the
+    // surviving vertex is always the first one in leaf order, whatever the slicing.
+    std::vector <ThreadMesh>& slices = workspace.thread_meshes ();
+    const size_t slice_count = slices.size ();
+    parallel_for (executor, concurrency, slice_count, 1, [&] (size_t first_slice, size_t last_slice, unsigned int) {
+        for (size_t s = first_slice; s < last_slice; ++s) {
+            const size_t first = vertex_count * s / slice_count;
+            const size_t last = vertex_count * (s + 1) / slice_count;
+            weld_vertices (slices [s], vertices + first, keys + first, last - first);
+        }
+    });
+    return merge_welded_meshes (slices, executor, concurrency, arena);
+}
+
+// Dual marching cubes (Schaefer & Warren, 2004). The dual grid has a vertex at every leaf centre and a cell around
+// every octree corner point, formed by the (up to 8 distinct) leaves meeting there; dual_procedure finds them.
+// Running marching cubes on those cells stitches leaves of different size without T-junctions. Surface within half
+// a leaf of the domain boundary is not covered by dual cells and is dropped.
+constexpr unsigned int DUAL_TASK_SPAWN_DEPTH = 3; // up to 27 sub-procedures per level, so spawn tasks sparingly
+
+// Dual vertices live on segments between two leaf centres, so the pair of leaf node indices names them. Interpolating
+// from the lower index makes every dual cell that shares a segment produce the same vertex bit for bit.
+uint64_t dual_edge_key (uint32_t node_a, uint32_t node_b) {
+    return (uint64_t (std::min (node_a, node_b)) << 32) | std::max (node_a, node_b);
+}
+
+template <typename Octree>
+void emit_dual_cell (const Octree& scene, const VoxelInfo (&nodes) [8], const MarchingCubesSettings& settings, ThreadMesh& output) {
+    float values [8];
+    LiteMath::float3 centres [8];
+    int cube_index = 0;
+    for (int k = 0; k < 8; ++k) {
+        float corner_values [8];
+        load_leaf_values (scene, nodes [k], corner_values);
+
+        values [k] = 0.0f;
+        for (int i = 0; i < 8; ++i) {
+            values [k] += corner_values [i];
+        }
+        values [k] *= 0.125f; // trilinear value at the leaf centre
+        centres [k] = nodes [k].min_corner + LiteMath::float3 {nodes [k].voxel_size * 0.5f};
+
+        if (values [k] < settings.iso_level) {
+            cube_index |= (1 << k);
+        }
+    }
+
+    if (cube_index_2_edge_mask [cube_index] == 0) {
+        return;
+    }
+
+    Mesh& mesh = output.mesh;
     const int *triangle_indices = cube_index_2_triangle_indices [cube_index];
-    for (int i = 0; triangle_indices [i] != -1; ++i) {
-        Vertex vertex;
-        vertex.position = edge_vertices [triangle_indices [i]];
-        vertex.normal = estimate_normal (scene, vertex.position);
-        mesh.add_vertex_fast (vertex);
+    for (int t = 0; triangle_indices [t] != -1; t += 3) {
+        uint64_t keys [3];
+        for (int j = 0; j < 3; ++j) {
+            const auto corner_indices = edge_corners [triangle_indices [t + j]];
+            keys [j] = dual_edge_key (nodes [corner_indices.x].node_index, nodes [corner_indices.y].node_index);
+        }
+        // Cells around a big leaf repeat it, and two of their edges can then name the same segment.
+        if (keys [0] == keys [1] || keys [1] == keys [2] || keys [0] == keys [2]) {
+            continue;
+        }
+
+        for (int j = 0; j < 3; ++j) {
+            bool inserted = false;
+            uint32_t& index = output.vertex_table.find_or_insert (keys [j], inserted);
+            if (inserted) {
+                auto corner_indices = edge_corners [triangle_indices [t + j]];
+                if (nodes [corner_indices.x].node_index > nodes [corner_indices.y].node_index) {
+                    std::swap (corner_indices.x, corner_indices.y);
+                }
+
+                Vertex vertex {};
+                vertex.position = interpolate_vertex (settings.iso_level
+                                                      , centres [corner_indices.x]
+                                                      , centres [corner_indices.y]
+                                                      , values [corner_indices.x]
+                                                      , values [corner_indices.y]
+                                                      );
+                if (settings.normals == MarchingCubesNormals::LeafGradient) {
+                    vertex.normal = LiteMath::normalize (sample_sdf_with_gradient (scene, vertex.position).gradient);
+                }
+
+                index = static_cast <uint32_t> (mesh.get_vertices ().size ());
+                mesh.get_mutable_vertices ().push_back (vertex);
+                output.vertex_keys.push_back (keys [j]);
+            }
+            mesh.get_mutable_indices ().push_back (index);
+        }
+    }
+}
+
+template <typename Octree>
+Mesh dual_marching_cubes (const MarchingCubesSettings& settings
+                          , const Octree& scene
+                          , Executor& executor
+                          , unsigned int concurrency
+                          , ExtractionWorkspace& workspace) {
+    std::vector <ThreadMesh>& thread_meshes = workspace.thread_meshes ();
+
+    const VoxelInfo root = octree_root_voxel_info ();
+    const VoxelInfo nodes [8] = {root, root, root, root, root, root, root, root};
+
+    auto is_leaf = [&] (const VoxelInfo& voxel_info) { return scene [voxel_info.node_index].offset == 0; };
+    auto prune = [&] (const VoxelInfo (&block) [8]) {
+        if (settings.range_index == nullptr) {
+            return false;
+        }
+        // Every dual cell below reads leaf centres inside these subtrees, so their joint range bounds it.
+        SdfOctreeRange range = settings.range_index->ranges [block [0].node_index];
+        for (int k = 1; k < 8; ++k) {
+            range.min = std::min (range.min, settings.range_index->ranges [block [k].node_index].min);
+            range.max = std::max (range.max, settings.range_index->ranges [block [k].node_index].max);
+        }
+        return !(range.min < settings.iso_level && range.max >= settings.iso_level);
+    };
+    auto visit = [&] (const VoxelInfo (&block) [8], unsigned int split_mask, unsigned int slot) {
+        if (split_mask == 7) {
+            emit_dual_cell (scene, block, settings, thread_meshes [slot]);
+        }
+    };
+
+    TaskGroup group (executor, concurrency);
+    group.run ([&] (unsigned int slot) {
+        dual_procedure (scene, nodes, 0, 0, slot, group, DUAL_TASK_SPAWN_DEPTH, is_leaf, prune, visit);
+    });
+    group.wait ();
+
+    if (settings.normals == MarchingCubesNormals::CentralDifferences) {
+        estimate_thread_mesh_normals (scene, workspace, executor, concurrency);
+    }
+
+    ScratchVector <uint64_t> keys (&workspace.arena ());
+    Mesh mesh = merge_welded_meshes (thread_meshes, executor, concurrency, workspace.arena (), settings.deterministic ? &keys : nullptr);
+    if (settings.deterministic) {
+        canonicalize_welded_mesh (mesh, keys, workspace.arena ());
     }
+    return mesh;
 }
 
-std::vector <Mesh> create_mesh_marching_cubes (const MarchingCubesSettings settings, const SdfOctree& scene) {
-    const auto previous_num_threads = omp_get_max_threads ();
-    omp_set_num_threads (settings.max_threads);
-    const auto leaves = collect_all_leaf_info (scene);
-    printf ("SDF-Octree leaves count: %u\n", (unsigned) leaves.size ());
+// Streaming extraction: the chunks are the subtrees rooted at stream_settings.chunk_depth (or leaves above it), in
+// depth-first order so consecutive chunks are spatial neighbours.
+template <typename Octree>
+void collect_chunk_roots (const Octree& scene
+                          , const VoxelInfo& voxel_info
+                          , const MarchingCubesSettings& settings
+                          , unsigned int chunk_depth
+                          , ScratchVector <VoxelInfo>& roots) {
+    if (settings.range_index != nullptr && !settings.range_index->may_contain_surface (voxel_info.node_index, settings.iso_level)) {
+        return;
+    }
+
+    const auto& node = scene [voxel_info.node_index];
+    if (node.offset == 0 || voxel_info.depth >= chunk_depth) {
+        roots.push_back (voxel_info);
+        return;
+    }
+    for (unsigned int k = 0; k < 8; ++k) {
+        collect_chunk_roots (scene, child_voxel_info (scene, voxel_info, node.offset, k), settings, chunk_depth, roots);
+    }
+}
 
-    std::vector <Mesh> thread_meshes (settings.max_threads);
-    #pragma omp parallel
-    {
-        auto& current_thread_mesh = thread_meshes [omp_get_thread_num ()];
+// Serial walk of one chunk into its own mesh; the order only depends on the tree.
+template <typename Octree>
+void extract_chunk (const Octree& scene, const VoxelInfo& voxel_info, const MarchingCubesSettings& settings, ThreadMesh& output) {
+    if (settings.range_index != nullptr && !settings.range_index->may_contain_surface (voxel_info.node_index, settings.iso_level)) {
+        return;
+    }
 
-        #pragma omp for schedule (dynamic) nowait
-        for (size_t i = 0; i < leaves.size (); ++i) {
-            process_leaf_node (leaves [i], current_thread_mesh, settings.iso_level, scene);
+    const auto& node = scene [voxel_info.node_index];
+    if (node.offset == 0) {
+        if (settings.weld_vertices && voxel_info.depth > MAX_WELD_DEPTH) {
+            output.too_deep = true;
+            return;
         }
+        process_leaf_node (voxel_info, output, settings, scene);
+        return;
+    }
+    for (unsigned int k = 0; k < 8; ++k) {
+        extract_chunk (scene, child_voxel_info (scene, voxel_info, node.offset, k), settings, output);
+    }
+}
+
+size_t chunk_mesh_bytes (const ThreadMesh& chunk) {
+    return chunk.mesh.get_vertices ().capacity () * sizeof (Vertex)
+         + chunk.mesh.get_indices ().capacity () * sizeof (uint32_t)
+         + chunk.vertex_keys.capacity () * sizeof (uint64_t)
+         + chunk.vertex_table.capacity () * (sizeof (uint64_t) + sizeof (uint32_t));
+}
+
+// Finished chunks wait in `ready` until every chunk before them has been written. Whichever worker finds the sink
+// idle writes all consecutive ready chunks, outside the lock; the others go back to extracting. A worker only starts
+// a chunk while the waiting chunks take less than the memory cap, unless it holds the next chunk to write, which
+// always runs so the sink can drain.
+class ChunkStream {
+public:
+  ChunkStream (MeshSink& a_sink, size_t chunk_count, size_t a_memory_cap, unsigned int concurrency)
+      : sink (a_sink)
+      , ready (chunk_count)
+      , memory_cap (a_memory_cap)
+      , spare_limit (concurrency) {
+  }
+
+  // Blocks while the cap is reached; false when the stream failed and the chunk should be skipped.
+  bool wait_for_room (size_t chunk) {
+      std::unique_lock <std::mutex> lock (this->mutex);
+      if (this->buffered_bytes >= this->memory_cap && chunk != this->next_to_write && !this->failed) {
+          ++this->stream_stats.stalls;
+          this->condition.wait (lock, [&] {
+              return this->buffered_bytes < this->memory_cap || chunk == this->next_to_write || this->failed;
+          });
+      }
+      return !this->failed;
+  }
+
+  std::unique_ptr <ThreadMesh> take_mesh () {
+      {
+          std::lock_guard <std::mutex> lock (this->mutex);
+          if (!this->spare.empty ()) {
+              std::unique_ptr <ThreadMesh> mesh = std::move (this->spare.back ());
+              this->spare.pop_back ();
+              return mesh;
+          }
+      }
+      return std::make_unique <ThreadMesh> ();
+  }
+
+  void finish (size_t chunk, std::unique_ptr <ThreadMesh> mesh) {
+      std::unique_lock <std::mutex> lock (this->mutex);
+      this->buffered_bytes += chunk_mesh_bytes (*mesh);
+      this->stream_stats.peak_buffered_bytes = std::max (this->stream_stats.peak_buffered_bytes, this->buffered_bytes);
+      this->ready [chunk] = std::move (mesh);
+      if (this->writing) {
+          return;
+      }
+
+      this->writing = true;
+      while (!this->failed && this->next_to_write < this->ready.size () && this->ready [this->next_to_write] != nullptr) {
+          std::unique_ptr <ThreadMesh> current = std::move (this->ready [this->next_to_write]);
+          lock.unlock ();
+          try {
+              this->write (this->next_to_write, current->mesh);
+          } catch (...) {
+              lock.lock ();
+              this->writing = false;
+              this->failed = true;
+              this->condition.notify_all ();
+              throw;
+          }
+          lock.lock ();
+
+          this->buffered_bytes -= chunk_mesh_bytes (*current);
+          ++this->next_to_write;
+          this->recycle (std::move (current));
+          this->condition.notify_all ();
+      }
+      this->writing = false;
+  }
+
+  void fail () {
+      std::lock_guard <std::mutex> lock (this->mutex);
+      this->failed = true;
+      this->condition.notify_all ();
+  }
+
+  const MeshStreamStats& stats () const { return this->stream_stats; }
+
+private:
+  // Only the writing worker touches vertex_base and the counters, so they need no lock.
+  void write (size_t chunk, const Mesh& mesh) {
+      const auto& vertices = mesh.get_vertices ();
+      const auto& indices = mesh.get_indices ();
+      if (indices.empty ()) {
+          return;
+      }
+
+      MeshChunk data;
+      data.index = chunk;
+      data.vertex_base = this->vertex_base;
+      data.vertices = vertices.data ();
+      data.vertex_count = vertices.size ();
+      data.indices = indices.data ();
+      data.index_count = indices.size ();
+      this->sink.write (data);
+
+      this->vertex_base += vertices.size ();
+      ++this->stream_stats.chunks;
+      this->stream_stats.vertices += vertices.size ();
+      this->stream_stats.triangles += indices.size () / 3;
+  }
+
+  // Keeps up to one spare mesh per thread so their storage is reused; more would only hold memory.
+  void recycle (std::unique_ptr <ThreadMesh> mesh) {
+      if (this->spare.size () >= this->spare_limit) {
+          return;
+      }
+      mesh->mesh.clear ();
+      mesh->vertex_keys.clear ();
+      mesh->vertex_table.clear ();
+      mesh->too_deep = false;
+      this->spare.push_back (std::move (mesh));
+  }
+
+  MeshSink& sink;
+  std::vector <std::unique_ptr <ThreadMesh>> ready;
+  std::vector <std::unique_ptr <ThreadMesh>> spare;
+  size_t memory_cap;
+  size_t spare_limit;
+  size_t next_to_write = 0;
+  size_t buffered_bytes = 0;
+  size_t vertex_base = 0;
+  bool writing = false;
+  bool failed = false;
+  MeshStreamStats stream_stats;
+  std::mutex mutex;
+  std::condition_variable condition;
+};
+
+template <typename Octree>
+MeshStreamStats stream_marching_cubes (const MarchingCubesSettings settings
+                                       , const MeshStreamSettings& stream_settings
+                                       , const Octree& scene
+                                       , MeshSink& sink) {
+    if (scene.empty ()) {
+        throw std::runtime_error {"[stream_marching_cubes]: empty sdf"};
+    }
+    if (settings.grid != MarchingCubesGrid::Primal) {
+        throw std::runtime_error {"[stream_marching_cubes]: only the primal grid can be streamed"};
+    }
+    if (settings.range_index != nullptr && settings.range_index->size () != scene.size ()) {
+        throw std::runtime_error {"[stream_marching_cubes]: range index does not match the octree"};
+    }
+
+    Executor& executor = settings.get_executor ();
+    const unsigned int concurrency = static_cast <unsigned int> (std::max (1, settings.max_threads));
+    ExtractionWorkspace& workspace = settings.workspace != nullptr ? *settings.workspace : ExtractionWorkspace::for_current_thread ();
+    workspace.begin (concurrency);
+
+    ScratchVector <VoxelInfo> roots (&workspace.arena ());
+    collect_chunk_roots (scene, octree_root_voxel_info (), settings, stream_settings.chunk_depth, roots);
+
+    ChunkStream stream (sink, roots.size (), stream_settings.memory_cap, concurrency);
+    sink.begin ();
+    try {
+        parallel_for (executor, concurrency, roots.size (), 1, [&] (size_t first, size_t last, unsigned int slot) {
+            for (size_t chunk = first; chunk < last; ++chunk) {
+                if (!stream.wait_for_room (chunk)) {
+                    return;
+                }
+                try {
+                    std::unique_ptr <ThreadMesh> output = stream.take_mesh ();
+                    extract_chunk (scene, roots [chunk], settings, *output);
+                    if (output->too_deep) {
+                        throw std::runtime_error {"[stream_marching_cubes]: vertex welding supports octrees up to " + std::to_string (MAX_WELD_DEPTH) + " levels deep"};
+                    }
+                    if (settings.normals == MarchingCubesNormals::CentralDifferences) {
+                        auto& vertices = output->mesh.get_mutable_vertices ();
+                        estimate_normals (scene, vertices.data (), vertices.size (), workspace.slot_arena (slot));
+                    }
+                    stream.finish (chunk, std::move (output));
+                } catch (...) {
+                    // Wake the workers waiting for room, they would otherwise wait for this chunk forever.
+                    stream.fail ();
+                    throw;
+                }
+            }
+        });
+    } catch (...) {
+        sink.abort ();
+        throw;
     }
+    sink.end ();
 
-    for (int tid = 0; tid < settings.max_threads; ++tid) {
-        printf ("Marching Cubes [%u]: %u vertices, %u triangles\n"
-                , (unsigned) tid
-                , (unsigned) thread_meshes [tid].get_vertices ().size ()
-                , (unsigned) thread_meshes [tid].get_indices ().size () / 3
-                );
+    const MeshStreamStats& stats = stream.stats ();
+    printf ("Marching Cubes (streamed): %u vertices, %u triangles in %u chunks, peak %.1f MiB buffered\n"
+            , (unsigned) stats.vertices
+            , (unsigned) stats.triangles
+            , (unsigned) stats.chunks
+            , stats.peak_buffered_bytes / double (1 << 20)
+            );
+    return stats;
+}
+
+template <typename Octree>
+Mesh marching_cubes (const MarchingCubesSettings settings, const Octree& scene) {
+    if (scene.empty ()) {
+        throw std::runtime_error {"[marching_cubes]: empty sdf"};
+    }
+    if (settings.range_index != nullptr && settings.range_index->size () != scene.size ()) {
+        throw std::runtime_error {"[marching_cubes]: range index does not match the octree"};
     }
 
-    omp_set_num_threads (previous_num_threads);
-    return thread_meshes;
+    // Nothing process-wide is touched: the call borrows at most max_threads threads of the executor.
+    Executor& executor = settings.get_executor ();
+    const unsigned int concurrency = static_cast <unsigned int> (std::max (1, settings.max_threads));
+    ExtractionWorkspace& workspace = settings.workspace != nullptr ? *settings.workspace : ExtractionWorkspace::for_current_thread ();
+    workspace.begin (concurrency);
+
+    Mesh mesh;
+    if (settings.grid == MarchingCubesGrid::Dual) {
+        mesh = dual_marching_cubes (settings, scene, executor, concurrency, workspace);
+    } else if (settings.deterministic) {
+        mesh = marching_cubes_two_pass (settings, scene, executor, concurrency, workspace);
+    } else {
+        mesh = marching_cubes_single_pass (settings, scene, executor, concurrency, workspace);
+    }
+
+    printf ("Marching Cubes: %u vertices, %u triangles\n"
+            , (unsigned) mesh.get_vertices ().size ()
+            , (unsigned) mesh.get_indices ().size () / 3
+            );
+
+    return mesh;
+}
+
+Mesh create_mesh_marching_cubes (const MarchingCubesSettings settings, const SdfOctreeView& scene) {
+    return marching_cubes (settings, scene);
+}
+
+Mesh create_mesh_marching_cubes (const MarchingCubesSettings settings, const SdfOctreeQ8& scene) {
+    return marching_cubes (settings, scene);
+}
+
+Mesh create_mesh_marching_cubes (const MarchingCubesSettings settings, const SdfOctreeQ16& scene) {
+    return marching_cubes (settings, scene);
+}
+
+Mesh create_mesh_marching_cubes (const MarchingCubesSettings settings, const SharedCornerSdfOctree& scene) {
+    return marching_cubes (settings, scene);
+}
+
+MeshStreamStats stream_mesh_marching_cubes (const MarchingCubesSettings settings, const MeshStreamSettings& stream_settings, const SdfOctreeView& scene, MeshSink& sink) {
+    return stream_marching_cubes (settings, stream_settings, scene, sink);
+}
+
+MeshStreamStats stream_mesh_marching_cubes (const MarchingCubesSettings settings, const MeshStreamSettings& stream_settings, const SdfOctreeQ8& scene, MeshSink& sink) {
+    return stream_marching_cubes (settings, stream_settings, scene, sink);
+}
+
+MeshStreamStats stream_mesh_marching_cubes (const MarchingCubesSettings settings, const MeshStreamSettings& stream_settings, const SdfOctreeQ16& scene, MeshSink& sink) {
+    return stream_marching_cubes (settings, stream_settings, scene, sink);
+}
+
+MeshStreamStats stream_mesh_marching_cubes (const MarchingCubesSettings settings, const MeshStreamSettings& stream_settings, const SharedCornerSdfOctree& scene, MeshSink& sink) {
+    return stream_marching_cubes (settings, stream_settings, scene, sink);
 }
 
 }
@@ -4,17 +4,59 @@
 
 #include "LiteMath.h"
 
+#include "executor.hpp"
+#include "extraction_workspace.hpp"
 #include "mesh.hpp"
-#include "sdf_octree.hpp"
+#include "mesh_stream.hpp"
+#include "sdf_octree_formats.hpp"
+#include "sdf_octree_range.hpp"
 
 namespace sdf_raster {
 
-struct MarchingCubesSettings {
+enum class MarchingCubesNormals {
+    CentralDifferences, // 6 extra tree lookups per vertex, smooth across leaf borders
+    LeafGradient,       // analytic gradient of the producing leaf, no extra lookups
+};
+
+enum class MarchingCubesGrid {
+    Primal, // one cube per leaf: cracks where leaves of different size meet
+    Dual,   // dual marching cubes over leaf centres: no cracks between levels, always welded; LeafGradient normals cost one
+            // lookup per vertex; misses surface within half a leaf of the domain boundary
+};
+
+enum class MarchingCubesCases {
+    Specialized, // one generated kernel per cube index, dispatched through a jump table
+    TableDriven, // walks the lookup tables per leaf; kept as the reference for benchmarks
+};
+
+struct MarchingCubesSettings : ParallelSettings {
     float iso_level = 0.5f;
-    int max_threads = 1;
+    ExtractionWorkspace* workspace = nullptr; // scratch memory reused across calls; the calling thread's when null
+    MarchingCubesNormals normals = MarchingCubesNormals::CentralDifferences;
+    MarchingCubesGrid grid = MarchingCubesGrid::Primal;
+    MarchingCubesCases cases = MarchingCubesCases::Specialized; // primal grid only
+    bool deterministic = false; // same output for any max_threads: two-pass count-then-write, or canonical ordering on the dual grid
+    bool weld_vertices = false; // one shared vertex per octree edge and a single indexed mesh instead of per-thread triangle soups
+    const SdfOctreeRangeIndex* range_index = nullptr; // optional, built from the same octree; prunes subtrees without surface
 };
 
-std::vector <Mesh> create_mesh_marching_cubes (const MarchingCubesSettings settings, const SdfOctree& sdf_octree);
+Mesh create_mesh_marching_cubes (const MarchingCubesSettings settings, const SdfOctreeView& sdf_octree);
+Mesh create_mesh_marching_cubes (const MarchingCubesSettings settings, const SdfOctreeQ8& sdf_octree);
+Mesh create_mesh_marching_cubes (const MarchingCubesSettings settings, const SdfOctreeQ16& sdf_octree);
+Mesh create_mesh_marching_cubes (const MarchingCubesSettings settings, const SharedCornerSdfOctree& sdf_octree);
+
+// Extracts the surface chunk by chunk and hands every chunk to `sink` as soon as it and all chunks before it are
+// done, so the whole mesh is never held in memory. Finished chunks waiting for the sink are capped at
+// stream_settings.memory_cap bytes: past it, workers wait instead of starting new chunks. Output is the same for any
+// max_threads. Primal grid only; `deterministic` is implied. With weld_vertices, vertices are shared within a chunk
+// and repeated (at identical positions) on the borders between chunks.
+MeshStreamStats stream_mesh_marching_cubes (const MarchingCubesSettings settings, const MeshStreamSettings& stream_settings, const SdfOctreeView& sdf_octree, MeshSink& sink);
+MeshStreamStats stream_mesh_marching_cubes (const MarchingCubesSettings settings, const MeshStreamSettings& stream_settings, const SdfOctreeQ8& sdf_octree, MeshSink& sink);
+MeshStreamStats stream_mesh_marching_cubes (const MarchingCubesSettings settings, const MeshStreamSettings& stream_settings, const SdfOctreeQ16& sdf_octree, MeshSink& sink);
+MeshStreamStats stream_mesh_marching_cubes (const MarchingCubesSettings settings, const MeshStreamSettings& stream_settings, const SharedCornerSdfOctree& sdf_octree, MeshSink& sink);
+
+// Cube indices of `count` leaves at once. Corner values are SoA: corner c of leaf i is values [c * stride + i].
+void classify_leaves (const float* values, size_t stride, size_t count, float iso_level, uint8_t* cube_indices);
 
 }
 
@@ -0,0 +1,98 @@
+#include <cstring>
+
+#if defined (__x86_64__) || defined (__i386__)
+#include <immintrin.h>
+#define SDF_RASTER_X86_SIMD 1
+#endif
+
+#include "marching_cubes.hpp"
+
+namespace sdf_raster {
+
+namespace {
+
+void classify_leaves_scalar (const float* values, size_t stride, size_t count, float iso_level, uint8_t* cube_indices) {
+    for (size_t i = 0; i < count; ++i) {
+        unsigned int cube_index = 0;
+        for (unsigned int c = 0; c < 8; ++c) {
+            cube_index |= static_cast <unsigned int> (values [c * stride + i] < iso_level) << c;
+        }
+        cube_indices [i] = static_cast <uint8_t> (cube_index);
+    }
+}
+
+#ifdef SDF_RASTER_X86_SIMD
+
+// Byte c holds the movemask of corner c over 8 leaves; after the transpose byte i holds the cube index of leaf i.
+inline uint64_t transpose_8x8_bits (uint64_t x) {
+    uint64_t t;
+    t = (x ^ (x >> 7)) & 0x00aa00aa00aa00aaull;
+    x = x ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000cccc0000ccccull;
+    x = x ^ t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000f0f0f0f0ull;
+    x = x ^ t ^ (t << 28);
+    return x;
+}
+
+__attribute__ ((target ("avx2")))
+void classify_leaves_avx2 (const float* values, size_t stride, size_t count, float iso_level, uint8_t* cube_indices) {
+    const __m256 iso = _mm256_set1_ps (iso_level);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint64_t masks = 0;
+        for (unsigned int c = 0; c < 8; ++c) {
+            const __m256 inside = _mm256_cmp_ps (_mm256_loadu_ps (values + c * stride + i), iso, _CMP_LT_OQ);
+            masks |= static_cast <uint64_t> (_mm256_movemask_ps (inside)) << (8 * c);
+        }
+        const uint64_t indices = transpose_8x8_bits (masks);
+        std::memcpy (cube_indices + i, &indices, 8);
+    }
+    classify_leaves_scalar (values + i, stride, count - i, iso_level, cube_indices + i);
+}
+
+// GCC's AVX-512 headers start several intrinsics from _mm512_undefined_*, which trips -Wmaybe-uninitialized.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+__attribute__ ((target ("avx512f")))
+void classify_leaves_avx512 (const float* values, size_t stride, size_t count, float iso_level, uint8_t* cube_indices) {
+    const __m512 iso = _mm512_set1_ps (iso_level);
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512i indices = _mm512_setzero_si512 ();
+        for (unsigned int c = 0; c < 8; ++c) {
+            const __mmask16 inside = _mm512_cmp_ps_mask (_mm512_loadu_ps (values + c * stride + i), iso, _CMP_LT_OQ);
+            indices = _mm512_mask_or_epi32 (indices, inside, indices, _mm512_set1_epi32 (1 << c));
+        }
+        _mm_storeu_si128 (reinterpret_cast <__m128i*> (cube_indices + i), _mm512_cvtepi32_epi8 (indices));
+    }
+    classify_leaves_avx2 (values + i, stride, count - i, iso_level, cube_indices + i);
+}
+
+#pragma GCC diagnostic pop
+
+#endif // SDF_RASTER_X86_SIMD
+
+}
+
+void classify_leaves (const float* values, size_t stride, size_t count, float iso_level, uint8_t* cube_indices) {
+#ifdef SDF_RASTER_X86_SIMD
+    static const bool has_avx512 = __builtin_cpu_supports ("avx512f");
+    static const bool has_avx2 = __builtin_cpu_supports ("avx2");
+    if (has_avx512) {
+        classify_leaves_avx512 (values, stride, count, iso_level, cube_indices);
+        return;
+    }
+    if (has_avx2) {
+        classify_leaves_avx2 (values, stride, count, iso_level, cube_indices);
+        return;
+    }
+#endif
+
+    classify_leaves_scalar (values, stride, count, iso_level, cube_indices);
+}
+
+}
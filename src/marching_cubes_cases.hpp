@@ -0,0 +1,95 @@
+#pragma once
+
+#include "marching_cubes_lookup_table.hpp"
+
+// Compile-time view of the marching cubes case tables, used to generate one specialized kernel per cube index.
+
+namespace sdf_raster {
+
+// Same pairs as edge_corners, which cannot be read in constant expressions (LiteMath::uint2 is not a literal type).
+constexpr int edge_corner_indices [12] [2] = {
+    {0, 1}, {1, 3}, {3, 2}, {2, 0}
+    , {4, 5}, {5, 7}, {7, 6}, {6, 4}
+    , {0, 4}, {1, 5}, {3, 7}, {2, 6}
+};
+
+// Edges crossed by the surface in one case, in increasing edge order, and the slot of every crossed edge.
+struct CaseEdges {
+    int edges [12] = {};
+    int slots [12] = {};
+    int count = 0;
+};
+
+constexpr int generated_edge_mask (int cube_index) {
+    int mask = 0;
+    for (int edge = 0; edge < 12; ++edge) {
+        const bool inside_0 = (cube_index >> edge_corner_indices [edge] [0]) & 1;
+        const bool inside_1 = (cube_index >> edge_corner_indices [edge] [1]) & 1;
+        if (inside_0 != inside_1) {
+            mask |= 1 << edge;
+        }
+    }
+    return mask;
+}
+
+constexpr CaseEdges case_edges (int cube_index) {
+    CaseEdges result;
+    for (int edge = 0; edge < 12; ++edge) {
+        if ((cube_index_2_edge_mask [cube_index] >> edge) & 1) {
+            result.slots [edge] = result.count;
+            result.edges [result.count++] = edge;
+        }
+    }
+    return result;
+}
+
+constexpr int case_vertex_count (int cube_index) {
+    int count = 0;
+    while (count < 16 && cube_index_2_triangle_indices [cube_index] [count] != -1) {
+        ++count;
+    }
+    return count;
+}
+
+// The edge mask must follow from the corner signs, and the triangle list must be whole triangles over exactly the
+// crossed edges with no edge repeated inside a triangle, terminated by -1.
+constexpr bool case_tables_are_consistent () {
+    for (int cube_index = 0; cube_index < 256; ++cube_index) {
+        const int mask = cube_index_2_edge_mask [cube_index];
+        if (mask != generated_edge_mask (cube_index)) {
+            return false;
+        }
+
+        const int vertex_count = case_vertex_count (cube_index);
+        if (vertex_count % 3 != 0 || vertex_count > 15) {
+            return false;
+        }
+
+        int used = 0;
+        const int* triangles = cube_index_2_triangle_indices [cube_index];
+        for (int i = 0; i < vertex_count; i += 3) {
+            for (int j = 0; j < 3; ++j) {
+                if (triangles [i + j] < 0 || triangles [i + j] >= 12 || ((mask >> triangles [i + j]) & 1) == 0) {
+                    return false;
+                }
+                used |= 1 << triangles [i + j];
+            }
+            if (triangles [i] == triangles [i + 1] || triangles [i + 1] == triangles [i + 2] || triangles [i] == triangles [i + 2]) {
+                return false;
+            }
+        }
+        if (used != mask) {
+            return false;
+        }
+        for (int i = vertex_count; i < 16; ++i) {
+            if (triangles [i] != -1) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static_assert (case_tables_are_consistent (), "marching cubes case tables are inconsistent");
+
+}
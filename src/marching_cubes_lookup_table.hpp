@@ -58,7 +58,7 @@ static const LiteMath::uint2 edge_corners [12] = {
     , LiteMath::uint2 {2, 6}
 };
 
-static const int cube_index_2_edge_mask [256] = {
+static constexpr int cube_index_2_edge_mask [256] = {
     0x0, 0x109, 0x203, 0x30a, 0x80c, 0x905, 0xa0f, 0xb06
     , 0x406, 0x50f, 0x605, 0x70c, 0xc0a, 0xd03, 0xe09, 0xf00
     , 0x190, 0x99, 0x393, 0x29a, 0x99c, 0x895, 0xb9f, 0xa96
@@ -93,7 +93,7 @@ static const int cube_index_2_edge_mask [256] = {
     , 0xb06, 0xa0f, 0x905, 0x80c, 0x30a, 0x203, 0x109, 0x0
 };
 
-static const int cube_index_2_triangle_indices [256][16] = {
+static constexpr int cube_index_2_triangle_indices [256][16] = {
 	{ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
 	{ 0, 3, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
 	{ 0, 9, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
@@ -101,7 +101,7 @@ static const int cube_index_2_triangle_indices [256][16] = {
 	{ 2, 11, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
 	{ 8, 0, 11, 11, 0, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
 	{ 3, 2, 11, 1, 0, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{ 11, 1, 2, 11, 9, 1, 11, 8, 9, -1, 12, 13, -1, -1, -1, -1 },
+	{ 11, 1, 2, 11, 9, 1, 11, 8, 9, -1, -1, -1, -1, -1, -1, -1 },
 	{ 1, 10, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
 	{ 0, 3, 8, 2, 1, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
 	{ 10, 2, 9, 9, 2, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
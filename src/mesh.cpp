@@ -1,29 +1,9 @@
-#include <fstream>
+#include <stdexcept>
 
 #include "mesh.hpp"
 
 namespace sdf_raster {
 
-std::size_t hash_vec(const LiteMath::float3& v) {
-    float x = v.x;
-    float y = v.y;
-    float z = v.z;
-
-    x = x >=0 ? 2 * x : -2 * x - 1;
-    y = y >=0 ? 2 * y : -2 * y - 1;
-    z = z >=0 ? 2 * z : -2 * z - 1;
-
-    auto max = std::max({x,y,z});
-    double hash = pow(max,3) + (2 * max * z) + z;
-    if(max == z)
-        hash += pow(std::max(x,y), 2);
-    if(y >= x)
-        hash += x+y;
-    else
-        hash += y;
-    return static_cast<std::size_t>(hash);
-}
-
 Mesh::Mesh() {
 }
 
@@ -33,11 +13,22 @@ Mesh::Mesh(std::vector<uint32_t>&& idxs, std::vector<Vertex>&& verts)
 void Mesh::set_data(std::vector<Vertex>&& verts, std::vector<uint32_t>&& idxs) {
     vertices = std::move(verts);
     indices = std::move(idxs);
+    weld_table.clear();
 }
 
 void Mesh::clear() {
     vertices.clear();
     indices.clear();
+    weld_table.clear();
+}
+
+// Only vertices added after the call weld with the new tolerance.
+void Mesh::set_weld_tolerance(float tolerance) {
+    if (!(tolerance >= 0.0f)) {
+        throw std::runtime_error {"[Mesh::set_weld_tolerance]: tolerance must be >= 0"};
+    }
+    inverse_weld_tolerance = tolerance > 0.0f ? 1.0f / tolerance : 0.0f;
+    weld_table.clear();
 }
 
 void Mesh::add_vertex(Vertex v) {
@@ -62,49 +53,13 @@ void Mesh::add_triangle(Vertex a, Vertex b, Vertex c) {
 }
 
 uint32_t Mesh::index_vertex(const Vertex& v) {
-    auto it = vertex_to_index.find(v);
-    if (it != vertex_to_index.end()) {
-        return it->second;
-    } else {
-        int new_index = vertices.size();
+    bool inserted = false;
+    uint32_t& index = weld_table.find_or_insert(make_weld_key(v.position, inverse_weld_tolerance), inserted);
+    if (inserted) {
+        index = static_cast<uint32_t>(vertices.size());
         vertices.push_back(v);
-        vertex_to_index[v] = new_index;
-        return new_index;
-    }
-}
-
-void save_mesh_as_obj (const Mesh& mesh, const std::string& filename) {
-    printf ("Saving mesh to '%s'...\n", filename.c_str ());
-
-    std::ofstream out (filename);
-    if (!out) {
-        throw std::runtime_error ("Failed to open file: " + filename);
-    }
-
-    const auto& vertices = mesh.get_vertices ();
-    const auto& indices  = mesh.get_indices ();
-
-    for (const auto& v : vertices) {
-        out << "v " 
-            << v.position.x << " " << v.position.y << " " << v.position.z 
-            << "\n";
-    }
-    for (const auto& v : vertices) {
-        out << "vn " 
-            << v.normal.x << " " << v.normal.y << " " << v.normal.z 
-            << "\n";
-    }
-
-    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
-        uint32_t i0 = indices[i + 0] + 1;
-        uint32_t i1 = indices[i + 1] + 1;
-        uint32_t i2 = indices[i + 2] + 1;
-        out << "f "
-            << i0 << "//" << i0 << " "
-            << i1 << "//" << i1 << " "
-            << i2 << "//" << i2 << "\n";
     }
-    printf ("Saved mesh to '%s'.\n", filename.c_str ());
+    return index;
 }
 
 }
@@ -1,10 +1,10 @@
 #pragma once
 
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include "LiteMath.h"
+#include "position_weld.hpp"
 
 namespace sdf_raster {
 
@@ -20,18 +20,6 @@ namespace sdf_raster {
         }
     };
     
-    std::size_t hash_vec(const LiteMath::float3& v);
-    
-    struct VertexHash {
-        std::size_t operator()(const Vertex& v) const {
-            std::size_t seed = 0;
-            seed ^= hash_vec(v.position) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-            seed ^= hash_vec(v.normal) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-            seed ^= hash_vec(v.color) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-            return seed;
-        }
-    };
-    
     class Mesh {
     public:
         Mesh();
@@ -39,25 +27,29 @@ namespace sdf_raster {
     
         const std::vector<Vertex>& get_vertices() const { return this->vertices; }
         const std::vector<uint32_t>& get_indices() const { return this->indices; }
+        std::vector<Vertex>& get_mutable_vertices() { return this->vertices; }
+        std::vector<uint32_t>& get_mutable_indices() { return this->indices; }
     
         void set_data(std::vector<Vertex>&& verts, std::vector<uint32_t>&& idxs);
         void clear();
         bool is_empty() const { return vertices.empty(); }
     
+        // add_vertex and add_triangle weld by position: a vertex with the weld key (see position_weld.hpp) of one added
+        // through them before reuses that vertex, normal and color included. Tolerance 0 welds identical positions only.
         void add_vertex(Vertex v);
         void add_vertex_fast(Vertex v);
         void add_triangle(Vertex a, Vertex b, Vertex c);
+        void set_weld_tolerance(float tolerance);
     
     private:
         uint32_t index_vertex(const Vertex& v);
     
     private:
-        std::unordered_map<Vertex, uint32_t, VertexHash> vertex_to_index;
+        PositionWeldTable weld_table;
+        float inverse_weld_tolerance = 0.0f;
         std::vector<uint32_t> indices {};
         std::vector<Vertex> vertices {};
     };
-
-    void save_mesh_as_obj (const Mesh& mesh, const std::string& filename);
     
 }
 
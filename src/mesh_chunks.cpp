@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <limits>
+
+#include "mesh_chunks.hpp"
+
+namespace sdf_raster {
+
+namespace {
+
+constexpr size_t RANGE_GRAIN = 1 << 16;
+
+// Spreads the low 10 bits of x to every third bit.
+uint32_t spread_bits (uint32_t x) {
+    x &= 0x3ff;
+    x = (x | (x << 16)) & 0x030000ff;
+    x = (x | (x << 8)) & 0x0300f00f;
+    x = (x | (x << 4)) & 0x030c30c3;
+    x = (x | (x << 2)) & 0x09249249;
+    return x;
+}
+
+}
+
+std::vector <uint32_t> morton_triangle_order (const Mesh& mesh
+                                              , Executor& executor
+                                              , unsigned int concurrency
+                                              , std::vector <LiteMath::float3>* centroids) {
+    const std::vector <Vertex>& vertices = mesh.get_vertices ();
+    const std::vector <uint32_t>& indices = mesh.get_indices ();
+    const size_t triangle_count = indices.size () / 3;
+
+    std::vector <LiteMath::float3> triangle_centroids (triangle_count);
+    parallel_for (executor, concurrency, triangle_count, RANGE_GRAIN, [&] (size_t first, size_t last, unsigned int) {
+        for (size_t t = first; t < last; ++t) {
+            const uint32_t* triangle = &indices [3 * t];
+            triangle_centroids [t] = (vertices [triangle [0]].position
+                    + vertices [triangle [1]].position
+                    + vertices [triangle [2]].position) * (1.0f / 3.0f);
+        }
+    });
+
+    LiteMath::float3 bounds_min {std::numeric_limits <float>::max ()};
+    LiteMath::float3 bounds_max {std::numeric_limits <float>::lowest ()};
+    for (const LiteMath::float3& centroid : triangle_centroids) {
+        bounds_min = LiteMath::min (bounds_min, centroid);
+        bounds_max = LiteMath::max (bounds_max, centroid);
+    }
+    const LiteMath::float3 extent = LiteMath::max (bounds_max - bounds_min, LiteMath::float3 {0.0f});
+    const float largest_extent = std::max ({extent.x, extent.y, extent.z});
+    const float scale = largest_extent > 0.0f ? 1023.0f / largest_extent : 0.0f;
+
+    // Morton code in the high half, triangle id in the low one: sorted keys are the curve order with ties by id.
+    std::vector <uint64_t> keys (triangle_count);
+    parallel_for (executor, concurrency, triangle_count, RANGE_GRAIN, [&] (size_t first, size_t last, unsigned int) {
+        for (size_t t = first; t < last; ++t) {
+            const LiteMath::float3 q = (triangle_centroids [t] - bounds_min) * scale;
+            const uint32_t code = spread_bits (uint32_t (q.x)) | spread_bits (uint32_t (q.y)) << 1 | spread_bits (uint32_t (q.z)) << 2;
+            keys [t] = uint64_t {code} << 32 | t;
+        }
+    });
+    std::sort (keys.begin (), keys.end ());
+
+    std::vector <uint32_t> order (triangle_count);
+    if (centroids != nullptr) {
+        centroids->resize (triangle_count);
+    }
+    parallel_for (executor, concurrency, triangle_count, RANGE_GRAIN, [&] (size_t first, size_t last, unsigned int) {
+        for (size_t i = first; i < last; ++i) {
+            const uint32_t t = static_cast <uint32_t> (keys [i]);
+            order [i] = t;
+            if (centroids != nullptr) {
+                (*centroids) [i] = triangle_centroids [t];
+            }
+        }
+    });
+    return order;
+}
+
+void ChunkVertexTable::reset (size_t count) {
+    size_t capacity = 16;
+    while (capacity < 2 * count) {
+        capacity *= 2;
+    }
+    this->keys.assign (capacity, EMPTY);
+    this->values.resize (capacity);
+}
+
+void TriangleChunk::load (const Mesh& mesh, const uint32_t* triangles, size_t count) {
+    const std::vector <uint32_t>& indices = mesh.get_indices ();
+
+    this->ids.reset (3 * count);
+    this->vertices.clear ();
+    this->corners.resize (3 * count);
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t* triangle = &indices [3 * size_t {triangles [i]}];
+        for (int corner = 0; corner < 3; ++corner) {
+            const uint32_t id = this->ids.find_or_insert (triangle [corner], static_cast <uint32_t> (this->vertices.size ()));
+            if (id == this->vertices.size ()) {
+                this->vertices.push_back (triangle [corner]);
+            }
+            this->corners [3 * i + corner] = id;
+        }
+    }
+
+    // Filled in triangle order, so every list is sorted.
+    const size_t vertex_count = this->vertices.size ();
+    this->adjacency_offsets.assign (vertex_count + 2, 0);
+    for (const uint32_t id : this->corners) {
+        ++this->adjacency_offsets [id + 2];
+    }
+    for (size_t v = 0; v < vertex_count; ++v) {
+        this->adjacency_offsets [v + 2] += this->adjacency_offsets [v + 1];
+    }
+    // adjacency_offsets [v + 1] is the fill position of v, and ends up at the end of its list.
+    this->adjacency.resize (this->corners.size ());
+    for (size_t i = 0; i < this->corners.size (); ++i) {
+        this->adjacency [this->adjacency_offsets [this->corners [i] + 1]++] = static_cast <uint32_t> (i / 3);
+    }
+    this->adjacency_offsets.pop_back ();
+}
+
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "LiteMath.h"
+#include "executor.hpp"
+#include "mesh.hpp"
+
+namespace sdf_raster {
+
+// Triangle ids of `mesh` along a Morton curve of their centroids, ties by id, so consecutive runs of the result are
+// spatial chunks. `centroids`, when set, receives the centroid of every triangle in that order.
+std::vector <uint32_t> morton_triangle_order (const Mesh& mesh
+                                              , Executor& executor
+                                              , unsigned int concurrency
+                                              , std::vector <LiteMath::float3>* centroids = nullptr);
+
+// Mesh vertex to chunk vertex ids, open addressing over at least twice the entries.
+class ChunkVertexTable {
+public:
+  void reset (size_t count);
+
+  // Id of `vertex`, inserting it with `id` when it is new.
+  uint32_t find_or_insert (uint32_t vertex, uint32_t id) {
+      const size_t mask = this->keys.size () - 1;
+      size_t slot = (size_t {vertex} * 0x9E3779B1u >> 7) & mask;
+      while (this->keys [slot] != EMPTY) {
+          if (this->keys [slot] == vertex) {
+              return this->values [slot];
+          }
+          slot = (slot + 1) & mask;
+      }
+      this->keys [slot] = vertex;
+      this->values [slot] = id;
+      return id;
+  }
+
+private:
+  static constexpr uint32_t EMPTY = ~0u;
+
+  std::vector <uint32_t> keys;
+  std::vector <uint32_t> values;
+};
+
+// A run of triangles with their vertices numbered by first use and the adjacency between the two, for passes that
+// work on one spatial chunk at a time through plain arrays. Reused across chunks, it keeps its storage.
+struct TriangleChunk {
+  // Triangle i of the chunk is mesh triangle triangles [i].
+  void load (const Mesh& mesh, const uint32_t* triangles, size_t count);
+
+  size_t triangle_count () const { return this->corners.size () / 3; }
+  size_t vertex_count () const { return this->vertices.size (); }
+  uint32_t degree (uint32_t v) const { return this->adjacency_offsets [v + 1] - this->adjacency_offsets [v]; }
+
+  std::vector <uint32_t> vertices;          // chunk vertex to mesh vertex
+  std::vector <uint32_t> corners;           // three chunk vertices per triangle
+  std::vector <uint32_t> adjacency_offsets;
+  std::vector <uint32_t> adjacency;         // chunk vertex to chunk triangles, ascending
+
+private:
+  ChunkVertexTable ids;
+};
+
+}
@@ -0,0 +1,703 @@
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "mesh_export.hpp"
+
+namespace sdf_raster {
+
+namespace {
+
+// Items per formatting task: large enough for the write of one chunk to be a big sequential write.
+constexpr size_t EXPORT_GRAIN = 1 << 16;
+
+using ChunkBuffer = std::vector <char>;
+
+std::ofstream open_output (const std::string& filename, const char* caller) {
+    std::ofstream out (filename, std::ios::binary);
+    if (!out) {
+        throw std::runtime_error {std::string {"["} + caller + "]: failed to open file: " + filename};
+    }
+    return out;
+}
+
+void write_bytes (std::ofstream& out, const void* data, size_t size, const char* caller) {
+    out.write (static_cast <const char*> (data), static_cast <std::streamsize> (size));
+    if (!out) {
+        throw std::runtime_error {std::string {"["} + caller + "]: write failed"};
+    }
+}
+
+// Formats items [0, count) chunk by chunk with format (first, last, buffer) and writes the chunks in order. While the
+// calling thread writes one batch of chunks, the next batch is formatted on the executor.
+template <typename Format>
+void write_chunks (std::ofstream& out
+                   , Executor& executor
+                   , unsigned int concurrency
+                   , size_t count
+                   , const Format& format
+                   , const char* caller) {
+    const size_t chunk_count = (count + EXPORT_GRAIN - 1) / EXPORT_GRAIN;
+    const size_t batch_size = 2 * static_cast <size_t> (concurrency);
+    const size_t batch_count = (chunk_count + batch_size - 1) / batch_size;
+    std::vector <ChunkBuffer> batches [2] = {std::vector <ChunkBuffer> (batch_size), std::vector <ChunkBuffer> (batch_size)};
+
+    auto format_batch = [&] (TaskGroup& group, size_t batch) {
+        for (size_t chunk = batch * batch_size; chunk < std::min (chunk_count, (batch + 1) * batch_size); ++chunk) {
+            group.run ([&, chunk, batch] (unsigned int) {
+                const size_t first = chunk * EXPORT_GRAIN;
+                format (first, std::min (first + EXPORT_GRAIN, count), batches [batch & 1] [chunk - batch * batch_size]);
+            });
+        }
+    };
+
+    if (batch_count != 0) {
+        TaskGroup group (executor, concurrency);
+        format_batch (group, 0);
+        group.wait ();
+    }
+    for (size_t batch = 0; batch < batch_count; ++batch) {
+        TaskGroup group (executor, concurrency);
+        if (batch + 1 < batch_count) {
+            format_batch (group, batch + 1);
+        }
+        for (size_t chunk = batch * batch_size; chunk < std::min (chunk_count, (batch + 1) * batch_size); ++chunk) {
+            const ChunkBuffer& buffer = batches [batch & 1] [chunk - batch * batch_size];
+            write_bytes (out, buffer.data (), buffer.size (), caller);
+        }
+        group.wait ();
+    }
+}
+
+// The text `std::ostream <<` prints for a float at its default precision of 6 digits, without the locale.
+char* format_float (char* p, float value) {
+    return std::to_chars (p, p + 16, value, std::chars_format::general, 6).ptr;
+}
+
+char* format_uint (char* p, size_t value) {
+    return std::to_chars (p, p + 20, value).ptr;
+}
+
+// Binary formats are little endian, as are the hosts we build for, so values are copied as they are.
+template <typename T>
+char* store (char* p, T value) {
+    std::memcpy (p, &value, sizeof (T));
+    return p + sizeof (T);
+}
+
+char* store_float3 (char* p, const LiteMath::float3& v) {
+    p = store (p, v.x);
+    p = store (p, v.y);
+    return store (p, v.z);
+}
+
+void check_triangles (const std::vector <uint32_t>& indices, const char* caller) {
+    if (indices.size () % 3 != 0) {
+        throw std::runtime_error {std::string {"["} + caller + "]: index count is not a multiple of 3"};
+    }
+}
+
+// Vertex reads of the writers, so the float Mesh and CompactMesh go through the same code.
+struct VertexArraySource {
+  const Vertex* vertices;
+
+  LiteMath::float3 position (size_t i) const { return this->vertices [i].position; }
+  LiteMath::float3 normal (size_t i) const { return this->vertices [i].normal; }
+  const uint8_t* rgba (size_t) const { // Mesh writers never ask for colors
+      static const uint8_t none [4] = {};
+      return none;
+  }
+};
+
+struct CompactMeshSource {
+  const CompactMesh* mesh;
+
+  LiteMath::float3 position (size_t i) const { return this->mesh->position (i); }
+  LiteMath::float3 normal (size_t i) const { return this->mesh->normal (i); }
+  const uint8_t* rgba (size_t i) const { return this->mesh->get_colors ().data () + 4 * i; }
+};
+
+// Which attributes a writer emits besides positions.
+struct VertexAttributes {
+  bool normals = true;
+  bool colors = false;
+};
+
+template <typename Source>
+void append_obj_vectors_from (std::vector <char>& buffer, const Source& source, size_t first, size_t last, bool normals) {
+    // Longest line: "vn " and 3 floats of up to 12 characters each with their separator.
+    constexpr size_t max_line = 3 + 3 * 13;
+    const size_t old_size = buffer.size ();
+    buffer.resize (old_size + (last - first) * max_line);
+
+    char* p = buffer.data () + old_size;
+    for (size_t i = first; i < last; ++i) {
+        const LiteMath::float3 v = normals ? source.normal (i) : source.position (i);
+        *p++ = 'v';
+        if (normals) {
+            *p++ = 'n';
+        }
+        *p++ = ' ';
+        p = format_float (p, v.x);
+        *p++ = ' ';
+        p = format_float (p, v.y);
+        *p++ = ' ';
+        p = format_float (p, v.z);
+        *p++ = '\n';
+    }
+    buffer.resize (p - buffer.data ());
+}
+
+void append_obj_faces_with (std::vector <char>& buffer, const uint32_t* indices, size_t triangle_count, size_t index_base, bool normals) {
+    // Longest line: "f " and 3 times " <id>//<id>" with ids of up to 20 digits.
+    constexpr size_t max_line = 2 + 3 * 43;
+    const size_t old_size = buffer.size ();
+    buffer.resize (old_size + triangle_count * max_line);
+
+    char* p = buffer.data () + old_size;
+    for (size_t t = 0; t < triangle_count; ++t) {
+        *p++ = 'f';
+        for (size_t j = 0; j < 3; ++j) {
+            const size_t id = index_base + indices [3 * t + j] + 1;
+            *p++ = ' ';
+            p = format_uint (p, id);
+            if (normals) {
+                *p++ = '/';
+                *p++ = '/';
+                p = format_uint (p, id);
+            }
+        }
+        *p++ = '\n';
+    }
+    buffer.resize (p - buffer.data ());
+}
+
+template <typename Source>
+void append_stl_triangles_from (std::vector <char>& buffer, const Source& source, const uint32_t* indices, size_t triangle_count) {
+    constexpr size_t triangle_size = 12 * sizeof (float) + sizeof (uint16_t);
+    const size_t old_size = buffer.size ();
+    buffer.resize (old_size + triangle_count * triangle_size);
+
+    char* p = buffer.data () + old_size;
+    for (size_t t = 0; t < triangle_count; ++t) {
+        const LiteMath::float3 a = source.position (indices [3 * t]);
+        const LiteMath::float3 b = source.position (indices [3 * t + 1]);
+        const LiteMath::float3 c = source.position (indices [3 * t + 2]);
+
+        // Degenerate triangles get a zero normal, which readers recompute from the winding.
+        LiteMath::float3 normal = LiteMath::cross (b - a, c - a);
+        const float length = LiteMath::length (normal);
+        normal = length > 0.0f ? normal / length : LiteMath::float3 {0.0f};
+
+        p = store_float3 (p, normal);
+        p = store_float3 (p, a);
+        p = store_float3 (p, b);
+        p = store_float3 (p, c);
+        p = store (p, uint16_t {0});
+    }
+}
+
+template <typename Source>
+void save_obj (const Source& source
+               , size_t vertex_count
+               , const std::vector <uint32_t>& indices
+               , VertexAttributes attributes
+               , const std::string& filename
+               , const MeshExportSettings& settings) {
+    printf ("Saving mesh to '%s'...\n", filename.c_str ());
+
+    Executor& executor = settings.get_executor ();
+    const unsigned int concurrency = static_cast <unsigned int> (std::max (1, settings.max_threads));
+    std::ofstream out = open_output (filename, "save_mesh_as_obj");
+
+    auto format_vectors = [&source] (bool normals) {
+        return [&source, normals] (size_t first, size_t last, ChunkBuffer& buffer) {
+            buffer.clear ();
+            append_obj_vectors_from (buffer, source, first, last, normals);
+        };
+    };
+    write_chunks (out, executor, concurrency, vertex_count, format_vectors (false), "save_mesh_as_obj");
+    if (attributes.normals) {
+        write_chunks (out, executor, concurrency, vertex_count, format_vectors (true), "save_mesh_as_obj");
+    }
+
+    write_chunks (out, executor, concurrency, indices.size () / 3, [&] (size_t first, size_t last, ChunkBuffer& buffer) {
+        buffer.clear ();
+        append_obj_faces_with (buffer, indices.data () + 3 * first, last - first, 0, attributes.normals);
+    }, "save_mesh_as_obj");
+
+    printf ("Saved mesh to '%s'.\n", filename.c_str ());
+}
+
+template <typename Source>
+void save_ply (const Source& source
+               , size_t vertex_count
+               , const std::vector <uint32_t>& indices
+               , VertexAttributes attributes
+               , const std::string& filename
+               , const MeshExportSettings& settings) {
+    printf ("Saving mesh to '%s'...\n", filename.c_str ());
+    check_triangles (indices, "save_mesh_as_ply");
+
+    Executor& executor = settings.get_executor ();
+    const unsigned int concurrency = static_cast <unsigned int> (std::max (1, settings.max_threads));
+    std::ofstream out = open_output (filename, "save_mesh_as_ply");
+
+    std::string header = "ply\n"
+        "format binary_little_endian 1.0\n"
+        "comment sdf_raster\n"
+        "element vertex " + std::to_string (vertex_count) + "\n"
+        "property float x\n"
+        "property float y\n"
+        "property float z\n";
+    if (attributes.normals) {
+        header += "property float nx\n"
+            "property float ny\n"
+            "property float nz\n";
+    }
+    if (attributes.colors) {
+        header += "property uchar red\n"
+            "property uchar green\n"
+            "property uchar blue\n";
+    }
+    header += "element face " + std::to_string (indices.size () / 3) + "\n"
+        "property list uchar uint vertex_indices\n"
+        "end_header\n";
+    write_bytes (out, header.data (), header.size (), "save_mesh_as_ply");
+
+    const size_t vertex_size = 3 * sizeof (float) + (attributes.normals ? 3 * sizeof (float) : 0) + (attributes.colors ? 3 : 0);
+    write_chunks (out, executor, concurrency, vertex_count, [&] (size_t first, size_t last, ChunkBuffer& buffer) {
+        buffer.resize ((last - first) * vertex_size);
+        char* p = buffer.data ();
+        for (size_t i = first; i < last; ++i) {
+            p = store_float3 (p, source.position (i));
+            if (attributes.normals) {
+                p = store_float3 (p, source.normal (i));
+            }
+            if (attributes.colors) {
+                std::memcpy (p, source.rgba (i), 3);
+                p += 3;
+            }
+        }
+    }, "save_mesh_as_ply");
+
+    constexpr size_t face_size = 1 + 3 * sizeof (uint32_t);
+    write_chunks (out, executor, concurrency, indices.size () / 3, [&] (size_t first, size_t last, ChunkBuffer& buffer) {
+        buffer.resize ((last - first) * face_size);
+        char* p = buffer.data ();
+        for (size_t t = first; t < last; ++t) {
+            p = store (p, uint8_t {3});
+            p = store (p, indices [3 * t]);
+            p = store (p, indices [3 * t + 1]);
+            p = store (p, indices [3 * t + 2]);
+        }
+    }, "save_mesh_as_ply");
+
+    printf ("Saved mesh to '%s'.\n", filename.c_str ());
+}
+
+template <typename Source>
+void save_stl (const Source& source, const std::vector <uint32_t>& indices, const std::string& filename, const MeshExportSettings& settings) {
+    printf ("Saving mesh to '%s'...\n", filename.c_str ());
+    check_triangles (indices, "save_mesh_as_stl");
+
+    Executor& executor = settings.get_executor ();
+    const unsigned int concurrency = static_cast <unsigned int> (std::max (1, settings.max_threads));
+    const size_t triangle_count = indices.size () / 3;
+    if (triangle_count > std::numeric_limits <uint32_t>::max ()) {
+        throw std::runtime_error {"[save_mesh_as_stl]: too many triangles for STL"};
+    }
+    std::ofstream out = open_output (filename, "save_mesh_as_stl");
+
+    // The header must not start with "solid", or readers take the file for ASCII STL.
+    char header [80] = {};
+    std::strncpy (header, "sdf_raster binary STL", sizeof (header));
+    write_bytes (out, header, sizeof (header), "save_mesh_as_stl");
+    const uint32_t count = static_cast <uint32_t> (triangle_count);
+    write_bytes (out, &count, sizeof (count), "save_mesh_as_stl");
+
+    write_chunks (out, executor, concurrency, triangle_count, [&] (size_t first, size_t last, ChunkBuffer& buffer) {
+        buffer.clear ();
+        append_stl_triangles_from (buffer, source, indices.data () + 3 * first, last - first);
+    }, "save_mesh_as_stl");
+
+    printf ("Saved mesh to '%s'.\n", filename.c_str ());
+}
+
+// One vertex attribute of a GLB file, stored in a buffer view of its own.
+struct GlbAttribute {
+  std::string name;       // glTF semantic
+  int component_type = 0; // 5120 byte, 5121 unsigned byte, 5122 short, 5123 unsigned short, 5126 float
+  bool normalized = false;
+  const char* type = "VEC3";
+  size_t stride = 0;      // bytes per vertex, a multiple of 4 as glTF requires
+  std::string bounds;     // POSITION only: its "min" and "max" members
+  std::function <void (size_t, size_t, char*)> store; // writes vertices [first, last) at p
+};
+
+// Exact bounds of get (i) over [0, count): each slot reduces its chunks, the slots are merged afterwards.
+template <typename Get>
+std::pair <LiteMath::float3, LiteMath::float3> reduce_bounds (Executor& executor, unsigned int concurrency, size_t count, const Get& get) {
+    std::vector <LiteMath::float3> slot_min (concurrency, LiteMath::float3 {std::numeric_limits <float>::max ()});
+    std::vector <LiteMath::float3> slot_max (concurrency, LiteMath::float3 {std::numeric_limits <float>::lowest ()});
+    parallel_for (executor, concurrency, count, EXPORT_GRAIN, [&] (size_t first, size_t last, unsigned int slot) {
+        for (size_t i = first; i < last; ++i) {
+            const LiteMath::float3 v = get (i);
+            for (int axis = 0; axis < 3; ++axis) {
+                slot_min [slot] [axis] = std::min (slot_min [slot] [axis], v [axis]);
+                slot_max [slot] [axis] = std::max (slot_max [slot] [axis], v [axis]);
+            }
+        }
+    });
+    for (unsigned int slot = 1; slot < concurrency; ++slot) {
+        for (int axis = 0; axis < 3; ++axis) {
+            slot_min [0] [axis] = std::min (slot_min [0] [axis], slot_min [slot] [axis]);
+            slot_max [0] [axis] = std::max (slot_max [0] [axis], slot_max [slot] [axis]);
+        }
+    }
+    return {slot_min [0], slot_max [0]};
+}
+
+// Numbers are printed round-trip exact, validators compare the bounds with the data.
+std::string json_float3 (const LiteMath::float3& v) {
+    std::string text = "[";
+    for (int axis = 0; axis < 3; ++axis) {
+        char digits [32];
+        text.append (digits, std::to_chars (digits, digits + sizeof (digits), v [axis]).ptr);
+        text += axis < 2 ? "," : "]";
+    }
+    return text;
+}
+
+std::string json_bounds (const std::pair <LiteMath::float3, LiteMath::float3>& bounds) {
+    return ",\"min\":" + json_float3 (bounds.first) + ",\"max\":" + json_float3 (bounds.second);
+}
+
+// Writes a GLB with one indexed triangle mesh: every attribute in its own buffer view, then the uint32 indices.
+// `node` holds extra members of the mesh node (a dequantizing transform), `extensions` the names of the glTF
+// extensions the attributes need.
+void save_glb (const std::vector <GlbAttribute>& attributes
+               , size_t vertex_count
+               , const std::vector <uint32_t>& indices
+               , const std::string& node
+               , const std::vector <std::string>& extensions
+               , const std::string& filename
+               , const MeshExportSettings& settings) {
+    printf ("Saving mesh to '%s'...\n", filename.c_str ());
+    check_triangles (indices, "save_mesh_as_glb");
+
+    Executor& executor = settings.get_executor ();
+    const unsigned int concurrency = static_cast <unsigned int> (std::max (1, settings.max_threads));
+    const bool has_geometry = vertex_count != 0 && !indices.empty ();
+
+    std::string json = "{\"asset\":{\"version\":\"2.0\",\"generator\":\"sdf_raster\"},\"scene\":0";
+    size_t binary_size = 0;
+    if (has_geometry) {
+        std::string extension_list;
+        for (const std::string& extension : extensions) {
+            extension_list += (extension_list.empty () ? "\"" : ",\"") + extension + "\"";
+        }
+        if (!extension_list.empty ()) {
+            json += ",\"extensionsUsed\":[" + extension_list + "],\"extensionsRequired\":[" + extension_list + "]";
+        }
+
+        std::string primitive_attributes;
+        std::string views;
+        std::string accessors;
+        for (size_t a = 0; a < attributes.size (); ++a) {
+            const GlbAttribute& attribute = attributes [a];
+            const size_t bytes = vertex_count * attribute.stride;
+            primitive_attributes += (a == 0 ? "\"" : ",\"") + attribute.name + "\":" + std::to_string (a);
+            views += (a == 0 ? "" : ",") + std::string {"{\"buffer\":0,\"byteOffset\":"} + std::to_string (binary_size)
+                + ",\"byteLength\":" + std::to_string (bytes) + ",\"byteStride\":" + std::to_string (attribute.stride)
+                + ",\"target\":34962}";
+            accessors += (a == 0 ? "" : ",") + std::string {"{\"bufferView\":"} + std::to_string (a)
+                + ",\"componentType\":" + std::to_string (attribute.component_type)
+                + (attribute.normalized ? ",\"normalized\":true" : "")
+                + ",\"count\":" + std::to_string (vertex_count) + ",\"type\":\"" + attribute.type + "\"" + attribute.bounds + "}";
+            binary_size += bytes;
+        }
+        const size_t index_bytes = indices.size () * sizeof (uint32_t);
+        views += ",{\"buffer\":0,\"byteOffset\":" + std::to_string (binary_size) + ",\"byteLength\":"
+            + std::to_string (index_bytes) + ",\"target\":34963}";
+        accessors += ",{\"bufferView\":" + std::to_string (attributes.size ()) + ",\"componentType\":5125,\"count\":"
+            + std::to_string (indices.size ()) + ",\"type\":\"SCALAR\"}";
+        binary_size += index_bytes;
+
+        json += ",\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"mesh\":0" + node + "}]"
+            ",\"meshes\":[{\"primitives\":[{\"attributes\":{" + primitive_attributes + "},\"indices\":"
+                + std::to_string (attributes.size ()) + ",\"mode\":4}]}]"
+            ",\"buffers\":[{\"byteLength\":" + std::to_string (binary_size) + "}]"
+            ",\"bufferViews\":[" + views + "]"
+            ",\"accessors\":[" + accessors + "]";
+    } else {
+        json += ",\"scenes\":[{}]";
+    }
+    json += "}";
+    json.append ((4 - json.size () % 4) % 4, ' ');
+
+    const size_t file_size = 12 + 8 + json.size () + (has_geometry ? 8 + binary_size : 0);
+    if (file_size > std::numeric_limits <uint32_t>::max ()) {
+        throw std::runtime_error {"[save_mesh_as_glb]: mesh exceeds the 4 GiB GLB limit"};
+    }
+
+    std::ofstream out = open_output (filename, "save_mesh_as_glb");
+    const uint32_t header [5] = {
+        0x46546C67u // "glTF"
+        , 2u
+        , static_cast <uint32_t> (file_size)
+        , static_cast <uint32_t> (json.size ())
+        , 0x4E4F534Au // "JSON"
+    };
+    write_bytes (out, header, sizeof (header), "save_mesh_as_glb");
+    write_bytes (out, json.data (), json.size (), "save_mesh_as_glb");
+
+    if (has_geometry) {
+        const uint32_t binary_header [2] = {static_cast <uint32_t> (binary_size), 0x004E4942u}; // "BIN\0"
+        write_bytes (out, binary_header, sizeof (binary_header), "save_mesh_as_glb");
+        for (const GlbAttribute& attribute : attributes) {
+            write_chunks (out, executor, concurrency, vertex_count, [&] (size_t first, size_t last, ChunkBuffer& buffer) {
+                buffer.resize ((last - first) * attribute.stride);
+                attribute.store (first, last, buffer.data ());
+            }, "save_mesh_as_glb");
+        }
+        // Indices are already in their binary layout.
+        write_bytes (out, indices.data (), indices.size () * sizeof (uint32_t), "save_mesh_as_glb");
+    }
+
+    printf ("Saved mesh to '%s'.\n", filename.c_str ());
+}
+
+}
+
+void save_mesh_as_obj (const Mesh& mesh, const std::string& filename, const MeshExportSettings& settings) {
+    save_obj (VertexArraySource {mesh.get_vertices ().data ()}, mesh.get_vertices ().size (), mesh.get_indices (), {}, filename, settings);
+}
+
+void save_mesh_as_ply (const Mesh& mesh, const std::string& filename, const MeshExportSettings& settings) {
+    save_ply (VertexArraySource {mesh.get_vertices ().data ()}, mesh.get_vertices ().size (), mesh.get_indices (), {}, filename, settings);
+}
+
+void save_mesh_as_stl (const Mesh& mesh, const std::string& filename, const MeshExportSettings& settings) {
+    save_stl (VertexArraySource {mesh.get_vertices ().data ()}, mesh.get_indices (), filename, settings);
+}
+
+void save_mesh_as_glb (const Mesh& mesh, const std::string& filename, const MeshExportSettings& settings) {
+    Executor& executor = settings.get_executor ();
+    const unsigned int concurrency = static_cast <unsigned int> (std::max (1, settings.max_threads));
+    const auto& vertices = mesh.get_vertices ();
+
+    GlbAttribute position;
+    position.name = "POSITION";
+    position.component_type = 5126;
+    position.stride = 3 * sizeof (float);
+    position.bounds = json_bounds (reduce_bounds (executor, concurrency, vertices.size (), [&] (size_t i) { return vertices [i].position; }));
+    position.store = [&] (size_t first, size_t last, char* p) {
+        for (size_t i = first; i < last; ++i) {
+            p = store_float3 (p, vertices [i].position);
+        }
+    };
+    GlbAttribute normal;
+    normal.name = "NORMAL";
+    normal.component_type = 5126;
+    normal.stride = 3 * sizeof (float);
+    normal.store = [&] (size_t first, size_t last, char* p) {
+        for (size_t i = first; i < last; ++i) {
+            p = store_float3 (p, vertices [i].normal);
+        }
+    };
+
+    save_glb ({position, normal}, vertices.size (), mesh.get_indices (), "", {}, filename, settings);
+}
+
+void save_mesh_as_obj (const CompactMesh& mesh, const std::string& filename, const MeshExportSettings& settings) {
+    save_obj (CompactMeshSource {&mesh}, mesh.vertex_count (), mesh.get_indices (), {mesh.has_normals (), false}, filename, settings);
+}
+
+void save_mesh_as_ply (const CompactMesh& mesh, const std::string& filename, const MeshExportSettings& settings) {
+    save_ply (CompactMeshSource {&mesh}, mesh.vertex_count (), mesh.get_indices (), {mesh.has_normals (), mesh.has_colors ()}, filename, settings);
+}
+
+void save_mesh_as_stl (const CompactMesh& mesh, const std::string& filename, const MeshExportSettings& settings) {
+    save_stl (CompactMeshSource {&mesh}, mesh.get_indices (), filename, settings);
+}
+
+// Quantized streams go to the file as they are where glTF can take them (KHR_mesh_quantization): positions as
+// unsigned shorts under a node transform that dequantizes them, octahedral normals expanded to normalized
+// bytes or shorts, colors as normalized bytes.
+void save_mesh_as_glb (const CompactMesh& mesh, const std::string& filename, const MeshExportSettings& settings) {
+    Executor& executor = settings.get_executor ();
+    const unsigned int concurrency = static_cast <unsigned int> (std::max (1, settings.max_threads));
+    const CompactMeshLayout& layout = mesh.get_layout ();
+    const uint8_t* positions = mesh.get_positions ().data ();
+    std::vector <GlbAttribute> attributes;
+    std::string node;
+    bool quantized = false;
+
+    GlbAttribute position;
+    position.name = "POSITION";
+    if (layout.positions == MeshPositionEncoding::Unorm16) {
+        // Elements are padded from 6 to 8 bytes, glTF aligns vertex attributes to 4 bytes.
+        position.component_type = 5123;
+        position.stride = 4 * sizeof (uint16_t);
+        position.bounds = json_bounds (reduce_bounds (executor, concurrency, mesh.vertex_count (), [&] (size_t i) {
+            uint16_t q [3];
+            std::memcpy (q, positions + 6 * i, sizeof (q));
+            return LiteMath::float3 {float (q [0]), float (q [1]), float (q [2])};
+        }));
+        position.store = [positions] (size_t first, size_t last, char* p) {
+            for (size_t i = first; i < last; ++i) {
+                std::memcpy (p, positions + 6 * i, 6);
+                p = store (p + 6, uint16_t {0});
+            }
+        };
+        const float step = mesh.get_quantization_step ();
+        node = ",\"translation\":" + json_float3 (mesh.get_quantization_origin ()) + ",\"scale\":" + json_float3 (LiteMath::float3 {step});
+        quantized = true;
+    } else {
+        position.component_type = 5126;
+        position.stride = 3 * sizeof (float);
+        position.bounds = json_bounds (reduce_bounds (executor, concurrency, mesh.vertex_count (), [&] (size_t i) { return mesh.position (i); }));
+        position.store = [positions] (size_t first, size_t last, char* p) {
+            std::memcpy (p, positions + 12 * first, 12 * (last - first));
+        };
+    }
+    attributes.push_back (position);
+
+    if (layout.normals != MeshNormalEncoding::None) {
+        GlbAttribute normal;
+        normal.name = "NORMAL";
+        if (layout.normals == MeshNormalEncoding::Float32) {
+            normal.component_type = 5126;
+            normal.stride = 3 * sizeof (float);
+            normal.store = [&mesh] (size_t first, size_t last, char* p) {
+                std::memcpy (p, mesh.get_normals ().data () + 12 * first, 12 * (last - first));
+            };
+        } else if (layout.normals == MeshNormalEncoding::Octahedral16) {
+            normal.component_type = 5122;
+            normal.normalized = true;
+            normal.stride = 4 * sizeof (int16_t);
+            normal.store = [&mesh] (size_t first, size_t last, char* p) {
+                for (size_t i = first; i < last; ++i) {
+                    const LiteMath::float3 n = mesh.normal (i);
+                    for (int axis = 0; axis < 3; ++axis) {
+                        p = store (p, static_cast <int16_t> (std::lround (std::clamp (n [axis], -1.0f, 1.0f) * 32767.0f)));
+                    }
+                    p = store (p, int16_t {0});
+                }
+            };
+            quantized = true;
+        } else {
+            normal.component_type = 5120;
+            normal.normalized = true;
+            normal.stride = 4 * sizeof (int8_t);
+            normal.store = [&mesh] (size_t first, size_t last, char* p) {
+                for (size_t i = first; i < last; ++i) {
+                    const LiteMath::float3 n = mesh.normal (i);
+                    for (int axis = 0; axis < 3; ++axis) {
+                        p = store (p, static_cast <int8_t> (std::lround (std::clamp (n [axis], -1.0f, 1.0f) * 127.0f)));
+                    }
+                    p = store (p, int8_t {0});
+                }
+            };
+            quantized = true;
+        }
+        attributes.push_back (normal);
+    }
+
+    if (layout.colors) {
+        GlbAttribute color;
+        color.name = "COLOR_0";
+        color.component_type = 5121;
+        color.normalized = true;
+        color.type = "VEC4";
+        color.stride = 4;
+        color.store = [&mesh] (size_t first, size_t last, char* p) {
+            std::memcpy (p, mesh.get_colors ().data () + 4 * first, 4 * (last - first));
+        };
+        attributes.push_back (color);
+    }
+
+    std::vector <std::string> extensions;
+    if (quantized) {
+        extensions.push_back ("KHR_mesh_quantization");
+    }
+    save_glb (attributes, mesh.vertex_count (), mesh.get_indices (), node, extensions, filename, settings);
+}
+
+void append_obj_vectors (std::vector <char>& buffer, const Vertex* vertices, size_t count, bool normals) {
+    append_obj_vectors_from (buffer, VertexArraySource {vertices}, 0, count, normals);
+}
+
+void append_obj_faces (std::vector <char>& buffer, const uint32_t* indices, size_t triangle_count, size_t index_base) {
+    append_obj_faces_with (buffer, indices, triangle_count, index_base, true);
+}
+
+void append_stl_triangles (std::vector <char>& buffer, const Vertex* vertices, const uint32_t* indices, size_t triangle_count) {
+    append_stl_triangles_from (buffer, VertexArraySource {vertices}, indices, triangle_count);
+}
+
+MeshFileFormat mesh_file_format (const std::string& filename) {
+    const size_t dot = filename.find_last_of ('.');
+    std::string extension = dot == std::string::npos ? std::string {} : filename.substr (dot + 1);
+    std::transform (extension.begin (), extension.end (), extension.begin (), [] (unsigned char c) { return static_cast <char> (std::tolower (c)); });
+
+    if (extension == "obj") {
+        return MeshFileFormat::Obj;
+    }
+    if (extension == "ply") {
+        return MeshFileFormat::Ply;
+    }
+    if (extension == "stl") {
+        return MeshFileFormat::Stl;
+    }
+    if (extension == "glb") {
+        return MeshFileFormat::Glb;
+    }
+    throw std::runtime_error {"[mesh_file_format]: unsupported mesh file extension: " + filename};
+}
+
+void save_mesh (const Mesh& mesh, const std::string& filename, const MeshExportSettings& settings) {
+    switch (mesh_file_format (filename)) {
+        case MeshFileFormat::Obj:
+            save_mesh_as_obj (mesh, filename, settings);
+            break;
+        case MeshFileFormat::Ply:
+            save_mesh_as_ply (mesh, filename, settings);
+            break;
+        case MeshFileFormat::Stl:
+            save_mesh_as_stl (mesh, filename, settings);
+            break;
+        case MeshFileFormat::Glb:
+            save_mesh_as_glb (mesh, filename, settings);
+            break;
+    }
+}
+
+void save_mesh (const CompactMesh& mesh, const std::string& filename, const MeshExportSettings& settings) {
+    switch (mesh_file_format (filename)) {
+        case MeshFileFormat::Obj:
+            save_mesh_as_obj (mesh, filename, settings);
+            break;
+        case MeshFileFormat::Ply:
+            save_mesh_as_ply (mesh, filename, settings);
+            break;
+        case MeshFileFormat::Stl:
+            save_mesh_as_stl (mesh, filename, settings);
+            break;
+        case MeshFileFormat::Glb:
+            save_mesh_as_glb (mesh, filename, settings);
+            break;
+    }
+}
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "compact_mesh.hpp"
+#include "executor.hpp"
+#include "mesh.hpp"
+
+namespace sdf_raster {
+
+enum class MeshFileFormat {
+    Obj, // text: positions, normals, faces
+    Ply, // binary little endian: positions and normals, triangle lists
+    Stl, // binary: triangles with face normals, no shared vertices
+    Glb, // binary glTF 2.0: one indexed mesh, one buffer view per vertex attribute
+};
+
+struct MeshExportSettings : ParallelSettings {};
+
+// Writers format the mesh in chunks on the executor and write them in order while the next chunks are being
+// formatted, so export is limited by the disk rather than by number formatting. The calling thread does the writing
+// and counts towards max_threads. Files are written in binary mode.
+void save_mesh_as_obj (const Mesh& mesh, const std::string& filename, const MeshExportSettings& settings = {});
+void save_mesh_as_ply (const Mesh& mesh, const std::string& filename, const MeshExportSettings& settings = {});
+void save_mesh_as_stl (const Mesh& mesh, const std::string& filename, const MeshExportSettings& settings = {});
+void save_mesh_as_glb (const Mesh& mesh, const std::string& filename, const MeshExportSettings& settings = {});
+
+// The same formats read straight from the compact streams. Attributes the layout leaves out are left out of the file
+// (OBJ faces lose their normal ids); GLB keeps quantized data quantized through KHR_mesh_quantization.
+void save_mesh_as_obj (const CompactMesh& mesh, const std::string& filename, const MeshExportSettings& settings = {});
+void save_mesh_as_ply (const CompactMesh& mesh, const std::string& filename, const MeshExportSettings& settings = {});
+void save_mesh_as_stl (const CompactMesh& mesh, const std::string& filename, const MeshExportSettings& settings = {});
+void save_mesh_as_glb (const CompactMesh& mesh, const std::string& filename, const MeshExportSettings& settings = {});
+
+// Encoders shared by the writers above and the streaming sinks; they append to `buffer`. OBJ faces refer to vertex
+// ids 1 + index_base + index, STL triangles carry their face normal.
+void append_obj_vectors (std::vector <char>& buffer, const Vertex* vertices, size_t count, bool normals);
+void append_obj_faces (std::vector <char>& buffer, const uint32_t* indices, size_t triangle_count, size_t index_base);
+void append_stl_triangles (std::vector <char>& buffer, const Vertex* vertices, const uint32_t* indices, size_t triangle_count);
+
+// Format from the file extension (.obj, .ply, .stl, .glb, any case); throws for anything else.
+MeshFileFormat mesh_file_format (const std::string& filename);
+void save_mesh (const Mesh& mesh, const std::string& filename, const MeshExportSettings& settings = {});
+void save_mesh (const CompactMesh& mesh, const std::string& filename, const MeshExportSettings& settings = {});
+
+}
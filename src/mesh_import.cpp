@@ -0,0 +1,174 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "mesh_export.hpp"
+#include "mesh_import.hpp"
+
+namespace sdf_raster {
+
+namespace {
+
+constexpr size_t STL_HEADER_SIZE = 80;
+constexpr size_t STL_TRIANGLE_SIZE = 50; // normal, three corners, attribute byte count
+
+// Whole file, with a terminating zero so the text parsers can run strtof and strtol on it.
+std::vector <char> read_file (const std::string& filename, const char* function) {
+    std::ifstream file (filename, std::ios::binary | std::ios::ate);
+    if (!file) {
+        throw std::runtime_error {std::string {"["} + function + "]: cannot open " + filename};
+    }
+    const std::streamsize size = file.tellg ();
+    std::vector <char> data (static_cast <size_t> (size) + 1, '\0');
+    file.seekg (0);
+    if (!file.read (data.data (), size)) {
+        throw std::runtime_error {std::string {"["} + function + "]: cannot read " + filename};
+    }
+    return data;
+}
+
+const char* skip_blanks (const char* p) {
+    while (*p == ' ' || *p == '\t' || *p == '\r') {
+        ++p;
+    }
+    return p;
+}
+
+const char* next_line (const char* p) {
+    while (*p != '\0' && *p != '\n') {
+        ++p;
+    }
+    return *p == '\n' ? p + 1 : p;
+}
+
+Vertex make_vertex (float x, float y, float z) {
+    Vertex vertex {};
+    vertex.position = {x, y, z};
+    return vertex;
+}
+
+}
+
+Mesh load_mesh_from_obj (const std::string& filename) {
+    const std::vector <char> data = read_file (filename, "load_mesh_from_obj");
+    std::vector <Vertex> vertices;
+    std::vector <uint32_t> indices;
+    std::vector <uint32_t> face;
+
+    size_t line = 1;
+    for (const char* p = data.data (); *p != '\0'; p = next_line (p), ++line) {
+        p = skip_blanks (p);
+        if (p [0] == 'v' && (p [1] == ' ' || p [1] == '\t')) {
+            char* end = nullptr;
+            float xyz [3];
+            p += 2;
+            for (float& value : xyz) {
+                value = std::strtof (p, &end);
+                if (end == p) {
+                    throw std::runtime_error {"[load_mesh_from_obj]: bad vertex on line " + std::to_string (line)};
+                }
+                p = end;
+            }
+            vertices.push_back (make_vertex (xyz [0], xyz [1], xyz [2]));
+        } else if (p [0] == 'f' && (p [1] == ' ' || p [1] == '\t')) {
+            face.clear ();
+            p = skip_blanks (p + 2);
+            while (*p != '\0' && *p != '\n' && *p != '#') {
+                char* end = nullptr;
+                const long id = std::strtol (p, &end, 10);
+                const long vertex = id < 0 ? static_cast <long> (vertices.size ()) + id : id - 1;
+                if (end == p || id == 0 || vertex < 0 || vertex >= static_cast <long> (vertices.size ())) {
+                    throw std::runtime_error {"[load_mesh_from_obj]: bad face on line " + std::to_string (line)};
+                }
+                face.push_back (static_cast <uint32_t> (vertex));
+                // Texture coordinate and normal ids after slashes are not needed.
+                for (p = end; *p != '\0' && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n'; ++p) {
+                }
+                p = skip_blanks (p);
+            }
+            for (size_t corner = 2; corner < face.size (); ++corner) {
+                indices.push_back (face [0]);
+                indices.push_back (face [corner - 1]);
+                indices.push_back (face [corner]);
+            }
+        }
+        if (vertices.size () >= std::numeric_limits <uint32_t>::max ()) {
+            throw std::runtime_error {"[load_mesh_from_obj]: too many vertices"};
+        }
+    }
+
+    return Mesh (std::move (indices), std::move (vertices));
+}
+
+Mesh load_mesh_from_stl (const std::string& filename) {
+    const std::vector <char> data = read_file (filename, "load_mesh_from_stl");
+    const size_t size = data.size () - 1;
+    std::vector <Vertex> vertices;
+
+    // Binary files are told apart by their size: ASCII ones start with "solid" too, and some binary ones do as well.
+    uint32_t triangle_count = 0;
+    if (size >= STL_HEADER_SIZE + 4) {
+        std::memcpy (&triangle_count, data.data () + STL_HEADER_SIZE, 4);
+    }
+    if (size >= STL_HEADER_SIZE + 4 && size == STL_HEADER_SIZE + 4 + STL_TRIANGLE_SIZE * size_t {triangle_count}) {
+        vertices.resize (3 * size_t {triangle_count});
+        const char* p = data.data () + STL_HEADER_SIZE + 4;
+        for (size_t t = 0; t < triangle_count; ++t, p += STL_TRIANGLE_SIZE) {
+            for (int corner = 0; corner < 3; ++corner) {
+                float xyz [3];
+                std::memcpy (xyz, p + 12 * (corner + 1), 12);
+                vertices [3 * t + corner] = make_vertex (xyz [0], xyz [1], xyz [2]);
+            }
+        }
+    } else {
+        if (std::strncmp (data.data (), "solid", 5) != 0) {
+            throw std::runtime_error {"[load_mesh_from_stl]: neither binary nor ASCII STL: " + filename};
+        }
+        size_t line = 1;
+        for (const char* p = data.data (); *p != '\0'; p = next_line (p), ++line) {
+            p = skip_blanks (p);
+            if (std::strncmp (p, "vertex", 6) != 0) {
+                continue;
+            }
+            char* end = nullptr;
+            float xyz [3];
+            p += 6;
+            for (float& value : xyz) {
+                value = std::strtof (p, &end);
+                if (end == p) {
+                    throw std::runtime_error {"[load_mesh_from_stl]: bad vertex on line " + std::to_string (line)};
+                }
+                p = end;
+            }
+            vertices.push_back (make_vertex (xyz [0], xyz [1], xyz [2]));
+        }
+        if (vertices.size () % 3 != 0) {
+            throw std::runtime_error {"[load_mesh_from_stl]: facet without three vertices in " + filename};
+        }
+    }
+    if (vertices.size () >= std::numeric_limits <uint32_t>::max ()) {
+        throw std::runtime_error {"[load_mesh_from_stl]: too many vertices"};
+    }
+
+    std::vector <uint32_t> indices (vertices.size ());
+    for (size_t i = 0; i < indices.size (); ++i) {
+        indices [i] = static_cast <uint32_t> (i);
+    }
+    return Mesh (std::move (indices), std::move (vertices));
+}
+
+Mesh load_mesh (const std::string& filename) {
+    switch (mesh_file_format (filename)) {
+        case MeshFileFormat::Obj:
+            return load_mesh_from_obj (filename);
+        case MeshFileFormat::Stl:
+            return load_mesh_from_stl (filename);
+        default:
+            throw std::runtime_error {"[load_mesh]: only OBJ and STL files can be read: " + filename};
+    }
+}
+
+}
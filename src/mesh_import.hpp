@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+
+#include "mesh.hpp"
+
+namespace sdf_raster {
+
+// Positions and triangles only: normals, colors and texture coordinates in the file are skipped and vertices get
+// zero normals and colors.
+//
+// OBJ faces of more than three vertices are split into fans; negative (relative) ids are resolved. STL, binary or
+// ASCII, is a triangle soup: every triangle gets three vertices of its own (see weld_mesh).
+Mesh load_mesh_from_obj (const std::string& filename);
+Mesh load_mesh_from_stl (const std::string& filename);
+
+// Format from the file extension (see mesh_file_format); throws for PLY and GLB, which are only written.
+Mesh load_mesh (const std::string& filename);
+
+}
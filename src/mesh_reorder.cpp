@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "mesh_chunks.hpp"
+#include "mesh_reorder.hpp"
+
+namespace sdf_raster {
+
+namespace {
+
+// Triangles per chunk ordered as one task: the cache only looks a few triangles ahead, so the chunk borders cost
+// next to nothing.
+constexpr size_t CHUNK_TRIANGLES = 1 << 16;
+constexpr size_t RANGE_GRAIN = 1 << 16;
+constexpr uint32_t NONE = ~0u;
+
+// State of the chunk being ordered, on top of its triangles and vertices.
+struct ChunkScratch : TriangleChunk {
+  std::vector <uint32_t> live;        // triangles around the vertex not emitted yet
+  std::vector <uint32_t> cache_time;  // timestamp the vertex last entered the cache
+  std::vector <uint8_t> emitted;
+  std::vector <uint32_t> dead_ends;   // corners of emitted triangles, most recent last
+  std::vector <uint32_t> fan;         // corners of the last fan
+};
+
+// Tipsify over `count` triangles from `triangles` on, written to `out` as mesh vertex ids.
+void tipsify_chunk (const Mesh& mesh, const uint32_t* triangles, size_t count, uint32_t cache_size, ChunkScratch& scratch, uint32_t* out) {
+    scratch.load (mesh, triangles, count);
+    const uint32_t vertex_count = static_cast <uint32_t> (scratch.vertex_count ());
+    scratch.live.resize (vertex_count);
+    for (uint32_t v = 0; v < vertex_count; ++v) {
+        scratch.live [v] = scratch.degree (v);
+    }
+    scratch.cache_time.assign (vertex_count, 0);
+    scratch.emitted.assign (count, 0);
+    scratch.dead_ends.clear ();
+
+    // A vertex is in the cache while timestamp - cache_time <= cache_size; starting past cache_size, nothing is.
+    uint32_t timestamp = cache_size + 1;
+    uint32_t cursor = 1;
+    uint32_t fanning = 0;
+    while (fanning != NONE) {
+        scratch.fan.clear ();
+        for (uint32_t j = scratch.adjacency_offsets [fanning]; j < scratch.adjacency_offsets [fanning + 1]; ++j) {
+            const uint32_t t = scratch.adjacency [j];
+            if (scratch.emitted [t]) {
+                continue;
+            }
+            scratch.emitted [t] = 1;
+            for (int corner = 0; corner < 3; ++corner) {
+                const uint32_t v = scratch.corners [3 * size_t {t} + corner];
+                *out++ = scratch.vertices [v];
+                scratch.dead_ends.push_back (v);
+                scratch.fan.push_back (v);
+                --scratch.live [v];
+                if (timestamp - scratch.cache_time [v] > cache_size) {
+                    scratch.cache_time [v] = timestamp++;
+                }
+            }
+        }
+
+        // The fan corner with live triangles that stays in the cache longest after fanning it out, or any fan corner
+        // with live triangles when none would stay.
+        fanning = NONE;
+        uint32_t best = 0;
+        for (const uint32_t v : scratch.fan) {
+            if (scratch.live [v] == 0) {
+                continue;
+            }
+            uint32_t priority = 0;
+            if (timestamp - scratch.cache_time [v] + 2 * scratch.live [v] <= cache_size) {
+                priority = timestamp - scratch.cache_time [v];
+            }
+            if (fanning == NONE || priority > best) {
+                fanning = v;
+                best = priority;
+            }
+        }
+        if (fanning != NONE) {
+            continue;
+        }
+
+        // Dead end: back up to the most recent corner with live triangles, then to the first one in chunk order.
+        while (!scratch.dead_ends.empty () && fanning == NONE) {
+            const uint32_t v = scratch.dead_ends.back ();
+            scratch.dead_ends.pop_back ();
+            if (scratch.live [v] > 0) {
+                fanning = v;
+            }
+        }
+        while (fanning == NONE && cursor < vertex_count) {
+            if (scratch.live [cursor] > 0) {
+                fanning = cursor;
+            }
+            ++cursor;
+        }
+    }
+}
+
+}
+
+VertexCacheStats analyze_vertex_cache (const Mesh& mesh, uint32_t cache_size) {
+    const std::vector <uint32_t>& indices = mesh.get_indices ();
+    VertexCacheStats stats;
+    if (indices.empty ()) {
+        return stats;
+    }
+
+    std::vector <uint32_t> cache_time (mesh.get_vertices ().size (), 0);
+    uint32_t timestamp = cache_size + 1;
+    size_t misses = 0;
+    size_t referenced = 0;
+    for (const uint32_t v : indices) {
+        referenced += cache_time [v] == 0;
+        if (timestamp - cache_time [v] > cache_size) {
+            cache_time [v] = timestamp++;
+            ++misses;
+        }
+    }
+    stats.acmr = float (double (misses) / double (indices.size () / 3));
+    stats.atvr = float (double (misses) / double (referenced));
+    return stats;
+}
+
+MeshReorderStats reorder_mesh (Mesh& mesh, const MeshReorderSettings& settings) {
+    if (settings.cache_size == 0) {
+        throw std::runtime_error {"[reorder_mesh]: cache_size must be positive"};
+    }
+    Executor& executor = settings.get_executor ();
+    const unsigned int concurrency = static_cast <unsigned int> (std::max (1, settings.max_threads));
+
+    MeshReorderStats stats;
+    stats.before = analyze_vertex_cache (mesh, settings.cache_size);
+    const size_t triangle_count = mesh.get_indices ().size () / 3;
+    if (triangle_count == 0) {
+        stats.after = stats.before;
+        return stats;
+    }
+
+    // Triangles, chunk by chunk along the curve.
+    const std::vector <uint32_t> order = morton_triangle_order (mesh, executor, concurrency);
+    std::vector <uint32_t> indices (3 * triangle_count);
+    const size_t chunk_count = (triangle_count + CHUNK_TRIANGLES - 1) / CHUNK_TRIANGLES;
+    std::vector <ChunkScratch> scratch (concurrency);
+    parallel_for (executor, concurrency, chunk_count, 1, [&] (size_t first, size_t last, unsigned int slot) {
+        for (size_t chunk = first; chunk < last; ++chunk) {
+            const size_t begin = chunk * CHUNK_TRIANGLES;
+            const size_t end = std::min (begin + CHUNK_TRIANGLES, triangle_count);
+            tipsify_chunk (mesh, order.data () + begin, end - begin, settings.cache_size, scratch [slot], indices.data () + 3 * begin);
+        }
+    });
+    scratch.clear ();
+
+    // Vertices, by first use.
+    const std::vector <Vertex>& vertices = mesh.get_vertices ();
+    std::vector <uint32_t> remap (vertices.size (), NONE);
+    std::vector <uint32_t> sources;
+    sources.reserve (vertices.size ());
+    for (const uint32_t v : indices) {
+        if (remap [v] == NONE) {
+            remap [v] = static_cast <uint32_t> (sources.size ());
+            sources.push_back (v);
+        }
+    }
+    for (uint32_t v = 0; v < vertices.size (); ++v) {
+        if (remap [v] == NONE) {
+            remap [v] = static_cast <uint32_t> (sources.size ());
+            sources.push_back (v);
+        }
+    }
+
+    std::vector <Vertex> reordered (vertices.size ());
+    parallel_for (executor, concurrency, reordered.size (), RANGE_GRAIN, [&] (size_t first, size_t last, unsigned int) {
+        for (size_t i = first; i < last; ++i) {
+            reordered [i] = vertices [sources [i]];
+        }
+    });
+    parallel_for (executor, concurrency, indices.size (), RANGE_GRAIN, [&] (size_t first, size_t last, unsigned int) {
+        for (size_t i = first; i < last; ++i) {
+            indices [i] = remap [indices [i]];
+        }
+    });
+    mesh.set_data (std::move (reordered), std::move (indices));
+
+    stats.after = analyze_vertex_cache (mesh, settings.cache_size);
+    return stats;
+}
+
+}
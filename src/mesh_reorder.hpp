@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+#include "executor.hpp"
+#include "mesh.hpp"
+
+namespace sdf_raster {
+
+struct MeshReorderSettings : ParallelSettings {
+  uint32_t cache_size = 16;     // entries of the FIFO post-transform cache triangles are ordered for
+};
+
+struct VertexCacheStats {
+  float acmr = 0.0f;            // cache misses per triangle: 0.5 is the limit for a large regular grid, 3 no reuse at all
+  float atvr = 0.0f;            // cache misses per referenced vertex: 1 is ideal
+};
+
+struct MeshReorderStats {
+  VertexCacheStats before;
+  VertexCacheStats after;
+};
+
+// Runs the indices of `mesh` through a FIFO cache of `cache_size` entries.
+VertexCacheStats analyze_vertex_cache (const Mesh& mesh, uint32_t cache_size = 16);
+
+// Reorders the triangles of `mesh` for the post-transform vertex cache, then renumbers its vertices in the order the
+// triangles first use them, so vertex fetches run through memory front to back. Triangles keep their winding and the
+// surface is unchanged; vertices no triangle uses go last, in their old order.
+//
+// Triangles are sorted along a Morton curve of their centroids and cut into chunks of 64K that are ordered in parallel
+// with Tipsify (Sander, Nehab and Barczak 2007): fan out every live triangle around a vertex, then move on to the
+// vertex of the last fan that is still in the cache and has the most time left in it, falling back to the most recent
+// vertex with live triangles. Chunks only depend on the mesh, so the result is the same for any max_threads.
+MeshReorderStats reorder_mesh (Mesh& mesh, const MeshReorderSettings& settings = {});
+
+}
@@ -0,0 +1,582 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "mesh_sdf.hpp"
+#include "mesh_weld.hpp"
+
+namespace sdf_raster {
+
+namespace {
+
+constexpr size_t RANGE_GRAIN = 1 << 14;
+constexpr uint32_t MAX_LEAF_TRIANGLES = 4;
+constexpr int SAH_BINS = 16;
+// Ranges up to this many triangles are built as one task; larger ones are split serially first.
+constexpr size_t SUBTREE_TRIANGLES = 1 << 16;
+// Past this depth ranges are halved instead, so no tree is deeper than it plus 32 levels.
+constexpr uint32_t MAX_SAH_DEPTH = 64;
+constexpr int STACK_SIZE = 128;
+constexpr uint32_t NONE = ~0u;
+constexpr float INFINITE_DISTANCE = std::numeric_limits <float>::infinity ();
+
+enum Feature : int {
+    FACE,
+    VERTEX_A,
+    VERTEX_B,
+    VERTEX_C,
+    EDGE_AB,
+    EDGE_BC,
+    EDGE_CA,
+};
+
+inline float dot3 (const float* a, const float* b) {
+    return a [0] * b [0] + a [1] * b [1] + a [2] * b [2];
+}
+
+inline void sub3 (const float* a, const float* b, float* out) {
+    out [0] = a [0] - b [0];
+    out [1] = a [1] - b [1];
+    out [2] = a [2] - b [2];
+}
+
+inline void madd3 (const float* a, const float* b, float t, float* out) {
+    out [0] = a [0] + b [0] * t;
+    out [1] = a [1] + b [1] * t;
+    out [2] = a [2] + b [2] * t;
+}
+
+// Closest point to p on triangle abc and the feature it lies on (Ericson, Real-Time Collision Detection, 5.1.5).
+Feature closest_point_on_triangle (const float* p, const float* a, const float* b, const float* c, float* closest) {
+    float ab [3], ac [3], ap [3];
+    sub3 (b, a, ab);
+    sub3 (c, a, ac);
+    sub3 (p, a, ap);
+    const float d1 = dot3 (ab, ap);
+    const float d2 = dot3 (ac, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f) {
+        std::copy (a, a + 3, closest);
+        return VERTEX_A;
+    }
+
+    float bp [3];
+    sub3 (p, b, bp);
+    const float d3 = dot3 (ab, bp);
+    const float d4 = dot3 (ac, bp);
+    if (d3 >= 0.0f && d4 <= d3) {
+        std::copy (b, b + 3, closest);
+        return VERTEX_B;
+    }
+
+    const float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+        madd3 (a, ab, d1 / (d1 - d3), closest);
+        return EDGE_AB;
+    }
+
+    float cp [3];
+    sub3 (p, c, cp);
+    const float d5 = dot3 (ab, cp);
+    const float d6 = dot3 (ac, cp);
+    if (d6 >= 0.0f && d5 <= d6) {
+        std::copy (c, c + 3, closest);
+        return VERTEX_C;
+    }
+
+    const float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+        madd3 (a, ac, d2 / (d2 - d6), closest);
+        return EDGE_CA;
+    }
+
+    const float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f) {
+        float bc [3];
+        sub3 (c, b, bc);
+        madd3 (b, bc, (d4 - d3) / ((d4 - d3) + (d5 - d6)), closest);
+        return EDGE_BC;
+    }
+
+    const float denominator = 1.0f / (va + vb + vc);
+    float on_ab [3];
+    madd3 (a, ab, vb * denominator, on_ab);
+    madd3 (on_ab, ac, vc * denominator, closest);
+    return FACE;
+}
+
+inline float distance_squared (const float* p, const float* q) {
+    float d [3];
+    sub3 (p, q, d);
+    return dot3 (d, d);
+}
+
+inline float box_distance_squared (const float* p, const float* bounds_min, const float* bounds_max) {
+    const float x = std::max (std::max (bounds_min [0] - p [0], p [0] - bounds_max [0]), 0.0f);
+    const float y = std::max (std::max (bounds_min [1] - p [1], p [1] - bounds_max [1]), 0.0f);
+    const float z = std::max (std::max (bounds_min [2] - p [2], p [2] - bounds_max [2]), 0.0f);
+    return x * x + y * y + z * z;
+}
+
+struct Bounds {
+  float min [3] = {INFINITE_DISTANCE, INFINITE_DISTANCE, INFINITE_DISTANCE};
+  float max [3] = {-INFINITE_DISTANCE, -INFINITE_DISTANCE, -INFINITE_DISTANCE};
+
+  void grow (const float* p) {
+      for (int axis = 0; axis < 3; ++axis) {
+          this->min [axis] = std::min (this->min [axis], p [axis]);
+          this->max [axis] = std::max (this->max [axis], p [axis]);
+      }
+  }
+
+  void grow (const Bounds& other) {
+      this->grow (other.min);
+      this->grow (other.max);
+  }
+
+  float half_area () const {
+      const float x = this->max [0] - this->min [0], y = this->max [1] - this->min [1], z = this->max [2] - this->min [2];
+      return x * y + y * z + z * x;
+  }
+};
+
+// Binned SAH over the triangles `ids` [first, last) refer to; children of a node are allocated next to each other.
+template <typename Node>
+class BvhBuilder {
+public:
+  BvhBuilder (const std::vector <Bounds>& bounds, const std::vector <float>& centroids, std::vector <uint32_t>& ids)
+      : bounds (bounds)
+      , centroids (centroids)
+      , ids (ids) {}
+
+  // Makes nodes [node] a leaf or splits its range into two new nodes, returning the split position or NONE.
+  uint32_t split (std::vector <Node>& nodes, uint32_t node, uint32_t first, uint32_t last, uint32_t depth) const {
+      Bounds node_bounds, centroid_bounds;
+      for (uint32_t i = first; i < last; ++i) {
+          node_bounds.grow (this->bounds [this->ids [i]]);
+          centroid_bounds.grow (&this->centroids [3 * size_t {this->ids [i]}]);
+      }
+      std::copy (node_bounds.min, node_bounds.min + 3, nodes [node].bounds_min);
+      std::copy (node_bounds.max, node_bounds.max + 3, nodes [node].bounds_max);
+
+      const uint32_t count = last - first;
+      int axis = 0;
+      for (int a = 1; a < 3; ++a) {
+          if (centroid_bounds.max [a] - centroid_bounds.min [a] > centroid_bounds.max [axis] - centroid_bounds.min [axis]) {
+              axis = a;
+          }
+      }
+      const float extent = centroid_bounds.max [axis] - centroid_bounds.min [axis];
+
+      uint32_t middle = NONE;
+      if (count <= 1) {
+          middle = NONE;
+      } else if (!(extent > 0.0f) || depth >= MAX_SAH_DEPTH) {
+          // Every centroid in one spot, no plane separates them, or too deep: halve the range if it is too big for a leaf.
+          middle = count > MAX_LEAF_TRIANGLES ? first + count / 2 : NONE;
+      } else {
+          Bounds bins [SAH_BINS];
+          uint32_t bin_counts [SAH_BINS] = {};
+          const float scale = SAH_BINS / extent;
+          const auto bin_of = [&] (uint32_t id) {
+              return std::min (SAH_BINS - 1, static_cast <int> ((this->centroids [3 * size_t {id} + axis] - centroid_bounds.min [axis]) * scale));
+          };
+          for (uint32_t i = first; i < last; ++i) {
+              const int bin = bin_of (this->ids [i]);
+              bins [bin].grow (this->bounds [this->ids [i]]);
+              ++bin_counts [bin];
+          }
+
+          // Cost of splitting after bin k: half areas times triangle counts of both sides.
+          float right_costs [SAH_BINS] = {};
+          Bounds right;
+          uint32_t right_count = 0;
+          for (int k = SAH_BINS - 1; k > 0; --k) {
+              right.grow (bins [k]);
+              right_count += bin_counts [k];
+              right_costs [k - 1] = right_count > 0 ? right.half_area () * right_count : 0.0f;
+          }
+          Bounds left;
+          uint32_t left_count = 0;
+          float best_cost = INFINITE_DISTANCE;
+          int best_bin = -1;
+          for (int k = 0; k < SAH_BINS - 1; ++k) {
+              left.grow (bins [k]);
+              left_count += bin_counts [k];
+              if (left_count == 0 || left_count == count) {
+                  continue;
+              }
+              const float cost = left.half_area () * left_count + right_costs [k];
+              if (cost < best_cost) {
+                  best_cost = cost;
+                  best_bin = k;
+              }
+          }
+
+          const bool worth_it = best_bin >= 0 && best_cost < node_bounds.half_area () * count;
+          if (best_bin >= 0 && (count > MAX_LEAF_TRIANGLES || worth_it)) {
+              const auto pivot = std::partition (this->ids.begin () + first, this->ids.begin () + last, [&] (uint32_t id) {
+                  return bin_of (id) <= best_bin;
+              });
+              middle = static_cast <uint32_t> (pivot - this->ids.begin ());
+          } else if (count > MAX_LEAF_TRIANGLES) {
+              middle = first + count / 2;
+          }
+      }
+
+      if (middle == NONE) {
+          nodes [node].first = first;
+          nodes [node].count = count;
+          return NONE;
+      }
+      const uint32_t children = static_cast <uint32_t> (nodes.size ());
+      nodes [node].first = children;
+      nodes [node].count = 0;
+      nodes.resize (children + 2);
+      return middle;
+  }
+
+  void build (std::vector <Node>& nodes, uint32_t node, uint32_t first, uint32_t last, uint32_t depth) const {
+      const uint32_t middle = this->split (nodes, node, first, last, depth);
+      if (middle == NONE) {
+          return;
+      }
+      const uint32_t children = nodes [node].first;
+      this->build (nodes, children, first, middle, depth + 1);
+      this->build (nodes, children + 1, middle, last, depth + 1);
+  }
+
+private:
+  const std::vector <Bounds>& bounds;
+  const std::vector <float>& centroids;
+  std::vector <uint32_t>& ids;
+};
+
+}
+
+MeshDistanceField::MeshDistanceField (const Mesh& mesh, const MeshDistanceSettings& settings) {
+    Executor& executor = settings.get_executor ();
+    const unsigned int concurrency = static_cast <unsigned int> (std::max (1, settings.max_threads));
+    const std::vector <Vertex>& vertices = mesh.get_vertices ();
+    const std::vector <uint32_t>& indices = mesh.get_indices ();
+    const size_t mesh_triangles = indices.size () / 3;
+
+    // Face normals; zero for degenerate triangles, which are dropped.
+    std::vector <float> face_normals (3 * mesh_triangles);
+    parallel_for (executor, concurrency, mesh_triangles, RANGE_GRAIN, [&] (size_t first, size_t last, unsigned int) {
+        for (size_t t = first; t < last; ++t) {
+            const LiteMath::float3& a = vertices [indices [3 * t]].position;
+            const LiteMath::float3 n = LiteMath::cross (vertices [indices [3 * t + 1]].position - a, vertices [indices [3 * t + 2]].position - a);
+            const float length = LiteMath::length (n);
+            const float inverse = length > 0.0f && std::isfinite (length) ? 1.0f / length : 0.0f;
+            face_normals [3 * t] = n.x * inverse;
+            face_normals [3 * t + 1] = n.y * inverse;
+            face_normals [3 * t + 2] = n.z * inverse;
+        }
+    });
+    std::vector <uint32_t> ids;
+    for (uint32_t t = 0; t < mesh_triangles; ++t) {
+        if (dot3 (&face_normals [3 * size_t {t}], &face_normals [3 * size_t {t}]) > 0.0f) {
+            ids.push_back (t);
+        }
+    }
+    if (ids.empty ()) {
+        throw std::runtime_error {"[MeshDistanceField]: mesh has no triangles with an area"};
+    }
+
+    // Kept triangles around every vertex, in the order of `ids`.
+    std::vector <uint32_t> vertex_offsets (vertices.size () + 1, 0);
+    for (const uint32_t t : ids) {
+        for (int corner = 0; corner < 3; ++corner) {
+            ++vertex_offsets [indices [3 * size_t {t} + corner] + 1];
+        }
+    }
+    for (size_t v = 0; v < vertices.size (); ++v) {
+        vertex_offsets [v + 1] += vertex_offsets [v];
+    }
+    std::vector <uint32_t> vertex_triangles (vertex_offsets.back ());
+    {
+        std::vector <uint32_t> cursors (vertex_offsets.begin (), vertex_offsets.end () - 1);
+        for (uint32_t i = 0; i < ids.size (); ++i) {
+            for (int corner = 0; corner < 3; ++corner) {
+                vertex_triangles [cursors [indices [3 * size_t {ids [i]} + corner]]++] = i;
+            }
+        }
+    }
+    const auto has_vertex = [&] (uint32_t i, uint32_t v) {
+        const size_t t = ids [i];
+        return indices [3 * t] == v || indices [3 * t + 1] == v || indices [3 * t + 2] == v;
+    };
+
+    // Vertex pseudonormals: face normals weighted by the angle of the face at the vertex.
+    std::vector <float> vertex_normals (3 * vertices.size (), 0.0f);
+    parallel_for (executor, concurrency, vertices.size (), RANGE_GRAIN, [&] (size_t first, size_t last, unsigned int) {
+        for (size_t v = first; v < last; ++v) {
+            for (uint32_t k = vertex_offsets [v]; k < vertex_offsets [v + 1]; ++k) {
+                const size_t t = ids [vertex_triangles [k]];
+                const int corner = indices [3 * t] == v ? 0 : indices [3 * t + 1] == v ? 1 : 2;
+                const LiteMath::float3& p = vertices [v].position;
+                const LiteMath::float3 e1 = LiteMath::normalize (vertices [indices [3 * t + (corner + 1) % 3]].position - p);
+                const LiteMath::float3 e2 = LiteMath::normalize (vertices [indices [3 * t + (corner + 2) % 3]].position - p);
+                const float angle = std::acos (std::clamp (LiteMath::dot (e1, e2), -1.0f, 1.0f));
+                for (int axis = 0; axis < 3; ++axis) {
+                    vertex_normals [3 * v + axis] += angle * face_normals [3 * t + axis];
+                }
+            }
+        }
+    });
+
+    // Edge pseudonormals: the sum of the normals of the faces on the edge, the triangles around its first vertex
+    // that have the second one too.
+    std::vector <float> edge_normals (9 * ids.size (), 0.0f);
+    parallel_for (executor, concurrency, ids.size (), RANGE_GRAIN, [&] (size_t first, size_t last, unsigned int) {
+        for (size_t i = first; i < last; ++i) {
+            for (int corner = 0; corner < 3; ++corner) {
+                const uint32_t a = indices [3 * size_t {ids [i]} + corner];
+                const uint32_t b = indices [3 * size_t {ids [i]} + (corner + 1) % 3];
+                float* sum = &edge_normals [9 * i + 3 * corner];
+                for (uint32_t k = vertex_offsets [a]; k < vertex_offsets [a + 1]; ++k) {
+                    if (has_vertex (vertex_triangles [k], b)) {
+                        const float* n = &face_normals [3 * size_t {ids [vertex_triangles [k]]}];
+                        for (int axis = 0; axis < 3; ++axis) {
+                            sum [axis] += n [axis];
+                        }
+                    }
+                }
+            }
+        }
+    });
+    std::vector <uint32_t> ().swap (vertex_offsets);
+    std::vector <uint32_t> ().swap (vertex_triangles);
+
+    // BVH over the kept triangles, `order` holding positions into `ids`.
+    const uint32_t triangle_count = static_cast <uint32_t> (ids.size ());
+    std::vector <Bounds> bounds (triangle_count);
+    std::vector <float> centroids (3 * size_t {triangle_count});
+    parallel_for (executor, concurrency, triangle_count, RANGE_GRAIN, [&] (size_t first, size_t last, unsigned int) {
+        for (size_t i = first; i < last; ++i) {
+            for (int corner = 0; corner < 3; ++corner) {
+                const LiteMath::float3& p = vertices [indices [3 * size_t {ids [i]} + corner]].position;
+                const float xyz [3] = {p.x, p.y, p.z};
+                bounds [i].grow (xyz);
+            }
+            for (int axis = 0; axis < 3; ++axis) {
+                centroids [3 * i + axis] = 0.5f * (bounds [i].min [axis] + bounds [i].max [axis]);
+            }
+        }
+    });
+    std::vector <uint32_t> order (triangle_count);
+    for (uint32_t i = 0; i < triangle_count; ++i) {
+        order [i] = i;
+    }
+    const BvhBuilder <Node> builder (bounds, centroids, order);
+
+    struct Range {
+      uint32_t node, first, last, depth;
+    };
+    this->nodes.resize (1);
+    std::vector <Range> pending {{0, 0, triangle_count, 0}};
+    std::vector <Range> subtrees;
+    while (!pending.empty ()) {
+        const Range range = pending.back ();
+        pending.pop_back ();
+        if (range.last - range.first <= SUBTREE_TRIANGLES) {
+            subtrees.push_back (range);
+            continue;
+        }
+        const uint32_t middle = builder.split (this->nodes, range.node, range.first, range.last, range.depth);
+        if (middle != NONE) {
+            const uint32_t children = this->nodes [range.node].first;
+            pending.push_back ({children + 1, middle, range.last, range.depth + 1});
+            pending.push_back ({children, range.first, middle, range.depth + 1});
+        }
+    }
+    std::vector <std::vector <Node>> subtree_nodes (subtrees.size ());
+    parallel_for (executor, concurrency, subtrees.size (), 1, [&] (size_t first, size_t last, unsigned int) {
+        for (size_t s = first; s < last; ++s) {
+            subtree_nodes [s].resize (1);
+            builder.build (subtree_nodes [s], 0, subtrees [s].first, subtrees [s].last, subtrees [s].depth);
+        }
+    });
+    // Subtree roots replace their placeholders; the rest of a subtree is appended with its child links shifted.
+    for (size_t s = 0; s < subtrees.size (); ++s) {
+        std::vector <Node>& local = subtree_nodes [s];
+        const uint32_t base = static_cast <uint32_t> (this->nodes.size ()) - 1;
+        for (Node& node : local) {
+            if (node.count == 0) {
+                node.first += base;
+            }
+        }
+        this->nodes [subtrees [s].node] = local [0];
+        this->nodes.insert (this->nodes.end (), local.begin () + 1, local.end ());
+        std::vector <Node> ().swap (local);
+    }
+
+    // Triangles and normals in leaf order.
+    this->triangles.resize (triangle_count);
+    this->normals.resize (triangle_count);
+    parallel_for (executor, concurrency, triangle_count, RANGE_GRAIN, [&] (size_t first, size_t last, unsigned int) {
+        for (size_t i = first; i < last; ++i) {
+            const uint32_t k = order [i];
+            const size_t t = ids [k];
+            Triangle& triangle = this->triangles [i];
+            float* corners [3] = {triangle.a, triangle.b, triangle.c};
+            TriangleNormals& n = this->normals [i];
+            std::copy (&face_normals [3 * t], &face_normals [3 * t] + 3, n.face);
+            for (int corner = 0; corner < 3; ++corner) {
+                const uint32_t v = indices [3 * t + corner];
+                const LiteMath::float3& p = vertices [v].position;
+                corners [corner] [0] = p.x;
+                corners [corner] [1] = p.y;
+                corners [corner] [2] = p.z;
+                std::copy (&vertex_normals [3 * size_t {v}], &vertex_normals [3 * size_t {v}] + 3, n.vertices [corner]);
+                std::copy (&edge_normals [9 * size_t {k} + 3 * corner], &edge_normals [9 * size_t {k} + 3 * corner] + 3, n.edges [corner]);
+            }
+        }
+    });
+}
+
+float MeshDistanceField::query (const float* p, float bound) const {
+    float best = bound * bound;
+    uint32_t best_triangle = NONE;
+
+    uint32_t stack [STACK_SIZE];
+    float stack_distances [STACK_SIZE];
+    int top = 0;
+    stack [top] = 0;
+    stack_distances [top++] = box_distance_squared (p, this->nodes [0].bounds_min, this->nodes [0].bounds_max);
+    while (top > 0) {
+        --top;
+        if (stack_distances [top] >= best) {
+            continue;
+        }
+        const Node& node = this->nodes [stack [top]];
+        if (node.count > 0) {
+            for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+                const Triangle& triangle = this->triangles [i];
+                float closest [3];
+                closest_point_on_triangle (p, triangle.a, triangle.b, triangle.c, closest);
+                const float d = distance_squared (p, closest);
+                if (d < best) {
+                    best = d;
+                    best_triangle = i;
+                }
+            }
+            continue;
+        }
+
+        // Nearer child on top of the stack.
+        const Node& left = this->nodes [node.first];
+        const Node& right = this->nodes [node.first + 1];
+        const float left_distance = box_distance_squared (p, left.bounds_min, left.bounds_max);
+        const float right_distance = box_distance_squared (p, right.bounds_min, right.bounds_max);
+        const bool left_first = left_distance <= right_distance;
+        const uint32_t near_node = left_first ? node.first : node.first + 1;
+        const uint32_t far_node = left_first ? node.first + 1 : node.first;
+        const float near_distance = std::min (left_distance, right_distance);
+        const float far_distance = std::max (left_distance, right_distance);
+        if (far_distance < best) {
+            stack [top] = far_node;
+            stack_distances [top++] = far_distance;
+        }
+        if (near_distance < best) {
+            stack [top] = near_node;
+            stack_distances [top++] = near_distance;
+        }
+    }
+    if (best_triangle == NONE) {
+        return std::numeric_limits <float>::quiet_NaN ();
+    }
+
+    const Triangle& triangle = this->triangles [best_triangle];
+    const TriangleNormals& n = this->normals [best_triangle];
+    float closest [3];
+    const Feature feature = closest_point_on_triangle (p, triangle.a, triangle.b, triangle.c, closest);
+    const float* normal = n.face;
+    switch (feature) {
+        case VERTEX_A: normal = n.vertices [0]; break;
+        case VERTEX_B: normal = n.vertices [1]; break;
+        case VERTEX_C: normal = n.vertices [2]; break;
+        case EDGE_AB: normal = n.edges [0]; break;
+        case EDGE_BC: normal = n.edges [1]; break;
+        case EDGE_CA: normal = n.edges [2]; break;
+        case FACE: break;
+    }
+    float offset [3];
+    sub3 (p, closest, offset);
+    const float distance = std::sqrt (distance_squared (p, closest));
+    return dot3 (offset, normal) < 0.0f ? -distance : distance;
+}
+
+void MeshDistanceField::evaluate (const float* xs, const float* ys, const float* zs, float* distances, size_t count) const {
+    float previous [3] = {};
+    float previous_distance = INFINITE_DISTANCE;
+    for (size_t i = 0; i < count; ++i) {
+        const float p [3] = {xs [i], ys [i], zs [i]};
+        // The closest point of the previous query is at most this far; slack keeps rounding from pruning it.
+        const float bound = (std::fabs (previous_distance) + std::sqrt (distance_squared (p, previous))) * 1.0001f + 1e-6f;
+        float distance = this->query (p, bound);
+        if (std::isnan (distance)) {
+            distance = this->query (p, INFINITE_DISTANCE);
+        }
+        distances [i] = distance;
+        std::copy (p, p + 3, previous);
+        previous_distance = distance;
+    }
+}
+
+float MeshDistanceField::evaluate (const LiteMath::float3& p) const {
+    float distance = 0.0f;
+    this->evaluate (&p.x, &p.y, &p.z, &distance, 1);
+    return distance;
+}
+
+MeshSdfStats build_sdf_octree_from_mesh (const Mesh& mesh, SdfOctree& octree, const MeshSdfSettings& settings) {
+    if (mesh.get_indices ().empty ()) {
+        throw std::runtime_error {"[build_sdf_octree_from_mesh]: empty mesh"};
+    }
+    if (!(settings.padding >= 0.0f && settings.padding < 1.0f)) {
+        throw std::runtime_error {"[build_sdf_octree_from_mesh]: padding must be in [0, 1)"};
+    }
+    MeshSdfStats stats;
+    const auto start = std::chrono::steady_clock::now ();
+
+    Mesh welded = mesh;
+    MeshWeldSettings weld_settings;
+    weld_settings.max_threads = settings.octree.max_threads;
+    weld_settings.executor = settings.octree.executor;
+    weld_mesh (welded, weld_settings);
+
+    LiteMath::float3 bounds_min {std::numeric_limits <float>::max ()};
+    LiteMath::float3 bounds_max {std::numeric_limits <float>::lowest ()};
+    for (const uint32_t v : welded.get_indices ()) {
+        bounds_min = LiteMath::min (bounds_min, welded.get_vertices () [v].position);
+        bounds_max = LiteMath::max (bounds_max, welded.get_vertices () [v].position);
+    }
+    const LiteMath::float3 extent = bounds_max - bounds_min;
+    const float largest_extent = std::max ({extent.x, extent.y, extent.z});
+    stats.center = (bounds_min + bounds_max) * 0.5f;
+    stats.scale = largest_extent > 0.0f ? 2.0f * (1.0f - settings.padding) / largest_extent : 1.0f;
+    for (Vertex& vertex : welded.get_mutable_vertices ()) {
+        vertex.position = (vertex.position - stats.center) * stats.scale;
+    }
+
+    MeshDistanceSettings distance_settings;
+    distance_settings.max_threads = settings.octree.max_threads;
+    distance_settings.executor = settings.octree.executor;
+    const MeshDistanceField field (welded, distance_settings);
+    welded.clear ();
+    stats.triangles = field.triangle_count ();
+    stats.bvh_nodes = field.node_count ();
+    const auto built = std::chrono::steady_clock::now ();
+    stats.bvh_seconds = std::chrono::duration <double> (built - start).count ();
+
+    stats.octree = build_sdf_octree ([&field] (const float* xs, const float* ys, const float* zs, float* distances, size_t count) {
+        field.evaluate (xs, ys, zs, distances, count);
+    }, octree, settings.octree);
+    stats.octree_seconds = std::chrono::duration <double> (std::chrono::steady_clock::now () - built).count ();
+    return stats;
+}
+
+}
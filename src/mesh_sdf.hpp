@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "LiteMath.h"
+#include "executor.hpp"
+#include "mesh.hpp"
+#include "sdf_octree_builder.hpp"
+
+namespace sdf_raster {
+
+struct MeshDistanceSettings : ParallelSettings {};
+
+// Signed distance to a triangle mesh: exact magnitude, negative inside. The sign is the side of the angle weighted
+// pseudonormal (Baerentzen and Aanaes) of the closest feature, a face, an edge or a vertex, so it is right everywhere
+// for closed, consistently wound meshes whose vertices are shared (weld soups first, see weld_mesh); around holes it
+// is a best guess. Degenerate triangles are left out.
+//
+// Triangles sit in a binned SAH BVH of up to four triangles per leaf. Subtrees above 64K triangles are split
+// serially and the ones below built in parallel, and nodes are laid out in the same order for any max_threads.
+class MeshDistanceField {
+public:
+  explicit MeshDistanceField (const Mesh& mesh, const MeshDistanceSettings& settings = {});
+
+  // Distances at `count` points given as SoA coordinates. Every query starts from the bound the previous point of
+  // the batch gives (its distance plus the distance between the points), which prunes most of the tree for nearby
+  // points, as the octree builder's batches are. Thread-safe.
+  void evaluate (const float* xs, const float* ys, const float* zs, float* distances, size_t count) const;
+  float evaluate (const LiteMath::float3& p) const;
+
+  size_t triangle_count () const { return this->triangles.size (); }
+  size_t node_count () const { return this->nodes.size (); }
+
+private:
+  struct Node {
+    float bounds_min [3];
+    uint32_t first;             // inner node: left child, right child follows; leaf: first triangle
+    float bounds_max [3];
+    uint32_t count;             // triangles of a leaf; 0 for inner nodes
+  };
+
+  // Corners in leaf order, with the pseudonormals used to sign a query closest to them.
+  struct Triangle {
+    float a [3], b [3], c [3];
+  };
+  struct TriangleNormals {
+    float face [3];
+    float edges [3] [3];        // ab, bc, ca
+    float vertices [3] [3];     // a, b, c
+  };
+
+  float query (const float* p, float bound) const;
+
+  std::vector <Node> nodes;
+  std::vector <Triangle> triangles;
+  std::vector <TriangleNormals> normals;
+};
+
+struct MeshSdfSettings {
+  float padding = 0.05f;        // share of the octree's half size left empty around the mesh on every side
+  SdfOctreeBuildSettings octree; // its max_threads and executor are used for the BVH too
+};
+
+struct MeshSdfStats {
+  SdfOctreeBuildStats octree;
+  size_t triangles = 0;         // triangles in the BVH
+  size_t bvh_nodes = 0;
+  LiteMath::float3 center;      // the mesh point at the octree's origin
+  float scale = 1.0f;           // octree units per mesh unit
+  double bvh_seconds = 0.0;
+  double octree_seconds = 0.0;
+};
+
+// Signed distance octree of `mesh`, centered and scaled uniformly so its bounding box fits [-1, 1]^3 with `padding`
+// to spare: octree point p is mesh point center + p / scale, and octree distances are mesh distances times scale.
+// Vertices are welded by position first, so soups (STL) get shared edges for the sign.
+MeshSdfStats build_sdf_octree_from_mesh (const Mesh& mesh, SdfOctree& octree, const MeshSdfSettings& settings = {});
+
+}
@@ -21,7 +21,7 @@ MeshShaderRenderer::~MeshShaderRenderer () {
     std::cout << "MeshShaderRenderer destroyed." << std::endl;
 }
 
-void MeshShaderRenderer::init (int a_width, int a_height, SdfOctree&& a_sdf_octree) {
+void MeshShaderRenderer::init (int a_width, int a_height, SdfOctree&& a_sdf_octree, SdfOctreeEncoding a_encoding) {
     std::cout << "MeshShaderRenderer initializing..." << std::endl;
 
     if (!this->context || !this->context->is_initialized ()) {
@@ -32,12 +32,114 @@ void MeshShaderRenderer::init (int a_width, int a_height, SdfOctree&& a_sdf_octr
     this->height = a_height;
     this->sdf_octree = std::move (a_sdf_octree);
 
-    this->init_mesh_shading_pipeline ();
+    this->init_descriptor_maker ();
+    const VkShaderStageFlags octree_stages = VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT;
+    std::string shader_suffix = ".spv";
+    if (a_encoding == SdfOctreeEncoding::Q8) {
+        SdfOctreeQ8 quantized;
+        quantize_sdf_octree (this->sdf_octree, quantized);
+        std::cout << "Uploading Q8 octree nodes, max error " << quantized.max_error << std::endl;
+        this->sdf_octree_ds = create_sdf_octree_descriptor_set (this->context->get_device ()
+                , this->context->get_physical_device ()
+                , quantized
+                , this->context->get_copy_helper ()
+                , *descriptor_maker
+                , octree_stages);
+        shader_suffix = ".q8.spv";
+    } else if (a_encoding == SdfOctreeEncoding::Q16) {
+        SdfOctreeQ16 quantized;
+        quantize_sdf_octree (this->sdf_octree, quantized);
+        std::cout << "Uploading Q16 octree nodes, max error " << quantized.max_error << std::endl;
+        this->sdf_octree_ds = create_sdf_octree_descriptor_set (this->context->get_device ()
+                , this->context->get_physical_device ()
+                , quantized
+                , this->context->get_copy_helper ()
+                , *descriptor_maker
+                , octree_stages);
+        shader_suffix = ".q16.spv";
+    } else {
+        this->sdf_octree_ds = create_sdf_octree_descriptor_set (this->context->get_device ()
+                , this->context->get_physical_device ()
+                , this->sdf_octree
+                , this->context->get_copy_helper ()
+                , *descriptor_maker
+                , octree_stages);
+    }
+
+	this->marching_cubes_lookup_table_ds = create_lookup_table_descriptor_set (this->context->get_device ()
+			, this->context->get_physical_device ()
+			, this->context->get_copy_helper ()
+			, *descriptor_maker
+			, VK_SHADER_STAGE_MESH_BIT_EXT);
+
+    this->descriptor_set_layouts = {this->sdf_octree_ds.descriptor_set_layout, this->marching_cubes_lookup_table_ds.descriptor_set_layout};
+    this->descriptor_sets = {this->sdf_octree_ds.descriptor_set, this->marching_cubes_lookup_table_ds.descriptor_set};
+
+    this->init_mesh_shading_pipeline ("./assets/shaders/task_generator.slang" + shader_suffix, "./assets/shaders/mesh_sphere.slang" + shader_suffix);
+    this->initialized = true;
+    std::cout << "MeshShaderRenderer initialized successfully." << std::endl;
+}
+
+void MeshShaderRenderer::init (int a_width, int a_height, const Mesh& a_mesh, const Meshlets& a_meshlets) {
+    std::cout << "MeshShaderRenderer initializing with " << a_meshlets.size () << " meshlets..." << std::endl;
+
+    if (!this->context || !this->context->is_initialized ()) {
+        throw std::runtime_error("[MeshShaderRenderer::init] VulkanContext is not initialized before renderer init.");
+    }
+    if (a_meshlets.mesh_vertex_count != a_mesh.get_vertices ().size ()) {
+        throw std::runtime_error ("[MeshShaderRenderer::init] meshlets were built for another mesh");
+    }
+    for (const Meshlet& meshlet : a_meshlets.meshlets) {
+        if (meshlet.vertex_count > MESHLET_MAX_VERTICES || meshlet.triangle_count > MESHLET_MAX_TRIANGLES) {
+            throw std::runtime_error ("[MeshShaderRenderer::init] meshlet exceeds the mesh shader output limits");
+        }
+    }
+
+    this->width = a_width;
+    this->height = a_height;
+    this->meshlet_count = static_cast <uint32_t> (a_meshlets.size ());
+
+    // The mesh shader decodes Unorm16 positions with the origin and step from the push constants, and octahedral normals.
+    CompactMeshLayout layout;
+    layout.positions = MeshPositionEncoding::Unorm16;
+    layout.normals = MeshNormalEncoding::Octahedral16;
+    const CompactMesh compact_mesh (a_mesh, layout);
+    this->push_constants.position_origin = compact_mesh.get_quantization_origin ();
+    this->push_constants.position_step = compact_mesh.get_quantization_step ();
+
+    this->init_descriptor_maker ();
+    this->compact_mesh_ds = create_compact_mesh_descriptor_set (this->context->get_device ()
+            , this->context->get_physical_device ()
+            , compact_mesh
+            , this->context->get_copy_helper ()
+            , *descriptor_maker
+            , VK_SHADER_STAGE_MESH_BIT_EXT);
+    this->meshlet_ds = create_meshlet_descriptor_set (this->context->get_device ()
+            , this->context->get_physical_device ()
+            , a_meshlets
+            , this->context->get_copy_helper ()
+            , *descriptor_maker
+            , VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT);
+
+    this->descriptor_set_layouts = {this->compact_mesh_ds.descriptor_set_layout, this->meshlet_ds.descriptor_set_layout};
+    this->descriptor_sets = {this->compact_mesh_ds.descriptor_set, this->meshlet_ds.descriptor_set};
+
+    this->init_mesh_shading_pipeline ("./assets/shaders/task_meshlet.slang.spv", "./assets/shaders/mesh_meshlet.slang.spv");
     this->initialized = true;
     std::cout << "MeshShaderRenderer initialized successfully." << std::endl;
 }
 
-void MeshShaderRenderer::init_mesh_shading_pipeline () {
+void MeshShaderRenderer::init_descriptor_maker () {
+    vk_utils::DescriptorTypesVec ds_type_vec {};
+    ds_type_vec.emplace_back (VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1000);
+    this->descriptor_maker = std::make_shared <vk_utils::DescriptorMaker> (
+            this->context->get_device ()
+            , ds_type_vec
+            , 3
+            );
+}
+
+void MeshShaderRenderer::init_mesh_shading_pipeline (const std::string& a_task_shader, const std::string& a_mesh_shader) {
     std::cout << "MeshShaderRenderer::init_mesh_shading_pipeline called." << std::endl;
 
     const size_t shaders_count = 3;
@@ -45,12 +147,12 @@ void MeshShaderRenderer::init_mesh_shading_pipeline () {
     std::vector <VkPipelineShaderStageCreateInfo> shader_stages (shaders_count);
 
     shader_stages [0] = vk_utils::loadShader (this->context->get_device ()
-            , "./assets/shaders/task_generator.slang.spv"
+            , a_task_shader.c_str ()
             , VK_SHADER_STAGE_TASK_BIT_EXT
             , shader_modules);
 
     shader_stages [1] = vk_utils::loadShader (this->context->get_device ()
-            , "./assets/shaders/mesh_sphere.slang.spv"
+            , a_mesh_shader.c_str ()
             , VK_SHADER_STAGE_MESH_BIT_EXT
             , shader_modules);
 
@@ -64,34 +166,10 @@ void MeshShaderRenderer::init_mesh_shading_pipeline () {
     pushConstantRange.size = sizeof (PushConstantsData);
     pushConstantRange.offset = 0;
 
-    vk_utils::DescriptorTypesVec ds_type_vec {};
-    ds_type_vec.emplace_back (VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1000);
-    this->descriptor_maker = std::make_shared <vk_utils::DescriptorMaker> (
-            this->context->get_device ()
-            , ds_type_vec
-            , 3
-            );
-	this->sdf_octree_ds = create_sdf_octree_descriptor_set (this->context->get_device ()
-			, this->context->get_physical_device ()
-			, this->sdf_octree
-			, this->context->get_copy_helper ()
-			, *descriptor_maker
-			, VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT);
-
-	this->marching_cubes_lookup_table_ds = create_lookup_table_descriptor_set (this->context->get_device ()
-			, this->context->get_physical_device ()
-			, this->context->get_copy_helper ()
-			, *descriptor_maker
-			, VK_SHADER_STAGE_MESH_BIT_EXT);
-
-    std::vector <VkDescriptorSetLayout> descriptor_set_layouts {};
-    descriptor_set_layouts.push_back (this->sdf_octree_ds.descriptor_set_layout);
-    descriptor_set_layouts.push_back (this->marching_cubes_lookup_table_ds.descriptor_set_layout);
-
     VkPipelineLayoutCreateInfo pipelineLayoutInfo {};
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = descriptor_set_layouts.size ();
-    pipelineLayoutInfo.pSetLayouts = descriptor_set_layouts.data ();
+    pipelineLayoutInfo.setLayoutCount = this->descriptor_set_layouts.size ();
+    pipelineLayoutInfo.pSetLayouts = this->descriptor_set_layouts.data ();
     pipelineLayoutInfo.pushConstantRangeCount = 1;
     pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
@@ -222,19 +300,8 @@ void MeshShaderRenderer::render (const Camera& a_camera) {
             VK_PIPELINE_BIND_POINT_GRAPHICS,
             this->pipeline_layout,
             0,
-            1,
-            &this->sdf_octree_ds.descriptor_set,
-            0,
-            nullptr
-            );
-
-    vkCmdBindDescriptorSets (
-            cmd_buff,
-            VK_PIPELINE_BIND_POINT_GRAPHICS,
-            this->pipeline_layout,
-            1,
-            1,
-            &this->marching_cubes_lookup_table_ds.descriptor_set,
+            static_cast <uint32_t> (this->descriptor_sets.size ()),
+            this->descriptor_sets.data (),
             0,
             nullptr
             );
@@ -247,7 +314,11 @@ void MeshShaderRenderer::render (const Camera& a_camera) {
             , &this->push_constants
             );
 
-    vkCmdDrawMeshTasksEXT (cmd_buff, 1, 1, 1);
+    if (this->meshlet_count > 0) {
+        vkCmdDrawMeshTasksEXT (cmd_buff, (this->meshlet_count + MESHLET_TASK_GROUP_SIZE - 1) / MESHLET_TASK_GROUP_SIZE, 1, 1);
+    } else {
+        vkCmdDrawMeshTasksEXT (cmd_buff, 1, 1, 1);
+    }
 
     this->context->end_frame (cmd_buff);
 }
@@ -277,6 +348,8 @@ void MeshShaderRenderer::shutdown () {
     std::cout << "MeshShaderRenderer shutting down..." << std::endl;
 
     this->descriptor_maker.reset ();
+    cleanup_compact_mesh_descriptor_set (this->context->get_device (), this->compact_mesh_ds);
+    cleanup_meshlet_descriptor_set (this->context->get_device (), this->meshlet_ds);
 
     if (this->pipeline != VK_NULL_HANDLE) {
         vkDestroyPipeline (this->context->get_device (), this->pipeline, nullptr);
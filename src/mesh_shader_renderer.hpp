@@ -8,9 +8,12 @@
 #include "GLFW/glfw3.h"
 
 #include "camera.hpp"
+#include "compact_mesh.hpp"
 #include "marching_cubes_lookup_table.hpp"
 #include "mesh.hpp"
+#include "meshlet.hpp"
 #include "sdf_octree.hpp"
+#include "sdf_octree_quantized.hpp"
 #include "shaders/common.h"
 #include "vk_descriptor_sets.h"
 #include "vulkan_context.hpp"
@@ -23,20 +26,29 @@ public:
     explicit MeshShaderRenderer (std::shared_ptr <VulkanContext> vulkan_context);
     ~MeshShaderRenderer ();
 
-    void init (int a_width, int a_height, SdfOctree&& a_sdf_octree);
+    // Quantized encodings upload Q8/Q16 nodes and use the shader builds that decode them.
+    void init (int a_width, int a_height, SdfOctree&& a_sdf_octree, SdfOctreeEncoding a_encoding = SdfOctreeEncoding::Float32);
+    // Draws pre-extracted geometry instead: one task shader thread per meshlet culls it against the frustum and its
+    // normal cone, the survivors go to the mesh shader. The meshlets must fit MESHLET_MAX_VERTICES/TRIANGLES.
+    void init (int a_width, int a_height, const Mesh& a_mesh, const Meshlets& a_meshlets);
     void render (const Camera& a_camera);
     void resize (int a_width, int a_height);
     void shutdown ();
     void update_push_constants (const Camera& a_camera);
 
 private:
-    void init_mesh_shading_pipeline ();
+    void init_descriptor_maker ();
+    void init_mesh_shading_pipeline (const std::string& a_task_shader, const std::string& a_mesh_shader);
 
     std::shared_ptr <VulkanContext> context {nullptr};
 
     std::shared_ptr <vk_utils::DescriptorMaker> descriptor_maker {nullptr};
     SdfOctreeDescriptorSetInfo sdf_octree_ds {};
     MarchingCubesLookupTableDescriptorSetInfo marching_cubes_lookup_table_ds {};
+    CompactMeshDescriptorSetInfo compact_mesh_ds {};
+    MeshletDescriptorSetInfo meshlet_ds {};
+    std::vector <VkDescriptorSetLayout> descriptor_set_layouts {};
+    std::vector <VkDescriptorSet> descriptor_sets {};
 
     VkRenderPass render_pass {VK_NULL_HANDLE};
     VkPipelineLayout pipeline_layout {VK_NULL_HANDLE};
@@ -45,6 +57,7 @@ private:
     int width {};
     int height {};
     SdfOctree sdf_octree {};
+    uint32_t meshlet_count {0};
 
     PushConstantsData push_constants;
 
@@ -0,0 +1,614 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+
+#include "mesh_simplify.hpp"
+
+namespace sdf_raster {
+
+namespace {
+
+// Triangles per cell of the pass grid, roughly: enough work for a task, few enough vertices locked on cell borders.
+constexpr size_t CELL_TRIANGLES = 8192;
+constexpr size_t MAX_PASSES = 64;
+constexpr uint32_t LOCKED = ~0u;
+constexpr size_t RANGE_GRAIN = 1 << 16;
+
+// Sum of area weighted squared distances to planes n.x + d = 0, as x^T A x + 2 b.x + c with A symmetric.
+struct Quadric {
+  double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+  double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+  double c = 0.0;
+  double area = 0.0;
+
+  void add_plane (double nx, double ny, double nz, double d, double w) {
+      this->a00 += w * nx * nx; this->a01 += w * nx * ny; this->a02 += w * nx * nz;
+      this->a11 += w * ny * ny; this->a12 += w * ny * nz; this->a22 += w * nz * nz;
+      this->b0 += w * nx * d; this->b1 += w * ny * d; this->b2 += w * nz * d;
+      this->c += w * d * d;
+      this->area += w;
+  }
+
+  Quadric operator + (const Quadric& o) const {
+      Quadric q;
+      q.a00 = this->a00 + o.a00; q.a01 = this->a01 + o.a01; q.a02 = this->a02 + o.a02;
+      q.a11 = this->a11 + o.a11; q.a12 = this->a12 + o.a12; q.a22 = this->a22 + o.a22;
+      q.b0 = this->b0 + o.b0; q.b1 = this->b1 + o.b1; q.b2 = this->b2 + o.b2;
+      q.c = this->c + o.c;
+      q.area = this->area + o.area;
+      return q;
+  }
+
+  double error (const LiteMath::float3& p) const {
+      const double x = p.x, y = p.y, z = p.z;
+      return x * (this->a00 * x + 2.0 * (this->a01 * y + this->a02 * z + this->b0))
+           + y * (this->a11 * y + 2.0 * (this->a12 * z + this->b1))
+           + z * (this->a22 * z + 2.0 * this->b2)
+           + this->c;
+  }
+
+  // Point of least error, if A is well enough conditioned to have one.
+  bool minimum (LiteMath::float3& p) const {
+      const double c00 = this->a11 * this->a22 - this->a12 * this->a12;
+      const double c01 = this->a02 * this->a12 - this->a01 * this->a22;
+      const double c02 = this->a01 * this->a12 - this->a02 * this->a11;
+      const double det = this->a00 * c00 + this->a01 * c01 + this->a02 * c02;
+      const double scale = this->a00 + this->a11 + this->a22;
+      if (!(std::fabs (det) > 1e-9 * scale * scale * scale)) {
+          return false;
+      }
+      const double c11 = this->a00 * this->a22 - this->a02 * this->a02;
+      const double c12 = this->a01 * this->a02 - this->a00 * this->a12;
+      const double c22 = this->a00 * this->a11 - this->a01 * this->a01;
+      p.x = float (-(c00 * this->b0 + c01 * this->b1 + c02 * this->b2) / det);
+      p.y = float (-(c01 * this->b0 + c11 * this->b1 + c12 * this->b2) / det);
+      p.z = float (-(c02 * this->b0 + c12 * this->b1 + c22 * this->b2) / det);
+      return true;
+  }
+};
+
+// Collapse of edge (keep, gone) into `keep` at `position`.
+struct Collapse {
+  float cost;
+  uint32_t keep;
+  uint32_t gone;
+  LiteMath::float3 position;
+
+  // Cheapest first, ties broken by vertex ids.
+  bool operator < (const Collapse& o) const {
+      return this->cost != o.cost ? this->cost < o.cost : this->keep != o.keep ? this->keep < o.keep : this->gone < o.gone;
+  }
+};
+
+struct SlotScratch {
+  std::vector <Collapse> options;
+  std::vector <uint32_t> edges;
+  std::vector <uint32_t> keep_neighbors;
+  std::vector <uint32_t> gone_neighbors;
+};
+
+LiteMath::float3 triangle_cross (const LiteMath::float3& a, const LiteMath::float3& b, const LiteMath::float3& c) {
+    return LiteMath::cross (b - a, c - a);
+}
+
+class Simplifier {
+public:
+  Simplifier (Mesh& mesh, const MeshSimplifySettings& settings, Executor& executor, unsigned int concurrency)
+      : vertices (mesh.get_mutable_vertices ())
+      , indices (mesh.get_mutable_indices ())
+      , executor (executor)
+      , concurrency (concurrency)
+      , max_cost (settings.max_error * settings.max_error)
+      , scratch (concurrency) {
+  }
+
+  // Builds the adjacency and, on the first pass, the vertex quadrics.
+  void begin_pass (size_t pass);
+  // Collapses at most `needed` edges over all cells; returns how many were made.
+  size_t collapse_pass (size_t needed);
+  // Drops collapsed vertices and dead triangles.
+  void compact ();
+
+  size_t triangle_count () const { return this->indices.size () / 3; }
+  float largest_cost () const { return this->largest; }
+
+private:
+  // Live triangles around v, which has not taken part in a collapse this pass.
+  template <typename Function>
+  void for_each_triangle (uint32_t v, const Function& function) const {
+      for (uint32_t i = this->adjacency_offsets [v]; i < this->adjacency_offsets [v + 1]; ++i) {
+          const uint32_t t = this->adjacency [i];
+          if (!this->dead [t]) {
+              function (t);
+          }
+      }
+  }
+
+  // Distinct vertices sharing a live triangle with v, v excluded, sorted.
+  void gather_neighbors (uint32_t v, std::vector <uint32_t>& neighbors) const;
+  bool evaluate (uint32_t keep, uint32_t gone, Collapse& collapse) const;
+  bool can_collapse (const Collapse& collapse, SlotScratch& scratch) const;
+  void collapse (const Collapse& collapse);
+  void process_cell (size_t cell, float threshold, size_t quota, SlotScratch& scratch);
+
+  std::vector <Vertex>& vertices;
+  std::vector <uint32_t>& indices;
+  Executor& executor;
+  unsigned int concurrency;
+  float max_cost;
+  std::vector <SlotScratch> scratch;
+
+  std::vector <Quadric> quadrics;
+  std::vector <uint32_t> adjacency_offsets;
+  std::vector <uint32_t> adjacency;
+  std::vector <uint32_t> cells;       // cell of every vertex, LOCKED for vertices that must not move this pass
+  std::vector <uint32_t> merged_into; // the vertex itself while alive
+  std::vector <uint32_t> partners;    // the other end of the edge a vertex offers, LOCKED if none
+  std::vector <uint8_t> touched;      // took part in a collapse this pass
+  std::vector <uint8_t> dead;
+
+  std::vector <size_t> cell_offsets;
+  std::vector <uint32_t> cell_vertices;
+  std::vector <std::vector <Collapse>> cell_candidates;
+  std::vector <size_t> cell_collapses;
+  std::vector <float> cell_largest;
+  float largest = 0.0f;
+};
+
+void Simplifier::begin_pass (size_t pass) {
+    const size_t vertex_count = this->vertices.size ();
+    const size_t triangle_count = this->triangle_count ();
+
+    // Vertex to triangle adjacency, each list sorted so everything below is independent of scheduling.
+    std::unique_ptr <std::atomic <uint32_t> []> counts (new std::atomic <uint32_t> [vertex_count + 1]);
+    parallel_for (this->executor, this->concurrency, vertex_count + 1, RANGE_GRAIN, [&] (size_t first, size_t last, unsigned int) {
+        for (size_t v = first; v < last; ++v) {
+            counts [v].store (0, std::memory_order_relaxed);
+        }
+    });
+    parallel_for (this->executor, this->concurrency, this->indices.size (), RANGE_GRAIN, [&] (size_t first, size_t last, unsigned int) {
+        for (size_t i = first; i < last; ++i) {
+            counts [this->indices [i]].fetch_add (1, std::memory_order_relaxed);
+        }
+    });
+    this->adjacency_offsets.assign (vertex_count + 1, 0);
+    for (size_t v = 0; v < vertex_count; ++v) {
+        this->adjacency_offsets [v + 1] = this->adjacency_offsets [v] + counts [v].load (std::memory_order_relaxed);
+        counts [v].store (this->adjacency_offsets [v], std::memory_order_relaxed);
+    }
+    this->adjacency.resize (this->indices.size ());
+    parallel_for (this->executor, this->concurrency, this->indices.size (), RANGE_GRAIN, [&] (size_t first, size_t last, unsigned int) {
+        for (size_t i = first; i < last; ++i) {
+            this->adjacency [counts [this->indices [i]].fetch_add (1, std::memory_order_relaxed)] = static_cast <uint32_t> (i / 3);
+        }
+    });
+    parallel_for (this->executor, this->concurrency, vertex_count, RANGE_GRAIN, [&] (size_t first, size_t last, unsigned int) {
+        for (size_t v = first; v < last; ++v) {
+            std::sort (this->adjacency.begin () + this->adjacency_offsets [v], this->adjacency.begin () + this->adjacency_offsets [v + 1]);
+        }
+    });
+
+    if (pass == 0) {
+        this->quadrics.resize (vertex_count);
+        parallel_for (this->executor, this->concurrency, vertex_count, RANGE_GRAIN, [&] (size_t first, size_t last, unsigned int) {
+            for (size_t v = first; v < last; ++v) {
+                Quadric q;
+                for (uint32_t i = this->adjacency_offsets [v]; i < this->adjacency_offsets [v + 1]; ++i) {
+                    const uint32_t* triangle = &this->indices [3 * size_t {this->adjacency [i]}];
+                    const LiteMath::float3& p0 = this->vertices [triangle [0]].position;
+                    const LiteMath::float3 cross = triangle_cross (p0, this->vertices [triangle [1]].position, this->vertices [triangle [2]].position);
+                    const double length = std::sqrt (double (cross.x) * cross.x + double (cross.y) * cross.y + double (cross.z) * cross.z);
+                    if (length == 0.0) {
+                        continue;
+                    }
+                    const double nx = cross.x / length, ny = cross.y / length, nz = cross.z / length;
+                    q.add_plane (nx, ny, nz, -(nx * p0.x + ny * p0.y + nz * p0.z), 0.5 * length);
+                }
+                this->quadrics [v] = q;
+            }
+        });
+    }
+
+    // Grid of roughly triangle_count / CELL_TRIANGLES cells over the surface, shifted by half a cell on odd passes.
+    LiteMath::float3 bounds_min {std::numeric_limits <float>::max ()};
+    LiteMath::float3 bounds_max {std::numeric_limits <float>::lowest ()};
+    for (const Vertex& vertex : this->vertices) {
+        bounds_min = LiteMath::min (bounds_min, vertex.position);
+        bounds_max = LiteMath::max (bounds_max, vertex.position);
+    }
+    const LiteMath::float3 extent = LiteMath::max (bounds_max - bounds_min, LiteMath::float3 {0.0f});
+    const float largest_extent = std::max ({extent.x, extent.y, extent.z});
+    const size_t cells_per_axis = std::max <size_t> (1, size_t (std::sqrt (double (triangle_count) / CELL_TRIANGLES)));
+    const float cell_size = largest_extent > 0.0f ? largest_extent / cells_per_axis : 1.0f;
+    const LiteMath::float3 origin = bounds_min - LiteMath::float3 {pass % 2 == 1 ? 0.5f * cell_size : 0.0f};
+    size_t grid [3];
+    for (int axis = 0; axis < 3; ++axis) {
+        grid [axis] = size_t ((bounds_max [axis] - origin [axis]) / cell_size) + 1;
+    }
+    const size_t cell_count = grid [0] * grid [1] * grid [2];
+
+    this->cells.resize (vertex_count);
+    parallel_for (this->executor, this->concurrency, vertex_count, RANGE_GRAIN, [&] (size_t first, size_t last, unsigned int) {
+        for (size_t v = first; v < last; ++v) {
+            size_t cell [3];
+            for (int axis = 0; axis < 3; ++axis) {
+                const float x = (this->vertices [v].position [axis] - origin [axis]) / cell_size;
+                cell [axis] = std::min (grid [axis] - 1, size_t (std::max (0.0f, x)));
+            }
+            this->cells [v] = static_cast <uint32_t> (cell [0] + grid [0] * (cell [1] + grid [1] * cell [2]));
+        }
+    });
+
+    // A vertex may move when all its triangles lie in its cell and each of its edges has exactly two triangles; the
+    // others (cell borders, open borders, non-manifold edges) are locked for the pass.
+    std::vector <uint32_t> locked (vertex_count);
+    parallel_for (this->executor, this->concurrency, vertex_count, RANGE_GRAIN, [&] (size_t first, size_t last, unsigned int slot) {
+        std::vector <uint32_t>& others = this->scratch [slot].keep_neighbors;
+        for (size_t v = first; v < last; ++v) {
+            bool is_locked = this->adjacency_offsets [v] == this->adjacency_offsets [v + 1];
+            others.clear ();
+            for (uint32_t i = this->adjacency_offsets [v]; i < this->adjacency_offsets [v + 1] && !is_locked; ++i) {
+                const uint32_t* triangle = &this->indices [3 * size_t {this->adjacency [i]}];
+                for (int corner = 0; corner < 3; ++corner) {
+                    is_locked |= this->cells [triangle [corner]] != this->cells [v];
+                    if (triangle [corner] != v) {
+                        others.push_back (triangle [corner]);
+                    }
+                }
+            }
+            std::sort (others.begin (), others.end ());
+            for (size_t i = 0; i < others.size () && !is_locked; i += 2) {
+                is_locked = i + 1 == others.size () || others [i] != others [i + 1] || (i + 2 < others.size () && others [i + 2] == others [i]);
+            }
+            locked [v] = is_locked;
+        }
+    });
+
+    this->cell_offsets.assign (cell_count + 1, 0);
+    for (size_t v = 0; v < vertex_count; ++v) {
+        if (locked [v]) {
+            this->cells [v] = LOCKED;
+        } else {
+            ++this->cell_offsets [this->cells [v] + 1];
+        }
+    }
+    for (size_t cell = 0; cell < cell_count; ++cell) {
+        this->cell_offsets [cell + 1] += this->cell_offsets [cell];
+    }
+    this->cell_vertices.resize (this->cell_offsets [cell_count]);
+    std::vector <size_t> cursors (this->cell_offsets.begin (), this->cell_offsets.end () - 1);
+    for (size_t v = 0; v < vertex_count; ++v) {
+        if (this->cells [v] != LOCKED) {
+            this->cell_vertices [cursors [this->cells [v]]++] = static_cast <uint32_t> (v);
+        }
+    }
+
+    this->merged_into.resize (vertex_count);
+    this->partners.assign (vertex_count, LOCKED);
+    this->touched.assign (vertex_count, 0);
+    for (size_t v = 0; v < vertex_count; ++v) {
+        this->merged_into [v] = static_cast <uint32_t> (v);
+    }
+    this->dead.assign (triangle_count, 0);
+    this->cell_candidates.assign (cell_count, {});
+    this->cell_collapses.assign (cell_count, 0);
+    this->cell_largest.assign (cell_count, 0.0f);
+}
+
+// Unlocked vertices have a closed fan, so taking the corner after v in every triangle lists each neighbour once.
+void Simplifier::gather_neighbors (uint32_t v, std::vector <uint32_t>& neighbors) const {
+    neighbors.clear ();
+    this->for_each_triangle (v, [&] (uint32_t t) {
+        const uint32_t* triangle = &this->indices [3 * size_t {t}];
+        neighbors.push_back (triangle [0] == v ? triangle [1] : triangle [1] == v ? triangle [2] : triangle [0]);
+    });
+    std::sort (neighbors.begin (), neighbors.end ());
+}
+
+// Places the merged vertex at the minimum of the summed quadric, or at the better end or the midpoint when the
+// minimum is undefined (flat or straight neighbourhoods) or far off the edge.
+bool Simplifier::evaluate (uint32_t keep, uint32_t gone, Collapse& collapse) const {
+    const Quadric q = this->quadrics [keep] + this->quadrics [gone];
+    const LiteMath::float3& a = this->vertices [keep].position;
+    const LiteMath::float3& b = this->vertices [gone].position;
+    const LiteMath::float3 midpoint = 0.5f * (a + b);
+
+    LiteMath::float3 position;
+    double error = 0.0;
+    const float reach = LiteMath::dot (b - a, b - a);
+    if (q.minimum (position) && LiteMath::dot (position - midpoint, position - midpoint) <= reach) {
+        error = q.error (position);
+    } else {
+        position = a;
+        error = q.error (a);
+        for (const LiteMath::float3& p : {b, midpoint}) {
+            const double e = q.error (p);
+            if (e < error) {
+                error = e;
+                position = p;
+            }
+        }
+    }
+
+    const float cost = float (std::max (0.0, error) / std::max (q.area, 1e-30));
+    if (!(cost <= this->max_cost)) {
+        return false;
+    }
+    collapse = {cost, keep, gone, position};
+    return true;
+}
+
+// The third vertices of the edge's two triangles must be the only neighbours both ends share (the link condition,
+// so the surface stays manifold), and no remaining triangle may turn over or degenerate.
+bool Simplifier::can_collapse (const Collapse& collapse, SlotScratch& scratch) const {
+    const uint32_t keep = collapse.keep;
+    const uint32_t gone = collapse.gone;
+    this->gather_neighbors (keep, scratch.keep_neighbors);
+    this->gather_neighbors (gone, scratch.gone_neighbors);
+    size_t common = 0;
+    for (size_t i = 0, j = 0; i < scratch.keep_neighbors.size () && j < scratch.gone_neighbors.size (); ) {
+        if (scratch.keep_neighbors [i] < scratch.gone_neighbors [j]) {
+            ++i;
+        } else if (scratch.gone_neighbors [j] < scratch.keep_neighbors [i]) {
+            ++j;
+        } else {
+            ++common;
+            ++i;
+            ++j;
+        }
+    }
+    if (common != 2) {
+        return false;
+    }
+
+    bool valid = true;
+    for (const uint32_t moved : {keep, gone}) {
+        const uint32_t other = moved == keep ? gone : keep;
+        this->for_each_triangle (moved, [&] (uint32_t t) {
+            const uint32_t* triangle = &this->indices [3 * size_t {t}];
+            if (!valid || triangle [0] == other || triangle [1] == other || triangle [2] == other) {
+                return;
+            }
+            LiteMath::float3 p [3];
+            for (int corner = 0; corner < 3; ++corner) {
+                p [corner] = this->vertices [triangle [corner]].position;
+            }
+            const LiteMath::float3 before = triangle_cross (p [0], p [1], p [2]);
+            for (int corner = 0; corner < 3; ++corner) {
+                p [corner] = triangle [corner] == moved ? collapse.position : p [corner];
+            }
+            const LiteMath::float3 after = triangle_cross (p [0], p [1], p [2]);
+            const float after_length = LiteMath::length (after);
+            valid = after_length > 0.0f && LiteMath::dot (before, after) > 0.25f * LiteMath::length (before) * after_length;
+        });
+    }
+    return valid;
+}
+
+void Simplifier::collapse (const Collapse& collapse) {
+    const uint32_t keep = collapse.keep;
+    const uint32_t gone = collapse.gone;
+    this->for_each_triangle (gone, [&] (uint32_t t) {
+        uint32_t* triangle = &this->indices [3 * size_t {t}];
+        if (triangle [0] == keep || triangle [1] == keep || triangle [2] == keep) {
+            this->dead [t] = 1;
+            return;
+        }
+        for (int corner = 0; corner < 3; ++corner) {
+            triangle [corner] = triangle [corner] == gone ? keep : triangle [corner];
+        }
+    });
+    this->merged_into [gone] = keep;
+    this->touched [keep] = 1;
+    this->touched [gone] = 1;
+
+    Vertex& kept = this->vertices [keep];
+    const LiteMath::float3 normal = kept.normal + this->vertices [gone].normal;
+    const float normal_length = LiteMath::length (normal);
+    kept.normal = normal_length > 0.0f ? normal / normal_length : kept.normal;
+    kept.position = collapse.position;
+    this->quadrics [keep] = this->quadrics [keep] + this->quadrics [gone];
+}
+
+// Collapses the cell's offered edges cheapest first while they cost at most `threshold`, at most `quota` of them,
+// each vertex in one collapse at most so the costs evaluated at the start of the pass stay exact. Everything it
+// touches belongs to the cell: unlocked vertices and the triangles around them.
+void Simplifier::process_cell (size_t cell, float threshold, size_t quota, SlotScratch& scratch) {
+    std::vector <Collapse>& candidates = this->cell_candidates [cell];
+    std::sort (candidates.begin (), candidates.end ());
+
+    size_t collapses = 0;
+    float largest_cost = 0.0f;
+    for (const Collapse& candidate : candidates) {
+        if (collapses == quota || candidate.cost > threshold) {
+            break;
+        }
+        if (this->touched [candidate.keep] || this->touched [candidate.gone] || !this->can_collapse (candidate, scratch)) {
+            continue;
+        }
+        this->collapse (candidate);
+        ++collapses;
+        largest_cost = std::max (largest_cost, candidate.cost);
+    }
+    this->cell_collapses [cell] = collapses;
+    this->cell_largest [cell] = largest_cost;
+    std::vector <Collapse> ().swap (candidates);
+}
+
+size_t Simplifier::collapse_pass (size_t needed) {
+    const size_t cell_count = this->cell_candidates.size ();
+
+    // Every vertex offers its cheapest edge that could collapse right now (an edge both ends pick is offered once);
+    // counting blocked edges would hold the threshold down for good.
+    parallel_for (this->executor, this->concurrency, cell_count, 1, [&] (size_t first, size_t last, unsigned int slot) {
+        SlotScratch& scratch = this->scratch [slot];
+        for (size_t cell = first; cell < last; ++cell) {
+            auto& candidates = this->cell_candidates [cell];
+            for (size_t i = this->cell_offsets [cell]; i < this->cell_offsets [cell + 1]; ++i) {
+                const uint32_t v = this->cell_vertices [i];
+                this->gather_neighbors (v, scratch.edges);
+                scratch.options.clear ();
+                for (const uint32_t neighbor : scratch.edges) {
+                    Collapse collapse;
+                    if (this->cells [neighbor] != LOCKED && this->evaluate (v, neighbor, collapse)) {
+                        scratch.options.push_back (collapse);
+                    }
+                }
+                std::sort (scratch.options.begin (), scratch.options.end ());
+                this->partners [v] = LOCKED;
+                for (const Collapse& option : scratch.options) {
+                    if (this->can_collapse (option, scratch)) {
+                        this->partners [v] = option.gone;
+                        candidates.push_back (option);
+                        break;
+                    }
+                }
+            }
+            candidates.erase (std::remove_if (candidates.begin (), candidates.end (), [&] (const Collapse& c) {
+                return this->partners [c.gone] == c.keep && c.gone < c.keep;
+            }), candidates.end ());
+        }
+    });
+
+    // Cells share the needed collapses in proportion to their offers among the 2 * needed cheapest of the whole mesh,
+    // so each collapses roughly what a single global queue would have; the slack makes up for offers that conflict.
+    std::vector <float> costs;
+    for (const auto& candidates : this->cell_candidates) {
+        for (const Collapse& collapse : candidates) {
+            costs.push_back (collapse.cost);
+        }
+    }
+    float threshold = std::numeric_limits <float>::infinity ();
+    if (2 * needed < costs.size ()) {
+        std::nth_element (costs.begin (), costs.begin () + (2 * needed - 1), costs.end ());
+        threshold = costs [2 * needed - 1];
+    }
+    std::vector <float> ().swap (costs);
+
+    std::vector <size_t> offered (cell_count + 1, 0);
+    parallel_for (this->executor, this->concurrency, cell_count, 64, [&] (size_t first, size_t last, unsigned int) {
+        for (size_t cell = first; cell < last; ++cell) {
+            for (const Collapse& collapse : this->cell_candidates [cell]) {
+                offered [cell + 1] += collapse.cost <= threshold;
+            }
+        }
+    });
+    for (size_t cell = 0; cell < cell_count; ++cell) {
+        offered [cell + 1] += offered [cell];
+    }
+    const size_t total_offered = std::max <size_t> (1, offered [cell_count]);
+    const size_t goal = std::min (needed, offered [cell_count]);
+
+    parallel_for (this->executor, this->concurrency, cell_count, 1, [&] (size_t first, size_t last, unsigned int slot) {
+        for (size_t cell = first; cell < last; ++cell) {
+            const size_t quota = goal * offered [cell + 1] / total_offered - goal * offered [cell] / total_offered;
+            this->process_cell (cell, threshold, quota, this->scratch [slot]);
+        }
+    });
+
+    size_t collapses = 0;
+    for (size_t cell = 0; cell < cell_count; ++cell) {
+        collapses += this->cell_collapses [cell];
+        this->largest = std::max (this->largest, this->cell_largest [cell]);
+    }
+    return collapses;
+}
+
+void Simplifier::compact () {
+    const size_t vertex_count = this->vertices.size ();
+    const size_t triangle_count = this->triangle_count ();
+    const size_t vertex_ranges = (vertex_count + RANGE_GRAIN - 1) / RANGE_GRAIN;
+    const size_t triangle_ranges = (triangle_count + RANGE_GRAIN - 1) / RANGE_GRAIN;
+
+    std::vector <size_t> vertex_bases (vertex_ranges + 1, 0);
+    std::vector <size_t> triangle_bases (triangle_ranges + 1, 0);
+    parallel_for (this->executor, this->concurrency, vertex_count, RANGE_GRAIN, [&] (size_t first, size_t last, unsigned int) {
+        size_t kept = 0;
+        for (size_t v = first; v < last; ++v) {
+            kept += this->merged_into [v] == v;
+        }
+        vertex_bases [first / RANGE_GRAIN + 1] = kept;
+    });
+    parallel_for (this->executor, this->concurrency, triangle_count, RANGE_GRAIN, [&] (size_t first, size_t last, unsigned int) {
+        size_t kept = 0;
+        for (size_t t = first; t < last; ++t) {
+            kept += !this->dead [t];
+        }
+        triangle_bases [first / RANGE_GRAIN + 1] = kept;
+    });
+    for (size_t range = 0; range < vertex_ranges; ++range) {
+        vertex_bases [range + 1] += vertex_bases [range];
+    }
+    for (size_t range = 0; range < triangle_ranges; ++range) {
+        triangle_bases [range + 1] += triangle_bases [range];
+    }
+
+    // merged_into becomes the new id of every kept vertex.
+    std::vector <Vertex> kept_vertices (vertex_bases [vertex_ranges]);
+    std::vector <Quadric> kept_quadrics (vertex_bases [vertex_ranges]);
+    parallel_for (this->executor, this->concurrency, vertex_count, RANGE_GRAIN, [&] (size_t first, size_t last, unsigned int) {
+        size_t next = vertex_bases [first / RANGE_GRAIN];
+        for (size_t v = first; v < last; ++v) {
+            if (this->merged_into [v] == v) {
+                this->merged_into [v] = static_cast <uint32_t> (next);
+                kept_vertices [next] = this->vertices [v];
+                kept_quadrics [next++] = this->quadrics [v];
+            }
+        }
+    });
+
+    std::vector <uint32_t> kept_indices (3 * triangle_bases [triangle_ranges]);
+    parallel_for (this->executor, this->concurrency, triangle_count, RANGE_GRAIN, [&] (size_t first, size_t last, unsigned int) {
+        size_t next = triangle_bases [first / RANGE_GRAIN];
+        for (size_t t = first; t < last; ++t) {
+            if (!this->dead [t]) {
+                for (int corner = 0; corner < 3; ++corner) {
+                    kept_indices [3 * next + corner] = this->merged_into [this->indices [3 * t + corner]];
+                }
+                ++next;
+            }
+        }
+    });
+
+    this->vertices.swap (kept_vertices);
+    this->quadrics.swap (kept_quadrics);
+    this->indices.swap (kept_indices);
+}
+
+}
+
+MeshSimplifyStats simplify_mesh (Mesh& mesh, const MeshSimplifySettings& settings) {
+    if (!(settings.max_error >= 0.0f)) {
+        throw std::runtime_error {"[simplify_mesh]: max_error must be >= 0"};
+    }
+    if (mesh.get_vertices ().size () >= std::numeric_limits <uint32_t>::max ()
+        || mesh.get_indices ().size () >= std::numeric_limits <uint32_t>::max ()) {
+        throw std::runtime_error {"[simplify_mesh]: mesh too large"};
+    }
+
+    Executor& executor = settings.get_executor ();
+    const unsigned int concurrency = static_cast <unsigned int> (std::max (1, settings.max_threads));
+    Simplifier simplifier (mesh, settings, executor, concurrency);
+
+    MeshSimplifyStats stats;
+    stats.triangles_before = simplifier.triangle_count ();
+    size_t idle_passes = 0;
+    while (simplifier.triangle_count () > settings.target_triangles && stats.passes < MAX_PASSES && idle_passes < 2) {
+        // Every collapse removes two triangles.
+        const size_t needed = (simplifier.triangle_count () - settings.target_triangles + 1) / 2;
+        simplifier.begin_pass (stats.passes);
+        const size_t collapses = simplifier.collapse_pass (needed);
+        simplifier.compact ();
+        idle_passes = collapses == 0 ? idle_passes + 1 : 0;
+        ++stats.passes;
+    }
+
+    stats.triangles_after = simplifier.triangle_count ();
+    stats.vertices_after = mesh.get_vertices ().size ();
+    stats.max_error = std::sqrt (simplifier.largest_cost ());
+    return stats;
+}
+
+}
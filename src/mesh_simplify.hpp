@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+
+#include "executor.hpp"
+#include "mesh.hpp"
+
+namespace sdf_raster {
+
+struct MeshSimplifySettings : ParallelSettings {
+  size_t target_triangles = 0;  // stop once the mesh has at most this many triangles
+  float max_error = std::numeric_limits <float>::infinity (); // largest RMS distance (mesh units) a vertex may move off its original planes
+};
+
+struct MeshSimplifyStats {
+  size_t triangles_before = 0;
+  size_t triangles_after = 0;
+  size_t vertices_after = 0;
+  size_t passes = 0;
+  float max_error = 0.0f;       // largest RMS distance of a collapse that was made
+};
+
+// Quadric error edge collapse (Garland and Heckbert): every vertex carries the area weighted planes of the triangles
+// it was built from, and the edge whose merged vertex stays closest to those planes collapses first. Collapses that
+// would fold a triangle over or pinch the surface into a non-manifold one are skipped; vertices on open borders never
+// move.
+//
+// Collapses run in passes. Each pass bins the vertices into a grid of cells of a few thousand triangles and locks
+// every vertex with a triangle reaching into another cell, so the cells share nothing they modify and run in
+// parallel. Every free vertex offers its cheapest valid edge, the cells split the pass's collapses in proportion to
+// their share of the cheapest offers of the whole mesh, and each cell makes its cheapest offers first with every
+// vertex in one collapse at most (an independent set, so no cost goes stale within the pass). The grid is shifted by
+// half a cell every other pass to free the locked vertices. The cells only depend on the mesh, so the result is the
+// same for any max_threads.
+//
+// Stops at target_triangles, when no edge within max_error is left, or when passes stop making progress. Vertices
+// keep their color; the normals of merged vertices are averaged.
+MeshSimplifyStats simplify_mesh (Mesh& mesh, const MeshSimplifySettings& settings);
+
+}
@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "mesh_export.hpp"
+#include "mesh_stream.hpp"
+
+namespace sdf_raster {
+
+FileMeshSink::FileMeshSink (const std::string& a_filename)
+    : filename (a_filename) {
+    const MeshFileFormat format = mesh_file_format (a_filename);
+    if (format != MeshFileFormat::Obj && format != MeshFileFormat::Stl) {
+        throw std::runtime_error {"[FileMeshSink]: only .obj and .stl can be streamed: " + a_filename};
+    }
+    this->stl = format == MeshFileFormat::Stl;
+}
+
+void FileMeshSink::begin () {
+    printf ("Streaming mesh to '%s'...\n", this->filename.c_str ());
+    this->out.open (this->filename, std::ios::binary);
+    if (!this->out) {
+        throw std::runtime_error {"[FileMeshSink]: failed to open file: " + this->filename};
+    }
+    this->triangle_count = 0;
+
+    if (this->stl) {
+        // Header and a triangle count that end () fills in.
+        char header [84] = {};
+        std::strncpy (header, "sdf_raster binary STL", 80);
+        this->out.write (header, sizeof (header));
+    }
+}
+
+void FileMeshSink::write (const MeshChunk& chunk) {
+    this->buffer.clear ();
+    if (this->stl) {
+        append_stl_triangles (this->buffer, chunk.vertices, chunk.indices, chunk.index_count / 3);
+    } else {
+        append_obj_vectors (this->buffer, chunk.vertices, chunk.vertex_count, false);
+        append_obj_vectors (this->buffer, chunk.vertices, chunk.vertex_count, true);
+        append_obj_faces (this->buffer, chunk.indices, chunk.index_count / 3, chunk.vertex_base);
+    }
+    this->triangle_count += chunk.index_count / 3;
+
+    this->out.write (this->buffer.data (), static_cast <std::streamsize> (this->buffer.size ()));
+    if (!this->out) {
+        throw std::runtime_error {"[FileMeshSink]: write failed: " + this->filename};
+    }
+}
+
+void FileMeshSink::end () {
+    if (this->stl) {
+        if (this->triangle_count > std::numeric_limits <uint32_t>::max ()) {
+            throw std::runtime_error {"[FileMeshSink]: too many triangles for STL: " + this->filename};
+        }
+        const uint32_t count = static_cast <uint32_t> (this->triangle_count);
+        this->out.seekp (80);
+        this->out.write (reinterpret_cast <const char*> (&count), sizeof (count));
+    }
+    this->out.close ();
+    if (!this->out) {
+        throw std::runtime_error {"[FileMeshSink]: write failed: " + this->filename};
+    }
+    printf ("Streamed %u triangles to '%s'.\n", (unsigned) this->triangle_count, this->filename.c_str ());
+}
+
+RingBufferMeshSink::RingBufferMeshSink (size_t capacity)
+    : slots (std::max <size_t> (capacity, 1)) {
+}
+
+void RingBufferMeshSink::begin () {
+    std::lock_guard <std::mutex> lock (this->mutex);
+    this->head = 0;
+    this->count = 0;
+    this->closed = false;
+    this->failed = false;
+}
+
+void RingBufferMeshSink::write (const MeshChunk& chunk) {
+    std::unique_lock <std::mutex> lock (this->mutex);
+    this->condition.wait (lock, [this] { return this->count < this->slots.size () || this->closed; });
+    if (this->closed) {
+        return;
+    }
+
+    MeshChunkData& slot = this->slots [(this->head + this->count) % this->slots.size ()];
+    slot.index = chunk.index;
+    slot.vertex_base = chunk.vertex_base;
+    slot.vertices.assign (chunk.vertices, chunk.vertices + chunk.vertex_count);
+    slot.indices.assign (chunk.indices, chunk.indices + chunk.index_count);
+    ++this->count;
+    this->condition.notify_all ();
+}
+
+void RingBufferMeshSink::end () {
+    std::lock_guard <std::mutex> lock (this->mutex);
+    this->closed = true;
+    this->condition.notify_all ();
+}
+
+void RingBufferMeshSink::abort () {
+    std::lock_guard <std::mutex> lock (this->mutex);
+    this->closed = true;
+    this->failed = true;
+    this->condition.notify_all ();
+}
+
+bool RingBufferMeshSink::pop (MeshChunkData& chunk) {
+    std::unique_lock <std::mutex> lock (this->mutex);
+    this->condition.wait (lock, [this] { return this->count > 0 || this->closed; });
+    if (this->count == 0) {
+        return false;
+    }
+
+    MeshChunkData& slot = this->slots [this->head];
+    chunk.index = slot.index;
+    chunk.vertex_base = slot.vertex_base;
+    std::swap (chunk.vertices, slot.vertices);
+    std::swap (chunk.indices, slot.indices);
+    this->head = (this->head + 1) % this->slots.size ();
+    --this->count;
+    this->condition.notify_all ();
+    return true;
+}
+
+bool RingBufferMeshSink::aborted () const {
+    std::lock_guard <std::mutex> lock (this->mutex);
+    return this->failed;
+}
+
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "mesh.hpp"
+
+namespace sdf_raster {
+
+// One finished piece of a streamed mesh. Chunks reach the sink in `index` order; indices are local to the chunk and
+// refer to the global vertex vertex_base + index. The pointers are only valid during MeshSink::write.
+struct MeshChunk {
+  size_t index = 0;
+  size_t vertex_base = 0;
+  const Vertex* vertices = nullptr;
+  size_t vertex_count = 0;
+  const uint32_t* indices = nullptr;
+  size_t index_count = 0;
+};
+
+// Receives a streamed mesh: begin (), write () for every non-empty chunk in order, then end () on success or abort ()
+// when extraction failed. Calls never overlap, but may come from different threads. A write that blocks holds back
+// extraction once the stream's memory cap is reached.
+class MeshSink {
+public:
+  virtual ~MeshSink () = default;
+
+  virtual void begin () {}
+  virtual void write (const MeshChunk& chunk) = 0;
+  virtual void end () {}
+  virtual void abort () {}
+};
+
+class CallbackMeshSink : public MeshSink {
+public:
+  explicit CallbackMeshSink (std::function <void (const MeshChunk&)> a_callback) : callback (std::move (a_callback)) {}
+
+  void write (const MeshChunk& chunk) override { this->callback (chunk); }
+
+private:
+  std::function <void (const MeshChunk&)> callback;
+};
+
+// Streams to an .obj file (vertices and faces interleaved chunk by chunk) or a binary .stl file (triangle count
+// patched in by end ()). Formats that need all vertices before the first face (PLY, GLB) cannot be streamed.
+class FileMeshSink : public MeshSink {
+public:
+  explicit FileMeshSink (const std::string& filename);
+
+  void begin () override;
+  void write (const MeshChunk& chunk) override;
+  void end () override;
+
+private:
+  std::string filename;
+  bool stl = false;
+  std::ofstream out;
+  std::vector <char> buffer;
+  size_t triangle_count = 0;
+};
+
+// Copy of a chunk owned by its reader.
+struct MeshChunkData {
+  size_t index = 0;
+  size_t vertex_base = 0;
+  std::vector <Vertex> vertices;
+  std::vector <uint32_t> indices;
+};
+
+// Bounded queue of chunks between the extraction and a consumer thread. write () blocks while all `capacity` slots
+// are full, which stalls extraction; slot storage is swapped with the consumer's, so buffers circulate instead of
+// being reallocated.
+class RingBufferMeshSink : public MeshSink {
+public:
+  explicit RingBufferMeshSink (size_t capacity);
+
+  void begin () override;
+  void write (const MeshChunk& chunk) override;
+  void end () override;
+  void abort () override;
+
+  // Blocks until a chunk is available and swaps it into `chunk`. Returns false once the stream has ended (or was
+  // aborted) and every chunk has been read.
+  bool pop (MeshChunkData& chunk);
+
+  bool aborted () const;
+
+private:
+  std::vector <MeshChunkData> slots;
+  size_t head = 0;  // next slot to read
+  size_t count = 0; // slots holding a chunk
+  bool closed = false;
+  bool failed = false;
+  mutable std::mutex mutex;
+  std::condition_variable condition;
+};
+
+struct MeshStreamSettings {
+  size_t memory_cap = size_t {256} << 20; // bytes of finished chunks waiting for the sink before workers stall
+  unsigned int chunk_depth = 4;           // chunks are the octree subtrees at this depth, up to 8^depth of them
+};
+
+struct MeshStreamStats {
+  size_t chunks = 0;               // chunks written to the sink
+  size_t vertices = 0;
+  size_t triangles = 0;
+  size_t peak_buffered_bytes = 0;  // most bytes of finished chunks waiting at once
+  size_t stalls = 0;               // times a worker waited for the memory cap
+};
+
+}
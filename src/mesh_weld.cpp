@@ -0,0 +1,384 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+#include "mesh_weld.hpp"
+
+namespace sdf_raster {
+
+void VertexKeyTable::grow () {
+    std::vector <uint64_t> old_keys (std::max <size_t> (64, 2 * this->keys.size ()), EMPTY_VERTEX_KEY);
+    std::vector <uint32_t> old_values (old_keys.size ());
+    std::swap (old_keys, this->keys);
+    std::swap (old_values, this->values);
+
+    const size_t mask = this->keys.size () - 1;
+    for (size_t i = 0; i < old_keys.size (); ++i) {
+        if (old_keys [i] == EMPTY_VERTEX_KEY) {
+            continue;
+        }
+        size_t slot = hash_vertex_key (old_keys [i]) & mask;
+        while (this->keys [slot] != EMPTY_VERTEX_KEY) {
+            slot = (slot + 1) & mask;
+        }
+        this->keys [slot] = old_keys [i];
+        this->values [slot] = old_values [i];
+    }
+}
+
+void VertexKeyTable::clear () {
+    std::fill (this->keys.begin (), this->keys.end (), EMPTY_VERTEX_KEY);
+    this->count = 0;
+}
+
+void weld_vertices (ThreadMesh& output, const Vertex* vertices, const uint64_t* keys, size_t count) {
+    Mesh& mesh = output.mesh;
+    for (size_t i = 0; i < count; ++i) {
+        bool inserted = false;
+        uint32_t& index = output.vertex_table.find_or_insert (keys [i], inserted);
+        if (inserted) {
+            index = static_cast <uint32_t> (mesh.get_vertices ().size ());
+            mesh.get_mutable_vertices ().push_back (vertices [i]);
+            output.vertex_keys.push_back (keys [i]);
+        }
+        mesh.get_mutable_indices ().push_back (index);
+    }
+}
+
+// Welds the per-thread meshes into one. Every thread inserts the keys of its vertices into a shared lock-free table
+// and the lowest thread index holding a key owns that vertex, so the result only depends on what each thread mesh
+// contains, not on timing. Owned vertices get consecutive ids in thread order, then every thread rewrites its
+// indices through the table. Only vertices on the borders between thread meshes are ever inserted twice.
+Mesh merge_welded_meshes (std::vector <ThreadMesh>& thread_meshes
+                          , Executor& executor
+                          , unsigned int concurrency
+                          , ScratchArena& arena
+                          , ScratchVector <uint64_t>* merged_keys) {
+    // No ScratchScope: merged_keys may live in the same arena and grows below.
+    const size_t thread_count = thread_meshes.size ();
+
+    // vertex_slots holds the table slot of every thread mesh vertex, thread t's from key_bases [t] on.
+    ScratchVector <size_t> key_bases (thread_count + 1, 0, &arena);
+    for (size_t t = 0; t < thread_count; ++t) {
+        key_bases [t + 1] = key_bases [t] + thread_meshes [t].vertex_keys.size ();
+    }
+    const size_t total_vertices = key_bases [thread_count];
+
+    size_t capacity = 64;
+    while (capacity < 2 * total_vertices) {
+        capacity *= 2;
+    }
+    const size_t mask = capacity - 1;
+    std::atomic <uint64_t>* slot_keys = allocate_scratch_array <std::atomic <uint64_t>> (arena, capacity);
+    std::atomic <uint32_t>* slot_owners = allocate_scratch_array <std::atomic <uint32_t>> (arena, capacity);
+    uint32_t* slot_ids = allocate_scratch_array <uint32_t> (arena, capacity);
+    uint32_t* vertex_slots = allocate_scratch_array <uint32_t> (arena, total_vertices);
+
+    ScratchVector <size_t> vertex_bases (thread_count + 1, 0, &arena);
+    ScratchVector <size_t> index_bases (thread_count + 1, 0, &arena);
+
+    std::vector <Vertex> vertices;
+    std::vector <uint32_t> indices;
+
+    constexpr size_t clear_grain = 1 << 16;
+    parallel_for (executor, concurrency, capacity, clear_grain, [&] (size_t first, size_t last, unsigned int) {
+        for (size_t slot = first; slot < last; ++slot) {
+            slot_keys [slot].store (EMPTY_VERTEX_KEY, std::memory_order_relaxed);
+            slot_owners [slot].store (~0u, std::memory_order_relaxed);
+        }
+    });
+
+    parallel_for (executor, concurrency, thread_count, 1, [&] (size_t first, size_t last, unsigned int) {
+        for (size_t t = first; t < last; ++t) {
+            const auto& keys = thread_meshes [t].vertex_keys;
+            uint32_t* thread_slots = vertex_slots + key_bases [t];
+
+            for (size_t v = 0; v < keys.size (); ++v) {
+                size_t slot = hash_vertex_key (keys [v]) & mask;
+                while (true) {
+                    uint64_t expected = EMPTY_VERTEX_KEY;
+                    if (slot_keys [slot].compare_exchange_strong (expected, keys [v], std::memory_order_relaxed) || expected == keys [v]) {
+                        break;
+                    }
+                    slot = (slot + 1) & mask;
+                }
+                thread_slots [v] = static_cast <uint32_t> (slot);
+
+                uint32_t owner = slot_owners [slot].load (std::memory_order_relaxed);
+                while (owner > t && !slot_owners [slot].compare_exchange_weak (owner, static_cast <uint32_t> (t), std::memory_order_relaxed)) {
+                }
+            }
+            index_bases [t + 1] = thread_meshes [t].mesh.get_indices ().size ();
+        }
+    });
+
+    parallel_for (executor, concurrency, thread_count, 1, [&] (size_t first, size_t last, unsigned int) {
+        for (size_t t = first; t < last; ++t) {
+            size_t owned_count = 0;
+            for (size_t v = key_bases [t]; v < key_bases [t + 1]; ++v) {
+                owned_count += slot_owners [vertex_slots [v]].load (std::memory_order_relaxed) == t;
+            }
+            vertex_bases [t + 1] = owned_count;
+        }
+    });
+
+    for (size_t t = 0; t < thread_count; ++t) {
+        vertex_bases [t + 1] += vertex_bases [t];
+        index_bases [t + 1] += index_bases [t];
+    }
+    vertices.resize (vertex_bases [thread_count]);
+    indices.resize (index_bases [thread_count]);
+    if (merged_keys != nullptr) {
+        merged_keys->resize (vertex_bases [thread_count]);
+    }
+
+    parallel_for (executor, concurrency, thread_count, 1, [&] (size_t first, size_t last, unsigned int) {
+        for (size_t t = first; t < last; ++t) {
+            const auto& local_vertices = thread_meshes [t].mesh.get_vertices ();
+            const uint32_t* thread_slots = vertex_slots + key_bases [t];
+            size_t next_id = vertex_bases [t];
+            for (size_t v = 0; v < local_vertices.size (); ++v) {
+                const uint32_t slot = thread_slots [v];
+                if (slot_owners [slot].load (std::memory_order_relaxed) == t) {
+                    slot_ids [slot] = static_cast <uint32_t> (next_id);
+                    if (merged_keys != nullptr) {
+                        (*merged_keys) [next_id] = thread_meshes [t].vertex_keys [v];
+                    }
+                    vertices [next_id++] = local_vertices [v];
+                }
+            }
+        }
+    });
+
+    parallel_for (executor, concurrency, thread_count, 1, [&] (size_t first, size_t last, unsigned int) {
+        for (size_t t = first; t < last; ++t) {
+            const auto& local_indices = thread_meshes [t].mesh.get_indices ();
+            const uint32_t* thread_slots = vertex_slots + key_bases [t];
+            for (size_t i = 0; i < local_indices.size (); ++i) {
+                indices [index_bases [t] + i] = slot_ids [thread_slots [local_indices [i]]];
+            }
+        }
+    });
+
+    return Mesh (std::move (indices), std::move (vertices));
+}
+
+Mesh concatenate_meshes (std::vector <ThreadMesh>& thread_meshes, Executor& executor, unsigned int concurrency, ScratchArena& arena) {
+    const ScratchScope scope (arena);
+    const size_t thread_count = thread_meshes.size ();
+    ScratchVector <size_t> vertex_bases (thread_count + 1, 0, &arena);
+    ScratchVector <size_t> index_bases (thread_count + 1, 0, &arena);
+    for (size_t t = 0; t < thread_count; ++t) {
+        vertex_bases [t + 1] = vertex_bases [t] + thread_meshes [t].mesh.get_vertices ().size ();
+        index_bases [t + 1] = index_bases [t] + thread_meshes [t].mesh.get_indices ().size ();
+    }
+
+    std::vector <Vertex> vertices (vertex_bases [thread_count]);
+    std::vector <uint32_t> indices (index_bases [thread_count]);
+
+    parallel_for (executor, concurrency, thread_count, 1, [&] (size_t first, size_t last, unsigned int) {
+        for (size_t t = first; t < last; ++t) {
+            const Mesh& mesh = thread_meshes [t].mesh;
+            std::copy (mesh.get_vertices ().begin (), mesh.get_vertices ().end (), vertices.begin () + vertex_bases [t]);
+            for (size_t i = 0; i < mesh.get_indices ().size (); ++i) {
+                indices [index_bases [t] + i] = static_cast <uint32_t> (vertex_bases [t] + mesh.get_indices () [i]);
+            }
+        }
+    });
+
+    return Mesh (std::move (indices), std::move (vertices));
+}
+
+// Sorts through scratch copies and writes back in place, so the mesh keeps its buffers.
+void canonicalize_welded_mesh (Mesh& mesh, const ScratchVector <uint64_t>& keys, ScratchArena& arena) {
+    const ScratchScope scope (arena);
+    auto& vertices = mesh.get_mutable_vertices ();
+    ScratchVector <uint32_t> order (vertices.size (), &arena);
+    for (size_t i = 0; i < order.size (); ++i) {
+        order [i] = static_cast <uint32_t> (i);
+    }
+    std::sort (order.begin (), order.end (), [&] (uint32_t a, uint32_t b) { return keys [a] < keys [b]; });
+
+    ScratchVector <Vertex> sorted_vertices (vertices.size (), &arena);
+    ScratchVector <uint32_t> new_ids (vertices.size (), &arena);
+    for (size_t i = 0; i < order.size (); ++i) {
+        sorted_vertices [i] = vertices [order [i]];
+        new_ids [order [i]] = static_cast <uint32_t> (i);
+    }
+    std::copy (sorted_vertices.begin (), sorted_vertices.end (), vertices.begin ());
+
+    auto& indices = mesh.get_mutable_indices ();
+    ScratchVector <std::array <uint32_t, 3>> triangles (indices.size () / 3, &arena);
+    for (size_t t = 0; t < triangles.size (); ++t) {
+        triangles [t] = {new_ids [indices [3 * t]], new_ids [indices [3 * t + 1]], new_ids [indices [3 * t + 2]]};
+    }
+    std::sort (triangles.begin (), triangles.end ());
+
+    for (size_t t = 0; t < triangles.size (); ++t) {
+        std::copy (triangles [t].begin (), triangles [t].end (), indices.begin () + 3 * t);
+    }
+}
+
+namespace {
+
+// Vertices per hash bucket on average: a bucket and its weld table stay in the L2 cache.
+constexpr size_t WELD_BUCKET_SIZE = 4096;
+
+struct WeldItem {
+  WeldKey key;
+  uint32_t index;
+};
+
+// Fills remap (old index to new) and welded (kept vertices) for weld_mesh, bucket by bucket on the executor.
+void weld_bucketed (
+        const std::vector <Vertex>& vertices
+        , float inverse_tolerance
+        , Executor& executor
+        , unsigned int concurrency
+        , std::vector <uint32_t>& remap
+        , std::vector <Vertex>& welded) {
+    const size_t vertex_count = vertices.size ();
+
+    // Vertex ranges of the scatter: few enough that the per-range bucket counts stay small.
+    const size_t range_count = std::min ((vertex_count + (1 << 16) - 1) >> 16, 4 * static_cast <size_t> (concurrency));
+    const size_t range_size = (vertex_count + range_count - 1) / range_count;
+    unsigned int bucket_bits = 0;
+    while ((size_t {1} << bucket_bits) * WELD_BUCKET_SIZE < vertex_count) {
+        ++bucket_bits;
+    }
+    const size_t bucket_count = size_t {1} << bucket_bits;
+    auto bucket_of = [bucket_bits] (const WeldKey& key) {
+        return bucket_bits == 0 ? size_t {0} : static_cast <size_t> (hash_weld_key (key) >> (64 - bucket_bits));
+    };
+
+    // Keys and per-range bucket counts; offsets [bucket * range_count + range] then becomes where the range's items
+    // of that bucket go, so each bucket lists its vertices in index order.
+    std::vector <WeldKey> keys (vertex_count);
+    std::vector <size_t> offsets (bucket_count * range_count + 1, 0);
+    parallel_for (executor, concurrency, vertex_count, range_size, [&] (size_t first, size_t last, unsigned int) {
+        const size_t range = first / range_size;
+        for (size_t i = first; i < last; ++i) {
+            keys [i] = make_weld_key (vertices [i].position, inverse_tolerance);
+            ++offsets [bucket_of (keys [i]) * range_count + range];
+        }
+    });
+    size_t total = 0;
+    for (size_t& offset : offsets) {
+        const size_t count = offset;
+        offset = total;
+        total += count;
+    }
+
+    std::vector <WeldItem> items (vertex_count);
+    parallel_for (executor, concurrency, vertex_count, range_size, [&] (size_t first, size_t last, unsigned int) {
+        const size_t range = first / range_size;
+        for (size_t i = first; i < last; ++i) {
+            items [offsets [bucket_of (keys [i]) * range_count + range]++] = {keys [i], static_cast <uint32_t> (i)};
+        }
+    });
+    std::vector <WeldKey> ().swap (keys);
+
+    // After the scatter, offsets [bucket * range_count + range_count - 1] is the end of the bucket. A bucket lists its
+    // vertices in index order, so the first one to claim a key in the bucket's table is the first of its group.
+    std::vector <uint32_t> representative (vertex_count);
+    std::vector <PositionWeldTable> tables (concurrency);
+    parallel_for (executor, concurrency, bucket_count, 16, [&] (size_t first, size_t last, unsigned int slot) {
+        PositionWeldTable& table = tables [slot];
+        for (size_t bucket = first; bucket < last; ++bucket) {
+            const size_t begin = bucket == 0 ? 0 : offsets [bucket * range_count - 1];
+            const size_t end = offsets [(bucket + 1) * range_count - 1];
+            table.clear ();
+            for (size_t i = begin; i < end; ++i) {
+                bool inserted = false;
+                uint32_t& first_index = table.find_or_insert (items [i].key, inserted);
+                if (inserted) {
+                    first_index = items [i].index;
+                }
+                representative [items [i].index] = first_index;
+            }
+        }
+    });
+    std::vector <WeldItem> ().swap (items);
+
+    // Kept vertices get consecutive ids in index order: count per range, prefix sum, assign.
+    std::vector <size_t> kept_bases (range_count + 1, 0);
+    parallel_for (executor, concurrency, vertex_count, range_size, [&] (size_t first, size_t last, unsigned int) {
+        size_t kept = 0;
+        for (size_t i = first; i < last; ++i) {
+            kept += representative [i] == i;
+        }
+        kept_bases [first / range_size + 1] = kept;
+    });
+    for (size_t range = 0; range < range_count; ++range) {
+        kept_bases [range + 1] += kept_bases [range];
+    }
+
+    welded.resize (kept_bases [range_count]);
+    parallel_for (executor, concurrency, vertex_count, range_size, [&] (size_t first, size_t last, unsigned int) {
+        size_t next_id = kept_bases [first / range_size];
+        for (size_t i = first; i < last; ++i) {
+            if (representative [i] == i) {
+                remap [i] = static_cast <uint32_t> (next_id);
+                welded [next_id++] = vertices [i];
+            }
+        }
+    });
+    parallel_for (executor, concurrency, vertex_count, range_size, [&] (size_t first, size_t last, unsigned int) {
+        for (size_t i = first; i < last; ++i) {
+            if (representative [i] != i) {
+                remap [i] = remap [representative [i]];
+            }
+        }
+    });
+}
+
+}
+
+void weld_mesh (Mesh& mesh, const MeshWeldSettings& settings) {
+    if (!(settings.tolerance >= 0.0f)) {
+        throw std::runtime_error {"[weld_mesh]: tolerance must be >= 0"};
+    }
+    const auto& vertices = mesh.get_vertices ();
+    const size_t vertex_count = vertices.size ();
+    if (vertex_count >= std::numeric_limits <uint32_t>::max ()) {
+        throw std::runtime_error {"[weld_mesh]: too many vertices"};
+    }
+    if (vertex_count == 0) {
+        return;
+    }
+
+    Executor& executor = settings.get_executor ();
+    const unsigned int concurrency = static_cast <unsigned int> (std::max (1, settings.max_threads));
+    const float inverse_tolerance = settings.tolerance > 0.0f ? 1.0f / settings.tolerance : 0.0f;
+
+    std::vector <uint32_t> remap (vertex_count);
+    std::vector <Vertex> welded;
+    if (concurrency == 1 || vertex_count <= WELD_BUCKET_SIZE) {
+        // On one thread a single table over all vertices beats scattering them into buckets first.
+        PositionWeldTable table;
+        for (size_t i = 0; i < vertex_count; ++i) {
+            bool inserted = false;
+            uint32_t& id = table.find_or_insert (make_weld_key (vertices [i].position, inverse_tolerance), inserted);
+            if (inserted) {
+                id = static_cast <uint32_t> (welded.size ());
+                welded.push_back (vertices [i]);
+            }
+            remap [i] = id;
+        }
+    } else {
+        weld_bucketed (vertices, inverse_tolerance, executor, concurrency, remap, welded);
+    }
+
+    auto& indices = mesh.get_mutable_indices ();
+    parallel_for (executor, concurrency, indices.size (), 1 << 16, [&] (size_t first, size_t last, unsigned int) {
+        for (size_t i = first; i < last; ++i) {
+            indices [i] = remap [indices [i]];
+        }
+    });
+    mesh.get_mutable_vertices ().swap (welded);
+}
+
+}
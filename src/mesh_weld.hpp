@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "executor.hpp"
+#include "mesh.hpp"
+#include "scratch_arena.hpp"
+
+namespace sdf_raster {
+
+constexpr uint64_t EMPTY_VERTEX_KEY = ~0ull;
+
+inline uint64_t hash_vertex_key (uint64_t key) {
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ull;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebull;
+    key ^= key >> 31;
+    return key;
+}
+
+// Linear-probing map from a vertex key to a vertex index, private to one thread during extraction.
+class VertexKeyTable {
+public:
+  // Returns the slot holding `key`; `inserted` tells whether it was just added and still needs its value.
+  uint32_t& find_or_insert (uint64_t key, bool& inserted) {
+      if (2 * (this->count + 1) > this->keys.size ()) {
+          this->grow ();
+      }
+
+      const size_t mask = this->keys.size () - 1;
+      for (size_t slot = hash_vertex_key (key) & mask; ; slot = (slot + 1) & mask) {
+          if (this->keys [slot] == key) {
+              inserted = false;
+              return this->values [slot];
+          }
+          if (this->keys [slot] == EMPTY_VERTEX_KEY) {
+              this->keys [slot] = key;
+              ++this->count;
+              inserted = true;
+              return this->values [slot];
+          }
+      }
+  }
+
+  // Forgets every key but keeps the table's storage.
+  void clear ();
+
+  size_t capacity () const { return this->keys.size (); }
+
+private:
+  void grow ();
+
+  std::vector <uint64_t> keys;
+  std::vector <uint32_t> values;
+  size_t count = 0;
+};
+
+// Output of one extraction thread. Welding extractors name every vertex by a key that is the same for all threads
+// producing it (an octree edge, a pair of leaves, ...), so thread meshes can be welded into one afterwards.
+struct ThreadMesh {
+  Mesh mesh;
+  std::vector <uint64_t> vertex_keys; // welding only: key of every vertex
+  VertexKeyTable vertex_table;        // welding only
+  bool too_deep = false;              // set by extractors whose keys cannot address a leaf
+};
+
+// Appends soup vertices to a thread-local welded mesh: the first vertex seen for a key is kept.
+void weld_vertices (ThreadMesh& output, const Vertex* vertices, const uint64_t* keys, size_t count);
+
+// Welds the thread meshes into one indexed mesh, `concurrency` threads at most; the result depends on their
+// contents, not on timing. `merged_keys`, when set, receives the key of every output vertex. Temporaries come from
+// `arena`, which only the calling thread may use meanwhile.
+Mesh merge_welded_meshes (std::vector <ThreadMesh>& thread_meshes
+                          , Executor& executor
+                          , unsigned int concurrency
+                          , ScratchArena& arena
+                          , ScratchVector <uint64_t>* merged_keys = nullptr);
+
+// Joins per-thread triangle soups in thread order, copying them in parallel.
+Mesh concatenate_meshes (std::vector <ThreadMesh>& thread_meshes, Executor& executor, unsigned int concurrency, ScratchArena& arena);
+
+// Orders vertices by key and triangles by their vertex ids, which removes every trace of the task schedule.
+void canonicalize_welded_mesh (Mesh& mesh, const ScratchVector <uint64_t>& keys, ScratchArena& arena);
+
+struct MeshWeldSettings : ParallelSettings {
+  float tolerance = 0.0f;       // lattice spacing of the weld keys (see position_weld.hpp); 0 welds identical positions
+};
+
+// Merges the vertices of `mesh` whose positions share a weld key, for meshes put together without welding (soups,
+// concatenated parts, imported files). Every group keeps its first vertex, kept vertices stay in their order and
+// indices are rewritten, so the result is what add_vertex gives for the vertices in order, for any max_threads.
+//
+// Vertices are scattered into buckets by key hash and every bucket is welded with its own cache-sized table, so each
+// step is a parallel pass over vertices, buckets or indices. On one thread a single table is used instead.
+void weld_mesh (Mesh& mesh, const MeshWeldSettings& settings = {});
+
+}
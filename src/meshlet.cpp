@@ -0,0 +1,557 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#include "mesh_chunks.hpp"
+#include "meshlet.hpp"
+#include "vk_buffers.h"
+
+namespace sdf_raster {
+
+namespace {
+
+// Triangles per chunk clustered as one task: enough work for a task, and only a few of its ~180 meshlets are cut
+// short at the chunk borders.
+constexpr size_t CHUNK_TRIANGLES = 16384;
+constexpr uint32_t NONE = ~0u;
+constexpr char MESHLETS_MAGIC [4] = {'M', 'L', 'T', '1'};
+
+LiteMath::float3 triangle_cross (const LiteMath::float3& a, const LiteMath::float3& b, const LiteMath::float3& c) {
+    return LiteMath::cross (b - a, c - a);
+}
+
+// Meshlets of one chunk, offsets relative to the chunk's own vertices and triangles.
+struct ChunkMeshlets {
+  std::vector <Meshlet> meshlets;
+  std::vector <uint32_t> vertices;
+  std::vector <uint32_t> triangles;
+};
+
+// State of the chunk being clustered, on top of its triangles and vertices.
+struct ChunkScratch : TriangleChunk {
+  std::vector <uint32_t> live;              // triangles around the vertex not in a meshlet yet
+  std::vector <uint32_t> local;             // id in the current meshlet, valid when local_stamp matches
+  std::vector <uint32_t> local_stamp;
+  std::vector <uint32_t> queued;            // meshlet that last queued the triangle as a candidate
+  std::vector <uint8_t> emitted;
+  std::vector <uint32_t> meshlet_vertices;  // chunk vertices of the current meshlet
+  std::vector <uint32_t> candidates;
+};
+
+class MeshletBuilder {
+public:
+  MeshletBuilder (const Mesh& mesh, const MeshletSettings& settings, Executor& executor, unsigned int concurrency)
+      : mesh (mesh)
+      , vertices (mesh.get_vertices ())
+      , indices (mesh.get_indices ())
+      , settings (settings)
+      , executor (executor)
+      , concurrency (concurrency)
+      , scratch (concurrency) {}
+
+  Meshlets build ();
+
+private:
+  size_t triangle_count () const { return this->indices.size () / 3; }
+
+  void load_chunk (size_t first, size_t last, ChunkScratch& scratch) const;
+  void cluster_chunk (size_t chunk, ChunkScratch& scratch, ChunkMeshlets& out) const;
+
+  const Mesh& mesh;
+  const std::vector <Vertex>& vertices;
+  const std::vector <uint32_t>& indices;
+  const MeshletSettings& settings;
+  Executor& executor;
+  unsigned int concurrency;
+  std::vector <ChunkScratch> scratch;
+
+  std::vector <LiteMath::float3> centroids; // in curve order
+  std::vector <uint32_t> order;             // triangles along the Morton curve
+};
+
+void MeshletBuilder::load_chunk (size_t first, size_t last, ChunkScratch& scratch) const {
+    const size_t triangle_count = last - first;
+    scratch.load (this->mesh, this->order.data () + first, triangle_count);
+
+    const size_t vertex_count = scratch.vertex_count ();
+    scratch.live.resize (vertex_count);
+    for (size_t v = 0; v < vertex_count; ++v) {
+        scratch.live [v] = scratch.degree (static_cast <uint32_t> (v));
+    }
+    scratch.local.resize (vertex_count);
+    scratch.local_stamp.assign (vertex_count, 0);
+    scratch.queued.assign (triangle_count, 0);
+    scratch.emitted.assign (triangle_count, 0);
+}
+
+void MeshletBuilder::cluster_chunk (size_t chunk, ChunkScratch& scratch, ChunkMeshlets& out) const {
+    const size_t first = chunk * CHUNK_TRIANGLES;
+    const size_t last = std::min (first + CHUNK_TRIANGLES, this->triangle_count ());
+    const uint32_t triangle_count = static_cast <uint32_t> (last - first);
+    const uint32_t max_vertices = this->settings.max_vertices;
+    const uint32_t max_triangles = this->settings.max_triangles;
+    const LiteMath::float3* centroids = this->centroids.data () + first;
+    this->load_chunk (first, last, scratch);
+
+    uint32_t stamp = 0;
+    // New vertices triangle i would add to the meshlet, and the live triangles around its corners.
+    const auto score = [&] (uint32_t i, uint32_t& added, uint32_t& live) {
+        const uint32_t* corners = &scratch.corners [3 * size_t {i}];
+        added = 0;
+        live = 0;
+        for (int corner = 0; corner < 3; ++corner) {
+            const uint32_t v = corners [corner];
+            live += scratch.live [v];
+            added += scratch.local_stamp [v] != stamp
+                && (corner == 0 || (v != corners [0] && (corner == 1 || v != corners [1])));
+        }
+    };
+
+    uint32_t cursor = 0;
+    uint32_t seed = NONE;
+    while (true) {
+        if (seed == NONE) {
+            while (cursor < triangle_count && scratch.emitted [cursor]) {
+                ++cursor;
+            }
+            if (cursor == triangle_count) {
+                break;
+            }
+            seed = cursor;
+        }
+
+        Meshlet meshlet {};
+        meshlet.vertex_offset = static_cast <uint32_t> (out.vertices.size ());
+        meshlet.triangle_offset = static_cast <uint32_t> (out.triangles.size ());
+        LiteMath::float3 position_sum {0.0f};
+        LiteMath::float3 bounds_min {std::numeric_limits <float>::max ()};
+        LiteMath::float3 bounds_max {std::numeric_limits <float>::lowest ()};
+        scratch.meshlet_vertices.clear ();
+        scratch.candidates.clear ();
+        ++stamp;
+
+        uint32_t next = seed;
+        while (true) {
+            const uint32_t* corners = &scratch.corners [3 * size_t {next}];
+            for (int corner = 0; corner < 3; ++corner) {
+                const uint32_t v = corners [corner];
+                if (scratch.local_stamp [v] == stamp) {
+                    continue;
+                }
+                scratch.local_stamp [v] = stamp;
+                scratch.local [v] = meshlet.vertex_count++;
+                scratch.meshlet_vertices.push_back (v);
+                out.vertices.push_back (scratch.vertices [v]);
+                const LiteMath::float3& p = this->vertices [scratch.vertices [v]].position;
+                position_sum += p;
+                bounds_min = LiteMath::min (bounds_min, p);
+                bounds_max = LiteMath::max (bounds_max, p);
+                for (uint32_t j = scratch.adjacency_offsets [v]; j < scratch.adjacency_offsets [v + 1]; ++j) {
+                    const uint32_t i = scratch.adjacency [j];
+                    if (!scratch.emitted [i] && scratch.queued [i] != stamp) {
+                        scratch.queued [i] = stamp;
+                        scratch.candidates.push_back (i);
+                    }
+                }
+            }
+            out.triangles.push_back (scratch.local [corners [0]] | scratch.local [corners [1]] << 8 | scratch.local [corners [2]] << 16);
+            scratch.emitted [next] = 1;
+            for (int corner = 0; corner < 3; ++corner) {
+                --scratch.live [corners [corner]];
+            }
+            if (++meshlet.triangle_count == max_triangles) {
+                break;
+            }
+
+            // Fewest new vertices first, then the fewest live triangles around the corners (finishing vertices off
+            // rather than leaving scraps behind), then closest to the centroid. Candidates that can no longer fit
+            // are dropped.
+            const LiteMath::float3 center = position_sum / float (meshlet.vertex_count);
+            next = NONE;
+            uint32_t best_added = 4;
+            uint32_t best_live = 0;
+            float best_distance = 0.0f;
+            for (size_t k = 0; k < scratch.candidates.size ();) {
+                const uint32_t i = scratch.candidates [k];
+                uint32_t added = max_vertices + 1;
+                uint32_t live = 0;
+                if (!scratch.emitted [i]) {
+                    score (i, added, live);
+                }
+                if (meshlet.vertex_count + added > max_vertices) {
+                    scratch.candidates [k] = scratch.candidates.back ();
+                    scratch.candidates.pop_back ();
+                    continue;
+                }
+                ++k;
+                if (added > best_added || (added == best_added && live > best_live)) {
+                    continue;
+                }
+                const float distance = LiteMath::length (centroids [i] - center);
+                if (added < best_added || live < best_live || distance < best_distance) {
+                    next = i;
+                    best_added = added;
+                    best_live = live;
+                    best_distance = distance;
+                }
+            }
+            if (next != NONE) {
+                continue;
+            }
+
+            // No neighbour left: the next triangle along the curve joins if it lies within the meshlet's bounds,
+            // grown by half their diagonal, so small pieces of surface share meshlets without stretching them.
+            while (cursor < triangle_count && scratch.emitted [cursor]) {
+                ++cursor;
+            }
+            if (cursor == triangle_count) {
+                break;
+            }
+            const LiteMath::float3 margin {0.5f * LiteMath::length (bounds_max - bounds_min)};
+            const LiteMath::float3& centroid = centroids [cursor];
+            const bool inside = centroid.x >= bounds_min.x - margin.x && centroid.x <= bounds_max.x + margin.x
+                && centroid.y >= bounds_min.y - margin.y && centroid.y <= bounds_max.y + margin.y
+                && centroid.z >= bounds_min.z - margin.z && centroid.z <= bounds_max.z + margin.z;
+            uint32_t added = 0;
+            uint32_t live = 0;
+            score (cursor, added, live);
+            if (!inside || meshlet.vertex_count + added > max_vertices) {
+                break;
+            }
+            next = cursor;
+        }
+
+        // The next meshlet starts on this one's border, from the triangle with the fewest live triangles around it,
+        // so the surface is used up from one side instead of leaving scattered scraps.
+        seed = NONE;
+        uint32_t fewest = std::numeric_limits <uint32_t>::max ();
+        for (const uint32_t v : scratch.meshlet_vertices) {
+            for (uint32_t j = scratch.adjacency_offsets [v]; j < scratch.adjacency_offsets [v + 1] && scratch.live [v] > 0; ++j) {
+                const uint32_t i = scratch.adjacency [j];
+                if (scratch.emitted [i]) {
+                    continue;
+                }
+                uint32_t added = 0;
+                uint32_t live = 0;
+                score (i, added, live);
+                if (live < fewest) {
+                    seed = i;
+                    fewest = live;
+                }
+            }
+        }
+        out.meshlets.push_back (meshlet);
+    }
+}
+
+Meshlets MeshletBuilder::build () {
+    const size_t triangle_count = this->triangle_count ();
+    Meshlets result;
+    result.mesh_vertex_count = this->vertices.size ();
+    if (triangle_count == 0) {
+        return result;
+    }
+
+    this->order = morton_triangle_order (this->mesh, this->executor, this->concurrency, &this->centroids);
+
+    const size_t chunk_count = (triangle_count + CHUNK_TRIANGLES - 1) / CHUNK_TRIANGLES;
+    std::vector <ChunkMeshlets> chunks (chunk_count);
+    parallel_for (this->executor, this->concurrency, chunk_count, 1, [&] (size_t first, size_t last, unsigned int slot) {
+        for (size_t chunk = first; chunk < last; ++chunk) {
+            this->cluster_chunk (chunk, this->scratch [slot], chunks [chunk]);
+        }
+    });
+    std::vector <LiteMath::float3> ().swap (this->centroids);
+    this->scratch.clear ();
+
+    std::vector <size_t> meshlet_bases (chunk_count + 1, 0);
+    std::vector <size_t> vertex_bases (chunk_count + 1, 0);
+    std::vector <size_t> triangle_bases (chunk_count + 1, 0);
+    for (size_t chunk = 0; chunk < chunk_count; ++chunk) {
+        meshlet_bases [chunk + 1] = meshlet_bases [chunk] + chunks [chunk].meshlets.size ();
+        vertex_bases [chunk + 1] = vertex_bases [chunk] + chunks [chunk].vertices.size ();
+        triangle_bases [chunk + 1] = triangle_bases [chunk] + chunks [chunk].triangles.size ();
+    }
+    if (vertex_bases [chunk_count] >= std::numeric_limits <uint32_t>::max ()) {
+        throw std::runtime_error {"[build_meshlets]: too many meshlet vertices"};
+    }
+
+    result.meshlets.resize (meshlet_bases [chunk_count]);
+    result.vertices.resize (vertex_bases [chunk_count]);
+    result.triangles.resize (triangle_bases [chunk_count]);
+    parallel_for (this->executor, this->concurrency, chunk_count, 1, [&] (size_t first, size_t last, unsigned int) {
+        for (size_t chunk = first; chunk < last; ++chunk) {
+            ChunkMeshlets& meshlets = chunks [chunk];
+            for (size_t i = 0; i < meshlets.meshlets.size (); ++i) {
+                Meshlet meshlet = meshlets.meshlets [i];
+                meshlet.vertex_offset += static_cast <uint32_t> (vertex_bases [chunk]);
+                meshlet.triangle_offset += static_cast <uint32_t> (triangle_bases [chunk]);
+                result.meshlets [meshlet_bases [chunk] + i] = meshlet;
+            }
+            std::copy (meshlets.vertices.begin (), meshlets.vertices.end (), result.vertices.begin () + vertex_bases [chunk]);
+            std::copy (meshlets.triangles.begin (), meshlets.triangles.end (), result.triangles.begin () + triangle_bases [chunk]);
+            meshlets = {};
+        }
+    });
+
+    result.bounds.resize (result.meshlets.size ());
+    parallel_for (this->executor, this->concurrency, result.meshlets.size (), 256, [&] (size_t first, size_t last, unsigned int) {
+        for (size_t i = first; i < last; ++i) {
+            const Meshlet& meshlet = result.meshlets [i];
+            result.bounds [i] = compute_meshlet_bounds (this->vertices
+                    , &result.vertices [meshlet.vertex_offset]
+                    , meshlet.vertex_count
+                    , &result.triangles [meshlet.triangle_offset]
+                    , meshlet.triangle_count);
+        }
+    });
+    return result;
+}
+
+}
+
+Meshlets build_meshlets (const Mesh& mesh, const MeshletSettings& settings) {
+    if (settings.max_vertices < 3 || settings.max_vertices > 256) {
+        throw std::runtime_error {"[build_meshlets]: max_vertices must be in [3, 256]"};
+    }
+    if (settings.max_triangles < 1) {
+        throw std::runtime_error {"[build_meshlets]: max_triangles must be at least 1"};
+    }
+    if (mesh.get_vertices ().size () >= std::numeric_limits <uint32_t>::max ()
+        || mesh.get_indices ().size () >= std::numeric_limits <uint32_t>::max ()) {
+        throw std::runtime_error {"[build_meshlets]: mesh too large"};
+    }
+
+    Executor& executor = settings.get_executor ();
+    const unsigned int concurrency = static_cast <unsigned int> (std::max (1, settings.max_threads));
+    MeshletBuilder builder (mesh, settings, executor, concurrency);
+    return builder.build ();
+}
+
+MeshletBounds compute_meshlet_bounds (const std::vector <Vertex>& vertices, const uint32_t* meshlet_vertices, size_t vertex_count, const uint32_t* triangles, size_t triangle_count) {
+    MeshletBounds bounds {};
+    if (vertex_count == 0) {
+        return bounds;
+    }
+    const auto position = [&] (uint32_t local) -> const LiteMath::float3& {
+        return vertices [meshlet_vertices [local]].position;
+    };
+
+    // Ritter's sphere: start from the most distant pair of axis extremes and grow to take in every vertex.
+    uint32_t extremes [3][2] = {};
+    for (uint32_t i = 1; i < vertex_count; ++i) {
+        for (int axis = 0; axis < 3; ++axis) {
+            if (position (i) [axis] < position (extremes [axis][0]) [axis]) extremes [axis][0] = i;
+            if (position (i) [axis] > position (extremes [axis][1]) [axis]) extremes [axis][1] = i;
+        }
+    }
+    int widest = 0;
+    float widest_distance = -1.0f;
+    for (int axis = 0; axis < 3; ++axis) {
+        const float distance = LiteMath::length (position (extremes [axis][1]) - position (extremes [axis][0]));
+        if (distance > widest_distance) {
+            widest = axis;
+            widest_distance = distance;
+        }
+    }
+    LiteMath::float3 center = (position (extremes [widest][0]) + position (extremes [widest][1])) * 0.5f;
+    float radius = 0.5f * widest_distance;
+    for (uint32_t i = 0; i < vertex_count; ++i) {
+        const float distance = LiteMath::length (position (i) - center);
+        if (distance > radius) {
+            const float grown = 0.5f * (radius + distance);
+            center += (position (i) - center) * ((grown - radius) / distance);
+            radius = grown;
+        }
+    }
+    bounds.center = center;
+    bounds.radius = radius;
+
+    // Cone around the mean of the unit triangle normals, its apex behind the plane of every triangle.
+    bounds.cone_apex = center;
+    bounds.cone_cutoff = 1.0f;
+    bounds.cone_axis = LiteMath::float3 {0.0f};
+
+    LiteMath::float3 normal_sum {0.0f};
+    for (size_t t = 0; t < triangle_count; ++t) {
+        const uint32_t packed = triangles [t];
+        const LiteMath::float3 cross = triangle_cross (position (packed & 0xff), position ((packed >> 8) & 0xff), position ((packed >> 16) & 0xff));
+        const float length = LiteMath::length (cross);
+        if (length > 0.0f) {
+            normal_sum += cross / length;
+        }
+    }
+    const float sum_length = LiteMath::length (normal_sum);
+    if (!(sum_length > 0.0f)) {
+        return bounds;
+    }
+    const LiteMath::float3 axis = normal_sum / sum_length;
+
+    float min_dot = 1.0f;
+    float max_t = 0.0f;
+    for (size_t t = 0; t < triangle_count; ++t) {
+        const uint32_t packed = triangles [t];
+        const LiteMath::float3& p0 = position (packed & 0xff);
+        const LiteMath::float3 cross = triangle_cross (p0, position ((packed >> 8) & 0xff), position ((packed >> 16) & 0xff));
+        const float length = LiteMath::length (cross);
+        if (!(length > 0.0f)) {
+            continue;
+        }
+        const LiteMath::float3 normal = cross / length;
+        const float dn = LiteMath::dot (axis, normal);
+        min_dot = std::min (min_dot, dn);
+        // A cone past ~84 degrees culls next to nothing.
+        if (min_dot <= 0.1f) {
+            return bounds;
+        }
+        max_t = std::max (max_t, LiteMath::dot (center - p0, normal) / dn);
+    }
+
+    bounds.cone_axis = axis;
+    bounds.cone_cutoff = std::sqrt (std::max (0.0f, 1.0f - min_dot * min_dot));
+    bounds.cone_apex = center - axis * max_t;
+    return bounds;
+}
+
+void save_meshlets (const Meshlets& meshlets, const std::string& path) {
+    std::ofstream fs (path, std::ios::binary);
+    if (!fs) {
+        throw std::runtime_error ("[save_meshlets]: failed to open " + path);
+    }
+    const unsigned counts [4] = {
+        static_cast <unsigned> (meshlets.meshlets.size ())
+        , static_cast <unsigned> (meshlets.vertices.size ())
+        , static_cast <unsigned> (meshlets.triangles.size ())
+        , static_cast <unsigned> (meshlets.mesh_vertex_count)
+    };
+    fs.write (MESHLETS_MAGIC, sizeof (MESHLETS_MAGIC));
+    fs.write ((const char *) counts, sizeof (counts));
+    fs.write ((const char *) meshlets.meshlets.data (), meshlets.meshlets.size () * sizeof (Meshlet));
+    fs.write ((const char *) meshlets.bounds.data (), meshlets.bounds.size () * sizeof (MeshletBounds));
+    fs.write ((const char *) meshlets.vertices.data (), meshlets.vertices.size () * sizeof (uint32_t));
+    fs.write ((const char *) meshlets.triangles.data (), meshlets.triangles.size () * sizeof (uint32_t));
+    fs.flush ();
+    if (!fs) {
+        throw std::runtime_error ("[save_meshlets]: failed to write " + path);
+    }
+}
+
+void load_meshlets (Meshlets& meshlets, const std::string& path) {
+    std::ifstream fs (path, std::ios::binary);
+    if (!fs) {
+        throw std::runtime_error ("[load_meshlets]: failed to open " + path);
+    }
+
+    char magic [4] = {};
+    unsigned counts [4] = {};
+    fs.read (magic, sizeof (magic));
+    if (!std::equal (std::begin (magic), std::end (magic), MESHLETS_MAGIC)) {
+        throw std::runtime_error ("[load_meshlets]: " + path + " is not a meshlets file");
+    }
+    fs.read ((char *) counts, sizeof (counts));
+    meshlets.meshlets.resize (counts [0]);
+    meshlets.bounds.resize (counts [0]);
+    meshlets.vertices.resize (counts [1]);
+    meshlets.triangles.resize (counts [2]);
+    meshlets.mesh_vertex_count = counts [3];
+    fs.read ((char *) meshlets.meshlets.data (), meshlets.meshlets.size () * sizeof (Meshlet));
+    fs.read ((char *) meshlets.bounds.data (), meshlets.bounds.size () * sizeof (MeshletBounds));
+    fs.read ((char *) meshlets.vertices.data (), meshlets.vertices.size () * sizeof (uint32_t));
+    fs.read ((char *) meshlets.triangles.data (), meshlets.triangles.size () * sizeof (uint32_t));
+    if (!fs) {
+        throw std::runtime_error ("[load_meshlets]: " + path + " is truncated");
+    }
+
+    for (const Meshlet& meshlet : meshlets.meshlets) {
+        if (size_t {meshlet.vertex_offset} + meshlet.vertex_count > meshlets.vertices.size ()
+            || size_t {meshlet.triangle_offset} + meshlet.triangle_count > meshlets.triangles.size ()) {
+            throw std::runtime_error ("[load_meshlets]: " + path + " has a meshlet out of range");
+        }
+        // The mesh shader indexes the meshlet's vertices with these local ids unchecked.
+        for (uint32_t i = 0; i < meshlet.triangle_count; ++i) {
+            const uint32_t packed = meshlets.triangles [meshlet.triangle_offset + i];
+            if ((packed & 0xff) >= meshlet.vertex_count
+                || ((packed >> 8) & 0xff) >= meshlet.vertex_count
+                || ((packed >> 16) & 0xff) >= meshlet.vertex_count) {
+                throw std::runtime_error ("[load_meshlets]: " + path + " has a triangle corner out of its meshlet");
+            }
+        }
+    }
+    for (const uint32_t vertex : meshlets.vertices) {
+        if (vertex >= meshlets.mesh_vertex_count) {
+            throw std::runtime_error ("[load_meshlets]: " + path + " refers to a vertex out of range");
+        }
+    }
+}
+
+MeshletDescriptorSetInfo create_meshlet_descriptor_set (
+        VkDevice device
+        , VkPhysicalDevice physical_device
+        , const Meshlets& meshlets
+        , std::shared_ptr <vk_utils::ICopyEngine> copy_helper
+        , vk_utils::DescriptorMaker& ds_maker
+        , VkShaderStageFlags shader_stage_flags) {
+    MeshletDescriptorSetInfo info = {};
+
+    if (!copy_helper) {
+        throw std::runtime_error ("ICopyEngine shared_ptr cannot be null.");
+    }
+    if (meshlets.empty ()) {
+        throw std::runtime_error ("Meshlets are empty, cannot create descriptor set.");
+    }
+
+    struct Stream {
+        VkBuffer* buffer;
+        const void* data;
+        VkDeviceSize size;
+    };
+    const std::vector <Stream> streams = {
+        {&info.meshlet_buffer, meshlets.meshlets.data (), meshlets.meshlets.size () * sizeof (Meshlet)}
+        , {&info.bounds_buffer, meshlets.bounds.data (), meshlets.bounds.size () * sizeof (MeshletBounds)}
+        , {&info.vertex_buffer, meshlets.vertices.data (), meshlets.vertices.size () * sizeof (uint32_t)}
+        , {&info.triangle_buffer, meshlets.triangles.data (), meshlets.triangles.size () * sizeof (uint32_t)}
+    };
+
+    std::vector <VkBuffer> buffers;
+    for (const Stream& stream : streams) {
+        VkMemoryRequirements memReq;
+        *stream.buffer = vk_utils::createBuffer (
+                device
+                , stream.size
+                , VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT
+                , &memReq
+                );
+        buffers.push_back (*stream.buffer);
+    }
+
+    info.memory = vk_utils::allocateAndBindWithPadding (device, physical_device, buffers);
+
+    ds_maker.BindBegin (shader_stage_flags);
+    for (uint32_t binding = 0; binding < streams.size (); ++binding) {
+        copy_helper->UpdateBuffer (*streams [binding].buffer, 0, streams [binding].data, streams [binding].size);
+        ds_maker.BindBuffer (binding, *streams [binding].buffer, VK_NULL_HANDLE, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+    }
+    ds_maker.BindEnd (&info.descriptor_set, &info.descriptor_set_layout);
+
+    return info;
+}
+
+void cleanup_meshlet_descriptor_set (VkDevice device, MeshletDescriptorSetInfo& info) {
+    for (VkBuffer* buffer : {&info.meshlet_buffer, &info.bounds_buffer, &info.vertex_buffer, &info.triangle_buffer}) {
+        if (*buffer != VK_NULL_HANDLE) {
+            vkDestroyBuffer (device, *buffer, nullptr);
+            *buffer = VK_NULL_HANDLE;
+        }
+    }
+
+    if (info.memory != VK_NULL_HANDLE) {
+        vkFreeMemory (device, info.memory, nullptr);
+        info.memory = VK_NULL_HANDLE;
+    }
+
+    info = {};
+}
+
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "LiteMath.h"
+#include "executor.hpp"
+#include "mesh.hpp"
+#include "shaders/common.h"
+#include "vk_copy.h"
+#include "vk_descriptor_sets.h"
+#include "vk_utils.h"
+
+namespace sdf_raster {
+
+struct MeshletSettings : ParallelSettings {
+  uint32_t max_vertices = MESHLET_MAX_VERTICES;   // at most 256: triangles store 8-bit local ids
+  uint32_t max_triangles = MESHLET_MAX_TRIANGLES;
+};
+
+// Clusters of a Mesh for the mesh shader path, laid out as shaders/common.h reads them: meshlet i covers
+// meshlets [i].vertex_count entries of `vertices` (ids into the mesh vertices) from vertex_offset on, and
+// meshlets [i].triangle_count entries of `triangles` (three local ids, a | b << 8 | c << 16) from triangle_offset on.
+struct Meshlets {
+  std::vector <Meshlet> meshlets;
+  std::vector <MeshletBounds> bounds;
+  std::vector <uint32_t> vertices;
+  std::vector <uint32_t> triangles;
+  size_t mesh_vertex_count = 0; // vertices of the mesh the meshlets were built for
+
+  size_t size () const { return this->meshlets.size (); }
+  bool empty () const { return this->meshlets.empty (); }
+};
+
+// Triangles are sorted along a Morton curve of their centroids and cut into chunks of 16K that are clustered in
+// parallel. Within a chunk a meshlet grows from a seed by the adjacent triangle that adds the fewest new vertices,
+// then has the fewest triangles left around its corners, then lies closest to the meshlet's centroid, until a limit
+// is hit or no neighbour fits. A meshlet out of neighbours takes the next triangle along the curve if it lies within
+// its bounds, and the next meshlet is seeded on its border. Chunks only depend on the mesh, so the result is the same
+// for any max_threads.
+//
+// Every meshlet gets a bounding sphere and the cone of its triangle normals for culling (see MeshletBounds).
+Meshlets build_meshlets (const Mesh& mesh, const MeshletSettings& settings = {});
+
+// Bounding sphere and normal cone of `triangle_count` packed triangles whose local ids index the `vertex_count` ids
+// into `vertices` at `meshlet_vertices`.
+MeshletBounds compute_meshlet_bounds (const std::vector <Vertex>& vertices, const uint32_t* meshlet_vertices, size_t vertex_count, const uint32_t* triangles, size_t triangle_count);
+
+// Binary .meshlets file written next to the mesh; the ids refer to the mesh vertices in the order the exporters keep.
+void save_meshlets (const Meshlets& meshlets, const std::string& path);
+void load_meshlets (Meshlets& meshlets, const std::string& path);
+
+// Storage buffers for the shaders: binding 0 holds the meshlets, 1 the bounds, 2 the vertex ids and 3 the triangles.
+struct MeshletDescriptorSetInfo {
+  VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
+  VkDescriptorSetLayout descriptor_set_layout = VK_NULL_HANDLE;
+
+  VkBuffer meshlet_buffer = VK_NULL_HANDLE;
+  VkBuffer bounds_buffer = VK_NULL_HANDLE;
+  VkBuffer vertex_buffer = VK_NULL_HANDLE;
+  VkBuffer triangle_buffer = VK_NULL_HANDLE;
+  VkDeviceMemory memory = VK_NULL_HANDLE;
+};
+
+MeshletDescriptorSetInfo create_meshlet_descriptor_set (
+    VkDevice device
+    , VkPhysicalDevice physical_device
+    , const Meshlets& meshlets
+    , std::shared_ptr <vk_utils::ICopyEngine> copy_helper
+    , vk_utils::DescriptorMaker& ds_maker
+    , VkShaderStageFlags shader_stage_flags);
+
+void cleanup_meshlet_descriptor_set (VkDevice device, MeshletDescriptorSetInfo& info);
+
+}
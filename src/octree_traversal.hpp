@@ -0,0 +1,146 @@
+#pragma once
+
+#include <stdexcept>
+
+#include "executor.hpp"
+#include "sdf_octree_formats.hpp"
+
+namespace sdf_raster {
+
+struct VoxelInfo {
+  LiteMath::float3 min_corner;
+  float voxel_size;
+  uint32_t node_index;
+  uint32_t corner_lattice; // sibling group of the node, only read by SharedCornerSdfOctree
+  uint32_t child_slot;
+  uint32_t depth;          // root is 0
+};
+
+inline VoxelInfo octree_root_voxel_info () {
+    VoxelInfo root_context;
+    root_context.voxel_size = 2.f;
+    root_context.min_corner = {-1.0f, -1.0f, -1.0f};
+    root_context.node_index = 0;
+    root_context.corner_lattice = 0;
+    root_context.child_slot = 0;
+    root_context.depth = 0;
+    return root_context;
+}
+
+template <typename Octree>
+void load_leaf_values (const Octree& scene, const VoxelInfo& voxel_info, float (&values) [8]) {
+    load_node_values (scene, voxel_info.node_index, voxel_info.corner_lattice, voxel_info.child_slot, values);
+}
+
+template <typename Octree>
+VoxelInfo child_voxel_info (const Octree& scene, const VoxelInfo& parent, uint32_t offset, unsigned int k) {
+    size_t child_index = offset + k;
+    if (child_index >= scene.size ()) {
+        throw std::runtime_error {"[child_voxel_info]: out of bounds."};
+    }
+
+    float child_voxel_size = parent.voxel_size * 0.5f;
+    LiteMath::float3 corner_offset = {0.0f, 0.0f, 0.0f};
+    if ((k >> 0) & 1) corner_offset.x = child_voxel_size;
+    if ((k >> 1) & 1) corner_offset.y = child_voxel_size;
+    if ((k >> 2) & 1) corner_offset.z = child_voxel_size;
+
+    VoxelInfo child_context;
+    child_context.node_index = static_cast <uint32_t> (child_index);
+    child_context.corner_lattice = children_lattice (scene, parent.node_index);
+    child_context.child_slot = k;
+    child_context.min_corner = parent.min_corner + corner_offset;
+    child_context.voxel_size = child_voxel_size;
+    child_context.depth = parent.depth + 1;
+    return child_context;
+}
+
+// Visits the features of the octree shared by leaves: faces, edges and corner points, each once (the procedures of
+// Ju et al. for dual contouring and of Schaefer & Warren for dual marching cubes, in one generic form).
+//
+// `nodes` is a 2x2x2 block indexed like cube corners and `split_mask` has a bit per axis along which the block holds
+// two different sides; nodes are duplicated along the other axes. Mask 0 is a cell, one bit a face, two bits an edge
+// and 7 a corner point. Once all 8 entries are leaves by `is_leaf`, `visit (nodes, split_mask, slot)` is called and
+// the recursion stops; `prune (nodes)` can cut a block before that. Blocks above `task_spawn_depth` become tasks of
+// `group` (unless it runs on one thread), so the callbacks must be safe to run concurrently; `slot` is the TaskGroup slot running the visit.
+// The caller waits on `group`.
+template <typename Octree, typename IsLeaf, typename Prune, typename Visit>
+void dual_procedure (const Octree& scene
+                     , const VoxelInfo (&nodes) [8]
+                     , unsigned int split_mask
+                     , unsigned int depth
+                     , unsigned int slot
+                     , TaskGroup& group
+                     , unsigned int task_spawn_depth
+                     , const IsLeaf& is_leaf
+                     , const Prune& prune
+                     , const Visit& visit) {
+    if (prune (nodes)) {
+        return;
+    }
+
+    bool all_leaves = true;
+    for (int k = 0; k < 8; ++k) {
+        all_leaves = all_leaves && is_leaf (nodes [k]);
+    }
+    if (all_leaves) {
+        visit (nodes, split_mask, slot);
+        return;
+    }
+
+    // Subdividing every internal node turns the block into a grid of 4 child slots along split axes and 2 along
+    // the others. Sub-procedures are 2x2x2 windows of that grid lying on this feature: split axes keep the pair of
+    // slots around the middle, every other axis picks slot 0, slot 1 or the new split between them.
+    unsigned int free_axes [3];
+    unsigned int free_count = 0;
+    for (unsigned int axis = 0; axis < 3; ++axis) {
+        if (!((split_mask >> axis) & 1)) {
+            free_axes [free_count++] = axis;
+        }
+    }
+
+    unsigned int combinations = 1;
+    for (unsigned int i = 0; i < free_count; ++i) {
+        combinations *= 3;
+    }
+
+    for (unsigned int combination = 0; combination < combinations; ++combination) {
+        unsigned int first_slot [3] = {1, 1, 1};
+        unsigned int sub_split_mask = split_mask;
+        for (unsigned int i = 0, rest = combination; i < free_count; ++i, rest /= 3) {
+            const unsigned int choice = rest % 3;
+            first_slot [free_axes [i]] = choice == 2 ? 0 : choice;
+            if (choice == 2) {
+                sub_split_mask |= 1u << free_axes [i];
+            }
+        }
+
+        VoxelInfo sub_nodes [8];
+        for (unsigned int k = 0; k < 8; ++k) {
+            unsigned int parent_octant = 0;
+            unsigned int child_slot = 0;
+            for (unsigned int axis = 0; axis < 3; ++axis) {
+                const unsigned int slot = first_slot [axis] + (((sub_split_mask >> axis) & 1) ? ((k >> axis) & 1) : 0);
+                if ((split_mask >> axis) & 1) {
+                    parent_octant |= (slot >> 1) << axis;
+                    child_slot |= (slot & 1) << axis;
+                } else {
+                    child_slot |= slot << axis;
+                }
+            }
+
+            const VoxelInfo& parent = nodes [parent_octant];
+            sub_nodes [k] = is_leaf (parent) ? parent : child_voxel_info (scene, parent, scene [parent.node_index].offset, child_slot);
+        }
+
+        if (depth < task_spawn_depth && group.concurrency () > 1) {
+            group.run ([&scene, sub_nodes, sub_split_mask, depth, &group, task_spawn_depth, &is_leaf, &prune, &visit] (unsigned int task_slot) {
+                dual_procedure (scene, sub_nodes, sub_split_mask, depth + 1, task_slot, group, task_spawn_depth, is_leaf, prune, visit);
+            });
+        } else {
+            dual_procedure (scene, sub_nodes, sub_split_mask, depth + 1, slot, group, task_spawn_depth, is_leaf, prune, visit);
+        }
+    }
+}
+
+}
@@ -0,0 +1,32 @@
+#include <algorithm>
+
+#include "position_weld.hpp"
+
+namespace sdf_raster {
+
+void PositionWeldTable::grow () {
+    std::vector <WeldKey> old_keys (std::max <size_t> (64, 2 * this->keys.size ()));
+    std::vector <uint32_t> old_values (old_keys.size (), EMPTY);
+    std::swap (old_keys, this->keys);
+    std::swap (old_values, this->values);
+
+    const size_t mask = this->keys.size () - 1;
+    for (size_t i = 0; i < old_keys.size (); ++i) {
+        if (old_values [i] == EMPTY) {
+            continue;
+        }
+        size_t slot = hash_weld_key (old_keys [i]) & mask;
+        while (this->values [slot] != EMPTY) {
+            slot = (slot + 1) & mask;
+        }
+        this->keys [slot] = old_keys [i];
+        this->values [slot] = old_values [i];
+    }
+}
+
+void PositionWeldTable::clear () {
+    std::fill (this->values.begin (), this->values.end (), EMPTY);
+    this->count = 0;
+}
+
+}
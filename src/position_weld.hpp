@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "LiteMath.h"
+
+namespace sdf_raster {
+
+// Positions are welded when their keys are equal. With a tolerance, a key is the point of the lattice with that
+// spacing nearest to the position; without one, it is the bit pattern of the coordinates (-0 and +0 alike), so only
+// identical positions weld.
+struct WeldKey {
+  uint32_t x;
+  uint32_t y;
+  uint32_t z;
+
+  bool operator == (const WeldKey& other) const { return this->x == other.x && this->y == other.y && this->z == other.z; }
+  bool operator < (const WeldKey& other) const {
+      return this->x != other.x ? this->x < other.x : this->y != other.y ? this->y < other.y : this->z < other.z;
+  }
+};
+
+// `inverse_tolerance` is 1 / tolerance, or 0 for exact welding.
+inline uint32_t weld_coordinate (float v, float inverse_tolerance) {
+    if (inverse_tolerance == 0.0f) {
+        const float canonical = v + 0.0f; // -0 becomes +0
+        uint32_t bits;
+        std::memcpy (&bits, &canonical, sizeof (bits));
+        return bits;
+    }
+    // Lattice indices past the int32 range collapse onto its ends.
+    const float cell = std::round (v * inverse_tolerance);
+    const float limit = 2147483520.0f; // largest float below 2^31
+    return static_cast <uint32_t> (static_cast <int32_t> (std::fmax (-limit, std::fmin (limit, cell))));
+}
+
+inline WeldKey make_weld_key (const LiteMath::float3& p, float inverse_tolerance) {
+    return {weld_coordinate (p.x, inverse_tolerance), weld_coordinate (p.y, inverse_tolerance), weld_coordinate (p.z, inverse_tolerance)};
+}
+
+inline uint64_t hash_weld_key (const WeldKey& key) {
+    uint64_t h = (uint64_t (key.x) << 32 | key.y) * 0x9e3779b97f4a7c15ull ^ uint64_t (key.z) * 0xc2b2ae3d27d4eb4full;
+    h ^= h >> 29;
+    h *= 0xbf58476d1ce4e5b9ull;
+    h ^= h >> 32;
+    return h;
+}
+
+// Flat linear-probing map from a weld key to a vertex index, kept at most half full.
+class PositionWeldTable {
+public:
+  static constexpr uint32_t EMPTY = ~0u;
+
+  // Returns the slot holding `key`; `inserted` tells whether it was just added and still needs its value.
+  uint32_t& find_or_insert (const WeldKey& key, bool& inserted) {
+      if (2 * (this->count + 1) > this->keys.size ()) {
+          this->grow ();
+      }
+
+      const size_t mask = this->keys.size () - 1;
+      for (size_t slot = hash_weld_key (key) & mask; ; slot = (slot + 1) & mask) {
+          if (this->values [slot] == EMPTY) {
+              this->keys [slot] = key;
+              ++this->count;
+              inserted = true;
+              return this->values [slot];
+          }
+          if (this->keys [slot] == key) {
+              inserted = false;
+              return this->values [slot];
+          }
+      }
+  }
+
+  // Forgets every key but keeps the table's storage.
+  void clear ();
+
+  size_t size () const { return this->count; }
+
+private:
+  void grow ();
+
+  std::vector <WeldKey> keys;
+  std::vector <uint32_t> values; // EMPTY marks a free slot
+  size_t count = 0;
+};
+
+}
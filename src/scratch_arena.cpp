@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+#include "scratch_arena.hpp"
+
+namespace sdf_raster {
+
+namespace {
+
+constexpr size_t BLOCK_ALIGNMENT = 64; // cache line: arenas of different threads never share one
+
+size_t align_up (size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+}
+
+ScratchArena::ScratchArena (size_t a_initial_block_size)
+    : initial_block_size (std::max <size_t> (a_initial_block_size, BLOCK_ALIGNMENT)) {
+}
+
+ScratchArena::~ScratchArena () {
+    for (const Block& block : this->blocks) {
+        ::operator delete (block.data, std::align_val_t {BLOCK_ALIGNMENT});
+    }
+}
+
+ScratchArena::Mark ScratchArena::mark () const {
+    return {this->current, this->offset, this->arena_stats.bytes_in_use};
+}
+
+void ScratchArena::rewind (const Mark& mark) {
+    this->current = mark.block;
+    this->offset = mark.offset;
+    this->arena_stats.bytes_in_use = mark.bytes_in_use;
+}
+
+void ScratchArena::reset () {
+    // One block with some headroom over what the last cycle used, so the same work fits without the doubling slack.
+    if (this->blocks.size () > 1) {
+        for (const Block& block : this->blocks) {
+            ::operator delete (block.data, std::align_val_t {BLOCK_ALIGNMENT});
+        }
+        this->blocks.clear ();
+        this->arena_stats.reserved_bytes = 0;
+        this->add_block (std::max (this->initial_block_size, this->cycle_peak + this->cycle_peak / 8));
+    }
+    this->cycle_peak = 0;
+    this->current = 0;
+    this->offset = 0;
+    this->arena_stats.bytes_in_use = 0;
+}
+
+void* ScratchArena::do_allocate (size_t bytes, size_t alignment) {
+    // Blocks are BLOCK_ALIGNMENT aligned, so aligning the offset aligns the address for any smaller alignment.
+    alignment = std::max (alignment, alignof (std::max_align_t));
+    if (alignment > BLOCK_ALIGNMENT) {
+        throw std::bad_alloc {};
+    }
+    while (this->current < this->blocks.size ()) {
+        const Block& block = this->blocks [this->current];
+        const size_t start = align_up (this->offset, alignment);
+        if (start + bytes <= block.size) {
+            // Alignment padding counts as used, so a block of cycle_peak bytes holds the whole cycle.
+            this->arena_stats.bytes_in_use += start + bytes - this->offset;
+            this->arena_stats.bytes_allocated += bytes;
+            this->arena_stats.peak_bytes = std::max (this->arena_stats.peak_bytes, this->arena_stats.bytes_in_use);
+            this->cycle_peak = std::max (this->cycle_peak, this->arena_stats.bytes_in_use);
+            this->offset = start + bytes;
+            return block.data + start;
+        }
+        // Blocks after the current one are left over from before a rewind; try them before growing.
+        ++this->current;
+        this->offset = 0;
+    }
+
+    const size_t last_size = this->blocks.empty () ? this->initial_block_size : 2 * this->blocks.back ().size;
+    this->add_block (std::max (last_size, align_up (bytes, BLOCK_ALIGNMENT)));
+    this->current = this->blocks.size () - 1;
+    this->offset = 0;
+    return this->do_allocate (bytes, alignment);
+}
+
+void ScratchArena::add_block (size_t size) {
+    Block block;
+    block.size = align_up (size, BLOCK_ALIGNMENT);
+    block.data = static_cast <std::byte*> (::operator new (block.size, std::align_val_t {BLOCK_ALIGNMENT}));
+    this->blocks.push_back (block);
+    this->arena_stats.reserved_bytes += block.size;
+    ++this->arena_stats.heap_allocations;
+}
+
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <type_traits>
+#include <vector>
+
+namespace sdf_raster {
+
+struct ScratchArenaStats {
+  size_t bytes_in_use = 0;     // handed out since the last reset
+  size_t peak_bytes = 0;       // most bytes in use at once
+  size_t bytes_allocated = 0;  // handed out over the arena's lifetime
+  size_t reserved_bytes = 0;   // block memory currently held
+  size_t heap_allocations = 0; // blocks taken from the heap over the arena's lifetime
+};
+
+// Bump allocator over blocks taken from the heap and kept until the arena dies. deallocate () is a no-op; memory comes
+// back by rewinding to a mark or by reset (). reset () merges the blocks into one sized for the most the arena held
+// since the previous reset, so after a warm-up call the same work runs out of a single block without touching the heap.
+//
+// Not thread-safe: every thread allocating during a parallel phase needs its own arena.
+class ScratchArena : public std::pmr::memory_resource {
+public:
+  struct Mark {
+    size_t block = 0;
+    size_t offset = 0;
+    size_t bytes_in_use = 0;
+  };
+
+  explicit ScratchArena (size_t initial_block_size = 64 << 10);
+  ~ScratchArena () override;
+
+  ScratchArena (const ScratchArena&) = delete;
+  ScratchArena& operator = (const ScratchArena&) = delete;
+
+  Mark mark () const;
+  void rewind (const Mark& mark);
+  void reset ();
+
+  const ScratchArenaStats& stats () const { return this->arena_stats; }
+
+private:
+  struct Block {
+    std::byte* data = nullptr;
+    size_t size = 0;
+  };
+
+  void* do_allocate (size_t bytes, size_t alignment) override;
+  void do_deallocate (void*, size_t, size_t) override {}
+  bool do_is_equal (const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+  void add_block (size_t size);
+
+  std::vector <Block> blocks;
+  size_t current = 0; // block the next allocation is tried in
+  size_t offset = 0;  // first free byte of that block
+  size_t initial_block_size;
+  size_t cycle_peak = 0; // most bytes in use since the last reset
+  ScratchArenaStats arena_stats;
+};
+
+// Rewinds the arena to where it was on construction: temporaries of a loop body or a task go away with the scope.
+class ScratchScope {
+public:
+  explicit ScratchScope (ScratchArena& a_arena) : arena (a_arena), start (a_arena.mark ()) {}
+  ~ScratchScope () { this->arena.rewind (this->start); }
+
+  ScratchScope (const ScratchScope&) = delete;
+  ScratchScope& operator = (const ScratchScope&) = delete;
+
+private:
+  ScratchArena& arena;
+  ScratchArena::Mark start;
+};
+
+template <typename T>
+using ScratchVector = std::pmr::vector <T>;
+
+// Uninitialized storage for `count` objects, for arrays that are filled in parallel right away. Nothing is constructed
+// or destroyed, so T must not need either beyond its first store.
+template <typename T>
+T* allocate_scratch_array (ScratchArena& arena, size_t count) {
+    static_assert (std::is_trivially_destructible_v <T>);
+    return static_cast <T*> (arena.allocate (count * sizeof (T), alignof (T)));
+}
+
+}
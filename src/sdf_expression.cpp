@@ -0,0 +1,792 @@
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#if defined (__x86_64__) || defined (__i386__)
+#define SDF_RASTER_X86_SIMD 1
+#endif
+
+#include "sdf_expression.hpp"
+
+namespace sdf_raster {
+
+namespace {
+
+// Lanes per block: registers of a block stay in L1 for any sensible program, and a 16-lane AVX-512 or 8-lane AVX2
+// loop runs several iterations per instruction.
+constexpr size_t LANES = 64;
+constexpr uint32_t MAX_REGISTERS = 256;
+constexpr float PI = 3.14159265358979f;
+
+size_t param_count (SdfNodeKind kind) {
+    switch (kind) {
+        case SdfNodeKind::Sphere: return 1;
+        case SdfNodeKind::Box: return 3;
+        case SdfNodeKind::Torus: return 2;
+        case SdfNodeKind::Cylinder: return 2;
+        case SdfNodeKind::Capsule: return 7;
+        case SdfNodeKind::Plane: return 4;
+        default: return 0;
+    }
+}
+
+bool is_primitive (SdfNodeKind kind) {
+    return kind <= SdfNodeKind::Plane;
+}
+
+bool is_binary (SdfNodeKind kind) {
+    return kind >= SdfNodeKind::Union && kind <= SdfNodeKind::SmoothDifference;
+}
+
+// ---------------------------------------------------------------------------------------------------------------
+// Parser
+
+class ExpressionParser {
+public:
+  explicit ExpressionParser (const std::string& text) : text (text) {}
+
+  SdfExpression parse () {
+      this->parse_node ();
+      this->skip_space ();
+      if (this->position != this->text.size ()) {
+          this->fail ("text after the expression");
+      }
+      return std::move (this->expression);
+  }
+
+private:
+  [[noreturn]] void fail (const std::string& message) const {
+      const size_t line = 1 + std::count (this->text.begin (), this->text.begin () + std::min (this->position, this->text.size ()), '\n');
+      throw std::runtime_error {"[parse_sdf_expression]: line " + std::to_string (line) + ": " + message};
+  }
+
+  void skip_space () {
+      while (this->position < this->text.size ()) {
+          const char c = this->text [this->position];
+          if (c == ';') {
+              while (this->position < this->text.size () && this->text [this->position] != '\n') {
+                  ++this->position;
+              }
+          } else if (std::isspace (static_cast <unsigned char> (c))) {
+              ++this->position;
+          } else {
+              break;
+          }
+      }
+  }
+
+  bool at (char c) {
+      this->skip_space ();
+      return this->position < this->text.size () && this->text [this->position] == c;
+  }
+
+  void expect (char c) {
+      if (!this->at (c)) {
+          this->fail (std::string {"expected '"} + c + "'");
+      }
+      ++this->position;
+  }
+
+  std::string atom () {
+      this->skip_space ();
+      const size_t start = this->position;
+      while (this->position < this->text.size ()) {
+          const char c = this->text [this->position];
+          if (c == '(' || c == ')' || c == ';' || std::isspace (static_cast <unsigned char> (c))) {
+              break;
+          }
+          ++this->position;
+      }
+      if (start == this->position) {
+          this->fail ("expected a name or a number");
+      }
+      return this->text.substr (start, this->position - start);
+  }
+
+  float number () {
+      const std::string token = this->atom ();
+      char* end = nullptr;
+      const float value = std::strtof (token.c_str (), &end);
+      if (end != token.c_str () + token.size () || !std::isfinite (value)) {
+          this->fail ("'" + token + "' is not a number");
+      }
+      return value;
+  }
+
+  LiteMath::float3 vector () {
+      const float x = this->number ();
+      const float y = this->number ();
+      const float z = this->number ();
+      return {x, y, z};
+  }
+
+  SdfExpression::Id parse_node () {
+      this->expect ('(');
+      const std::string name = this->atom ();
+      SdfExpression& e = this->expression;
+      SdfExpression::Id id = 0;
+      if (name == "sphere") {
+          id = e.sphere (this->number ());
+      } else if (name == "box") {
+          id = e.box (this->vector ());
+      } else if (name == "torus") {
+          const float major_radius = this->number ();
+          id = e.torus (major_radius, this->number ());
+      } else if (name == "cylinder") {
+          const float radius = this->number ();
+          id = e.cylinder (radius, this->number ());
+      } else if (name == "capsule") {
+          const LiteMath::float3 a = this->vector ();
+          const LiteMath::float3 b = this->vector ();
+          id = e.capsule (a, b, this->number ());
+      } else if (name == "plane") {
+          const LiteMath::float3 normal = this->vector ();
+          id = e.plane (normal, this->number ());
+      } else if (name == "union" || name == "intersect" || name == "subtract") {
+          id = this->parse_operands (name, 0.0f);
+      } else if (name == "smooth-union" || name == "smooth-intersect" || name == "smooth-subtract") {
+          const float width = this->number ();
+          id = this->parse_operands (name, width);
+      } else if (name == "translate") {
+          const LiteMath::float3 offset = this->vector ();
+          id = e.translate (this->parse_node (), offset);
+      } else if (name == "rotate") {
+          const LiteMath::float3 axis = this->vector ();
+          const float degrees = this->number ();
+          id = e.rotate (this->parse_node (), axis, degrees * (PI / 180.0f));
+      } else if (name == "scale") {
+          const float factor = this->number ();
+          id = e.scale (this->parse_node (), factor);
+      } else if (name == "round") {
+          const float radius = this->number ();
+          id = e.round (this->parse_node (), radius);
+      } else {
+          this->fail ("unknown node '" + name + "'");
+      }
+      this->expect (')');
+      return id;
+  }
+
+  SdfExpression::Id parse_operands (const std::string& name, float width) {
+      SdfExpression& e = this->expression;
+      SdfExpression::Id id = this->parse_node ();
+      if (this->at (')')) {
+          this->fail ("'" + name + "' needs at least two operands");
+      }
+      while (!this->at (')')) {
+          const SdfExpression::Id operand = this->parse_node ();
+          if (name == "union") {
+              id = e.unite (id, operand);
+          } else if (name == "intersect") {
+              id = e.intersect (id, operand);
+          } else if (name == "subtract") {
+              id = e.subtract (id, operand);
+          } else if (name == "smooth-union") {
+              id = e.smooth_unite (id, operand, width);
+          } else if (name == "smooth-intersect") {
+              id = e.smooth_intersect (id, operand, width);
+          } else {
+              id = e.smooth_subtract (id, operand, width);
+          }
+      }
+      return id;
+  }
+
+  const std::string& text;
+  size_t position = 0;
+  SdfExpression expression;
+};
+
+// ---------------------------------------------------------------------------------------------------------------
+// Compiler
+
+// World point to the local frame of a node: local = m * p + t, and world distance = local distance * scale.
+struct Frame {
+  float m [9] = {1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+  float t [3] = {};
+  float scale = 1.0f;
+  bool identity = true;
+};
+
+class ExpressionCompiler {
+public:
+  explicit ExpressionCompiler (const SdfExpression& expression) : nodes (expression.get_nodes ()) {}
+
+  SdfProgram compile (SdfExpression::Id root) {
+      // Registers a node needs: the deeper operand of a CSG node is computed first and holds one register while the
+      // other one runs (Sethi-Ullman numbering).
+      this->needs.resize (root + 1);
+      for (SdfExpression::Id id = 0; id <= root; ++id) {
+          const SdfNode& node = this->nodes [id];
+          if (is_primitive (node.kind)) {
+              this->needs [id] = 1;
+          } else if (is_binary (node.kind)) {
+              const uint32_t a = this->needs [node.a];
+              const uint32_t b = this->needs [node.b];
+              this->needs [id] = a == b ? a + 1 : std::max (a, b);
+          } else {
+              this->needs [id] = this->needs [node.a];
+          }
+      }
+      if (this->needs [root] > MAX_REGISTERS) {
+          throw std::runtime_error {"[compile_sdf_expression]: expression needs more than 256 registers"};
+      }
+
+      this->compile_node (root, Frame {}, 0);
+      this->program.register_count = this->needs [root];
+      return std::move (this->program);
+  }
+
+private:
+  uint32_t add_constants (const float* values, size_t count) {
+      const uint32_t first = static_cast <uint32_t> (this->program.constants.size ());
+      this->program.constants.insert (this->program.constants.end (), values, values + count);
+      return first;
+  }
+
+  void emit (SdfOpcode opcode, uint32_t dst, uint32_t a, uint32_t b, uint32_t constants) {
+      SdfInstruction instruction;
+      instruction.opcode = opcode;
+      instruction.dst = static_cast <uint8_t> (dst);
+      instruction.a = static_cast <uint8_t> (a);
+      instruction.b = static_cast <uint8_t> (b);
+      instruction.constants = constants;
+      this->program.instructions.push_back (instruction);
+  }
+
+  // Point source of a primitive in `frame`: the input point, or the local one, transformed here unless the last
+  // Transform already wrote this frame.
+  uint32_t point_source (const Frame& frame) {
+      if (frame.identity) {
+          return 0;
+      }
+      float constants [12];
+      std::copy (frame.m, frame.m + 9, constants);
+      std::copy (frame.t, frame.t + 3, constants + 9);
+      if (!this->has_transform || std::memcmp (constants, this->last_transform, sizeof (constants)) != 0) {
+          this->emit (SdfOpcode::Transform, 0, 0, 0, this->add_constants (constants, 12));
+          std::memcpy (this->last_transform, constants, sizeof (constants));
+          this->has_transform = true;
+      }
+      return 1;
+  }
+
+  void compile_node (SdfExpression::Id id, const Frame& frame, uint32_t dst) {
+      const SdfNode& node = this->nodes [id];
+      if (is_primitive (node.kind)) {
+          const uint32_t source = this->point_source (frame);
+          float constants [8];
+          const size_t count = param_count (node.kind);
+          std::copy (node.params, node.params + count, constants);
+          constants [count] = frame.scale;
+          const SdfOpcode opcode = static_cast <SdfOpcode> (static_cast <int> (SdfOpcode::Sphere) + static_cast <int> (node.kind) - static_cast <int> (SdfNodeKind::Sphere));
+          this->emit (opcode, dst, source, 0, this->add_constants (constants, count + 1));
+          return;
+      }
+
+      if (is_binary (node.kind)) {
+          const bool a_first = this->needs [node.a] >= this->needs [node.b];
+          const uint32_t a = a_first ? dst : dst + 1;
+          const uint32_t b = a_first ? dst + 1 : dst;
+          this->compile_node (a_first ? node.a : node.b, frame, dst);
+          this->compile_node (a_first ? node.b : node.a, frame, dst + 1);
+          const float width = node.params [0] * frame.scale;
+          switch (node.kind) {
+              case SdfNodeKind::Union: this->emit (SdfOpcode::Min, dst, a, b, 0); break;
+              case SdfNodeKind::Intersection: this->emit (SdfOpcode::Max, dst, a, b, 0); break;
+              case SdfNodeKind::Difference: this->emit (SdfOpcode::Subtract, dst, a, b, 0); break;
+              case SdfNodeKind::SmoothUnion: this->emit (SdfOpcode::SmoothMin, dst, a, b, this->add_constants (&width, 1)); break;
+              case SdfNodeKind::SmoothIntersection: this->emit (SdfOpcode::SmoothMax, dst, a, b, this->add_constants (&width, 1)); break;
+              default: this->emit (SdfOpcode::SmoothSubtract, dst, a, b, this->add_constants (&width, 1)); break;
+          }
+          return;
+      }
+
+      Frame child = frame;
+      switch (node.kind) {
+          case SdfNodeKind::Translate:
+              for (int i = 0; i < 3; ++i) {
+                  child.t [i] -= node.params [i];
+              }
+              child.identity = false;
+              break;
+          case SdfNodeKind::Rotate: {
+              // The child is rotated by R, so points go to its frame by R^T.
+              const float x = node.params [0], y = node.params [1], z = node.params [2];
+              const float c = std::cos (node.params [3]), s = std::sin (node.params [3]), k = 1.0f - c;
+              const float rt [9] = {
+                  c + x * x * k, x * y * k + z * s, x * z * k - y * s,
+                  y * x * k - z * s, c + y * y * k, y * z * k + x * s,
+                  z * x * k + y * s, z * y * k - x * s, c + z * z * k,
+              };
+              for (int row = 0; row < 3; ++row) {
+                  for (int col = 0; col < 3; ++col) {
+                      child.m [3 * row + col] = rt [3 * row] * frame.m [col] + rt [3 * row + 1] * frame.m [3 + col] + rt [3 * row + 2] * frame.m [6 + col];
+                  }
+                  child.t [row] = rt [3 * row] * frame.t [0] + rt [3 * row + 1] * frame.t [1] + rt [3 * row + 2] * frame.t [2];
+              }
+              child.identity = false;
+              break;
+          }
+          case SdfNodeKind::Scale: {
+              const float inverse = 1.0f / node.params [0];
+              for (float& value : child.m) {
+                  value *= inverse;
+              }
+              for (float& value : child.t) {
+                  value *= inverse;
+              }
+              child.scale *= node.params [0];
+              child.identity = false;
+              break;
+          }
+          default: {
+              this->compile_node (node.a, frame, dst);
+              const float radius = node.params [0] * frame.scale;
+              this->emit (SdfOpcode::Offset, dst, dst, 0, this->add_constants (&radius, 1));
+              return;
+          }
+      }
+      this->compile_node (node.a, child, dst);
+  }
+
+  const std::vector <SdfNode>& nodes;
+  std::vector <uint32_t> needs;
+  SdfProgram program;
+  float last_transform [12] = {};
+  bool has_transform = false;
+};
+
+// ---------------------------------------------------------------------------------------------------------------
+// Interpreter
+
+// By value, unlike std::min and std::max, so the lane loops below if-convert and vectorize.
+inline float min_value (float a, float b) {
+    return b < a ? b : a;
+}
+
+inline float max_value (float a, float b) {
+    return a < b ? b : a;
+}
+
+// One block of n <= LANES points through the whole program. Every instruction is a loop over the lanes, so the
+// compiler vectorizes it for whatever ISA the caller is built for. `registers` holds register_count + 3 rows of
+// LANES floats, the last three for the local point.
+inline __attribute__ ((always_inline)) void evaluate_block (const SdfProgram& program
+                                                            , const float* xs
+                                                            , const float* ys
+                                                            , const float* zs
+                                                            , float* distances
+                                                            , size_t n
+                                                            , float* registers) {
+    float* local_x = registers + program.register_count * LANES;
+    float* local_y = local_x + LANES;
+    float* local_z = local_y + LANES;
+
+    for (const SdfInstruction& instruction : program.instructions) {
+        const float* c = program.constants.data () + instruction.constants;
+        float* dst = registers + instruction.dst * LANES;
+        const float* a = registers + instruction.a * LANES;
+        const float* b = registers + instruction.b * LANES;
+        const float* x = instruction.a == 0 ? xs : local_x;
+        const float* y = instruction.a == 0 ? ys : local_y;
+        const float* z = instruction.a == 0 ? zs : local_z;
+
+        switch (instruction.opcode) {
+            case SdfOpcode::Transform: {
+                #pragma omp simd
+                for (size_t i = 0; i < n; ++i) {
+                    local_x [i] = c [0] * xs [i] + c [1] * ys [i] + c [2] * zs [i] + c [9];
+                    local_y [i] = c [3] * xs [i] + c [4] * ys [i] + c [5] * zs [i] + c [10];
+                    local_z [i] = c [6] * xs [i] + c [7] * ys [i] + c [8] * zs [i] + c [11];
+                }
+                break;
+            }
+            case SdfOpcode::Sphere: {
+                #pragma omp simd
+                for (size_t i = 0; i < n; ++i) {
+                    dst [i] = (std::sqrt (x [i] * x [i] + y [i] * y [i] + z [i] * z [i]) - c [0]) * c [1];
+                }
+                break;
+            }
+            case SdfOpcode::Box: {
+                #pragma omp simd
+                for (size_t i = 0; i < n; ++i) {
+                    const float qx = std::fabs (x [i]) - c [0];
+                    const float qy = std::fabs (y [i]) - c [1];
+                    const float qz = std::fabs (z [i]) - c [2];
+                    const float ox = max_value (qx, 0.0f), oy = max_value (qy, 0.0f), oz = max_value (qz, 0.0f);
+                    const float inside = min_value (max_value (qx, max_value (qy, qz)), 0.0f);
+                    dst [i] = (std::sqrt (ox * ox + oy * oy + oz * oz) + inside) * c [3];
+                }
+                break;
+            }
+            case SdfOpcode::Torus: {
+                #pragma omp simd
+                for (size_t i = 0; i < n; ++i) {
+                    const float qx = std::sqrt (x [i] * x [i] + z [i] * z [i]) - c [0];
+                    dst [i] = (std::sqrt (qx * qx + y [i] * y [i]) - c [1]) * c [2];
+                }
+                break;
+            }
+            case SdfOpcode::Cylinder: {
+                #pragma omp simd
+                for (size_t i = 0; i < n; ++i) {
+                    const float dx = std::sqrt (x [i] * x [i] + z [i] * z [i]) - c [0];
+                    const float dy = std::fabs (y [i]) - c [1];
+                    const float ox = max_value (dx, 0.0f), oy = max_value (dy, 0.0f);
+                    dst [i] = (min_value (max_value (dx, dy), 0.0f) + std::sqrt (ox * ox + oy * oy)) * c [2];
+                }
+                break;
+            }
+            case SdfOpcode::Capsule: {
+                const float ax = c [0], ay = c [1], az = c [2];
+                const float bax = c [3] - ax, bay = c [4] - ay, baz = c [5] - az;
+                const float length_squared = bax * bax + bay * bay + baz * baz;
+                const float inverse = length_squared > 0.0f ? 1.0f / length_squared : 0.0f;
+                const float radius = c [6], scale = c [7];
+                #pragma omp simd
+                for (size_t i = 0; i < n; ++i) {
+                    const float pax = x [i] - ax, pay = y [i] - ay, paz = z [i] - az;
+                    const float h = min_value (max_value ((pax * bax + pay * bay + paz * baz) * inverse, 0.0f), 1.0f);
+                    const float dx = pax - bax * h, dy = pay - bay * h, dz = paz - baz * h;
+                    dst [i] = (std::sqrt (dx * dx + dy * dy + dz * dz) - radius) * scale;
+                }
+                break;
+            }
+            case SdfOpcode::Plane: {
+                #pragma omp simd
+                for (size_t i = 0; i < n; ++i) {
+                    dst [i] = (x [i] * c [0] + y [i] * c [1] + z [i] * c [2] + c [3]) * c [4];
+                }
+                break;
+            }
+            case SdfOpcode::Min: {
+                #pragma omp simd
+                for (size_t i = 0; i < n; ++i) {
+                    dst [i] = min_value (a [i], b [i]);
+                }
+                break;
+            }
+            case SdfOpcode::Max: {
+                #pragma omp simd
+                for (size_t i = 0; i < n; ++i) {
+                    dst [i] = max_value (a [i], b [i]);
+                }
+                break;
+            }
+            case SdfOpcode::Subtract: {
+                #pragma omp simd
+                for (size_t i = 0; i < n; ++i) {
+                    dst [i] = max_value (a [i], -b [i]);
+                }
+                break;
+            }
+            case SdfOpcode::SmoothMin: {
+                const float width = c [0], inverse = 1.0f / c [0];
+                #pragma omp simd
+                for (size_t i = 0; i < n; ++i) {
+                    const float h = max_value (width - std::fabs (a [i] - b [i]), 0.0f) * inverse;
+                    dst [i] = min_value (a [i], b [i]) - h * h * width * 0.25f;
+                }
+                break;
+            }
+            case SdfOpcode::SmoothMax: {
+                const float width = c [0], inverse = 1.0f / c [0];
+                #pragma omp simd
+                for (size_t i = 0; i < n; ++i) {
+                    const float h = max_value (width - std::fabs (a [i] - b [i]), 0.0f) * inverse;
+                    dst [i] = max_value (a [i], b [i]) + h * h * width * 0.25f;
+                }
+                break;
+            }
+            case SdfOpcode::SmoothSubtract: {
+                const float width = c [0], inverse = 1.0f / c [0];
+                #pragma omp simd
+                for (size_t i = 0; i < n; ++i) {
+                    const float h = max_value (width - std::fabs (a [i] + b [i]), 0.0f) * inverse;
+                    dst [i] = max_value (a [i], -b [i]) + h * h * width * 0.25f;
+                }
+                break;
+            }
+            case SdfOpcode::Offset: {
+                #pragma omp simd
+                for (size_t i = 0; i < n; ++i) {
+                    dst [i] = a [i] - c [0];
+                }
+                break;
+            }
+        }
+    }
+
+    std::copy (registers, registers + n, distances);
+}
+
+// The compiler never fuses a multiply and an add here (no FMA in either target), so both paths round alike.
+inline __attribute__ ((always_inline)) void evaluate_blocks (const SdfProgram& program, const float* xs, const float* ys, const float* zs, float* distances, size_t count) {
+    std::vector <float> registers ((program.register_count + 3) * LANES);
+    for (size_t first = 0; first < count; first += LANES) {
+        const size_t n = std::min (LANES, count - first);
+        evaluate_block (program, xs + first, ys + first, zs + first, distances + first, n, registers.data ());
+    }
+}
+
+void evaluate_blocks_default (const SdfProgram& program, const float* xs, const float* ys, const float* zs, float* distances, size_t count) {
+    evaluate_blocks (program, xs, ys, zs, distances, count);
+}
+
+#ifdef SDF_RASTER_X86_SIMD
+__attribute__ ((target ("avx2")))
+void evaluate_blocks_avx2 (const SdfProgram& program, const float* xs, const float* ys, const float* zs, float* distances, size_t count) {
+    evaluate_blocks (program, xs, ys, zs, distances, count);
+}
+#endif
+
+}
+
+// ---------------------------------------------------------------------------------------------------------------
+// SdfExpression
+
+SdfExpression::Id SdfExpression::add (const SdfNode& node) {
+    for (size_t i = 0; i < param_count (node.kind); ++i) {
+        if (!std::isfinite (node.params [i])) {
+            throw std::runtime_error {"[SdfExpression]: parameters must be finite"};
+        }
+    }
+    this->nodes.push_back (node);
+    return static_cast <Id> (this->nodes.size () - 1);
+}
+
+void SdfExpression::check_operand (Id id, const char* function) const {
+    if (id >= this->nodes.size ()) {
+        throw std::runtime_error {std::string {"[SdfExpression::"} + function + "]: unknown operand " + std::to_string (id)};
+    }
+}
+
+SdfExpression::Id SdfExpression::sphere (float radius) {
+    SdfNode node;
+    node.kind = SdfNodeKind::Sphere;
+    node.params [0] = radius;
+    return this->add (node);
+}
+
+SdfExpression::Id SdfExpression::box (const LiteMath::float3& half_size) {
+    SdfNode node;
+    node.kind = SdfNodeKind::Box;
+    node.params [0] = half_size.x;
+    node.params [1] = half_size.y;
+    node.params [2] = half_size.z;
+    return this->add (node);
+}
+
+SdfExpression::Id SdfExpression::torus (float major_radius, float minor_radius) {
+    SdfNode node;
+    node.kind = SdfNodeKind::Torus;
+    node.params [0] = major_radius;
+    node.params [1] = minor_radius;
+    return this->add (node);
+}
+
+SdfExpression::Id SdfExpression::cylinder (float radius, float half_height) {
+    SdfNode node;
+    node.kind = SdfNodeKind::Cylinder;
+    node.params [0] = radius;
+    node.params [1] = half_height;
+    return this->add (node);
+}
+
+SdfExpression::Id SdfExpression::capsule (const LiteMath::float3& a, const LiteMath::float3& b, float radius) {
+    SdfNode node;
+    node.kind = SdfNodeKind::Capsule;
+    node.params [0] = a.x;
+    node.params [1] = a.y;
+    node.params [2] = a.z;
+    node.params [3] = b.x;
+    node.params [4] = b.y;
+    node.params [5] = b.z;
+    node.params [6] = radius;
+    return this->add (node);
+}
+
+SdfExpression::Id SdfExpression::plane (const LiteMath::float3& normal, float offset) {
+    const float length = LiteMath::length (normal);
+    if (!(length > 0.0f)) {
+        throw std::runtime_error {"[SdfExpression::plane]: zero normal"};
+    }
+    SdfNode node;
+    node.kind = SdfNodeKind::Plane;
+    node.params [0] = normal.x / length;
+    node.params [1] = normal.y / length;
+    node.params [2] = normal.z / length;
+    node.params [3] = offset;
+    return this->add (node);
+}
+
+SdfExpression::Id SdfExpression::unite (Id a, Id b) {
+    return this->smooth_unite (a, b, 0.0f);
+}
+
+SdfExpression::Id SdfExpression::intersect (Id a, Id b) {
+    return this->smooth_intersect (a, b, 0.0f);
+}
+
+SdfExpression::Id SdfExpression::subtract (Id a, Id b) {
+    return this->smooth_subtract (a, b, 0.0f);
+}
+
+// A zero width is the plain operation.
+SdfExpression::Id SdfExpression::smooth_unite (Id a, Id b, float width) {
+    this->check_operand (a, "smooth_unite");
+    this->check_operand (b, "smooth_unite");
+    if (!(width >= 0.0f)) {
+        throw std::runtime_error {"[SdfExpression::smooth_unite]: negative blend width"};
+    }
+    SdfNode node;
+    node.kind = width > 0.0f ? SdfNodeKind::SmoothUnion : SdfNodeKind::Union;
+    node.a = a;
+    node.b = b;
+    node.params [0] = width;
+    return this->add (node);
+}
+
+SdfExpression::Id SdfExpression::smooth_intersect (Id a, Id b, float width) {
+    this->check_operand (a, "smooth_intersect");
+    this->check_operand (b, "smooth_intersect");
+    if (!(width >= 0.0f)) {
+        throw std::runtime_error {"[SdfExpression::smooth_intersect]: negative blend width"};
+    }
+    SdfNode node;
+    node.kind = width > 0.0f ? SdfNodeKind::SmoothIntersection : SdfNodeKind::Intersection;
+    node.a = a;
+    node.b = b;
+    node.params [0] = width;
+    return this->add (node);
+}
+
+SdfExpression::Id SdfExpression::smooth_subtract (Id a, Id b, float width) {
+    this->check_operand (a, "smooth_subtract");
+    this->check_operand (b, "smooth_subtract");
+    if (!(width >= 0.0f)) {
+        throw std::runtime_error {"[SdfExpression::smooth_subtract]: negative blend width"};
+    }
+    SdfNode node;
+    node.kind = width > 0.0f ? SdfNodeKind::SmoothDifference : SdfNodeKind::Difference;
+    node.a = a;
+    node.b = b;
+    node.params [0] = width;
+    return this->add (node);
+}
+
+SdfExpression::Id SdfExpression::translate (Id child, const LiteMath::float3& offset) {
+    this->check_operand (child, "translate");
+    SdfNode node;
+    node.kind = SdfNodeKind::Translate;
+    node.a = child;
+    node.params [0] = offset.x;
+    node.params [1] = offset.y;
+    node.params [2] = offset.z;
+    if (!std::isfinite (offset.x) || !std::isfinite (offset.y) || !std::isfinite (offset.z)) {
+        throw std::runtime_error {"[SdfExpression::translate]: offset must be finite"};
+    }
+    return this->add (node);
+}
+
+SdfExpression::Id SdfExpression::rotate (Id child, const LiteMath::float3& axis, float radians) {
+    this->check_operand (child, "rotate");
+    const float length = LiteMath::length (axis);
+    if (!(length > 0.0f) || !std::isfinite (radians)) {
+        throw std::runtime_error {"[SdfExpression::rotate]: zero axis or infinite angle"};
+    }
+    SdfNode node;
+    node.kind = SdfNodeKind::Rotate;
+    node.a = child;
+    node.params [0] = axis.x / length;
+    node.params [1] = axis.y / length;
+    node.params [2] = axis.z / length;
+    node.params [3] = radians;
+    return this->add (node);
+}
+
+SdfExpression::Id SdfExpression::scale (Id child, float factor) {
+    this->check_operand (child, "scale");
+    if (!(factor > 0.0f) || !std::isfinite (factor)) {
+        throw std::runtime_error {"[SdfExpression::scale]: factor must be positive"};
+    }
+    SdfNode node;
+    node.kind = SdfNodeKind::Scale;
+    node.a = child;
+    node.params [0] = factor;
+    return this->add (node);
+}
+
+SdfExpression::Id SdfExpression::round (Id child, float radius) {
+    this->check_operand (child, "round");
+    if (!std::isfinite (radius)) {
+        throw std::runtime_error {"[SdfExpression::round]: radius must be finite"};
+    }
+    SdfNode node;
+    node.kind = SdfNodeKind::Round;
+    node.a = child;
+    node.params [0] = radius;
+    return this->add (node);
+}
+
+SdfExpression parse_sdf_expression (const std::string& text) {
+    return ExpressionParser {text}.parse ();
+}
+
+SdfExpression load_sdf_expression (const std::string& path) {
+    std::ifstream file (path);
+    if (!file) {
+        throw std::runtime_error {"[load_sdf_expression]: cannot open " + path};
+    }
+    std::stringstream text;
+    text << file.rdbuf ();
+    return parse_sdf_expression (text.str ());
+}
+
+// ---------------------------------------------------------------------------------------------------------------
+// SdfProgram
+
+SdfProgram compile_sdf_expression (const SdfExpression& expression) {
+    if (expression.empty ()) {
+        throw std::runtime_error {"[compile_sdf_expression]: empty expression"};
+    }
+    return compile_sdf_expression (expression, static_cast <SdfExpression::Id> (expression.size () - 1));
+}
+
+SdfProgram compile_sdf_expression (const SdfExpression& expression, SdfExpression::Id root) {
+    if (root >= expression.size ()) {
+        throw std::runtime_error {"[compile_sdf_expression]: unknown root " + std::to_string (root)};
+    }
+    return ExpressionCompiler {expression}.compile (root);
+}
+
+void SdfProgram::evaluate (const float* xs, const float* ys, const float* zs, float* distances, size_t count) const {
+    if (this->instructions.empty ()) {
+        throw std::runtime_error {"[SdfProgram::evaluate]: empty program"};
+    }
+
+#ifdef SDF_RASTER_X86_SIMD
+    static const bool has_avx2 = __builtin_cpu_supports ("avx2");
+    if (has_avx2) {
+        evaluate_blocks_avx2 (*this, xs, ys, zs, distances, count);
+        return;
+    }
+#endif
+
+    evaluate_blocks_default (*this, xs, ys, zs, distances, count);
+}
+
+float SdfProgram::evaluate (const LiteMath::float3& p) const {
+    float distance = 0.0f;
+    this->evaluate (&p.x, &p.y, &p.z, &distance, 1);
+    return distance;
+}
+
+}
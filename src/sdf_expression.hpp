@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "LiteMath.h"
+
+namespace sdf_raster {
+
+enum class SdfNodeKind : uint8_t {
+  Sphere,             // params: radius
+  Box,                // params: half size x, y, z
+  Torus,              // params: major radius, minor radius; in the xz plane
+  Cylinder,           // params: radius, half height; capped, along y
+  Capsule,            // params: a x, y, z, b x, y, z, radius
+  Plane,              // params: normal x, y, z, offset; dot (p, normal) + offset
+  Union,
+  Intersection,
+  Difference,         // a minus b
+  SmoothUnion,        // params: blend width
+  SmoothIntersection, // params: blend width
+  SmoothDifference,   // params: blend width
+  Translate,          // params: offset x, y, z
+  Rotate,             // params: unit axis x, y, z, angle in radians
+  Scale,              // params: factor
+  Round,              // params: radius
+};
+
+struct SdfNode {
+  SdfNodeKind kind = SdfNodeKind::Sphere;
+  uint32_t a = 0;     // operand of transforms and Round, left operand of the CSG kinds
+  uint32_t b = 0;     // right operand of the CSG kinds
+  float params [7] = {};
+};
+
+// Graph of signed distance primitives, CSG and transforms. Every call adds a node and returns its id; operands must
+// be ids returned before, so the graph is acyclic, and a node may be used by any number of others. Distances are exact
+// for the primitives and the transforms (scaling is uniform) and a lower bound after CSG, which is what sphere tracing
+// and octree building need.
+class SdfExpression {
+public:
+  using Id = uint32_t;
+
+  Id sphere (float radius);
+  Id box (const LiteMath::float3& half_size);
+  Id torus (float major_radius, float minor_radius);
+  Id cylinder (float radius, float half_height);
+  Id capsule (const LiteMath::float3& a, const LiteMath::float3& b, float radius);
+  Id plane (const LiteMath::float3& normal, float offset);
+
+  Id unite (Id a, Id b);
+  Id intersect (Id a, Id b);
+  Id subtract (Id a, Id b);
+  // Polynomial smooth min and max: the surfaces blend within `width` of where they meet.
+  Id smooth_unite (Id a, Id b, float width);
+  Id smooth_intersect (Id a, Id b, float width);
+  Id smooth_subtract (Id a, Id b, float width);
+
+  Id translate (Id child, const LiteMath::float3& offset);
+  Id rotate (Id child, const LiteMath::float3& axis, float radians);
+  Id scale (Id child, float factor);
+  // Grows the surface by `radius`, rounding its edges.
+  Id round (Id child, float radius);
+
+  const std::vector <SdfNode>& get_nodes () const { return this->nodes; }
+  size_t size () const { return this->nodes.size (); }
+  bool empty () const { return this->nodes.empty (); }
+
+private:
+  Id add (const SdfNode& node);
+  void check_operand (Id id, const char* function) const;
+
+  std::vector <SdfNode> nodes;
+};
+
+// Reads an expression written as nested lists, `;` starting a comment to the end of the line:
+//
+//   (smooth-union 0.05
+//     (sphere 0.5)
+//     (translate 0.4 0 0 (rotate 0 0 1 45 (box 0.2 0.3 0.2))))
+//
+// Primitives: (sphere r) (box hx hy hz) (torus R r) (cylinder r h) (capsule ax ay az bx by bz r) (plane nx ny nz d).
+// CSG takes two or more operands and folds them from the left: (union ...) (intersect ...) (subtract a ...), and
+// (smooth-union k ...) (smooth-intersect k ...) (smooth-subtract k a ...). Transforms take the child last:
+// (translate x y z c) (rotate ax ay az degrees c) (scale s c) (round r c). The root is the last node of the result.
+SdfExpression parse_sdf_expression (const std::string& text);
+SdfExpression load_sdf_expression (const std::string& path);
+
+enum class SdfOpcode : uint8_t {
+  Transform,          // local point = rows of constants [0, 9) * point + constants [9, 12)
+  Sphere,             // primitives read the input point when `a` is 0 and the local point when it is 1,
+  Box,                // take the node's params as constants and multiply the distance by the constant after them
+  Torus,
+  Cylinder,
+  Capsule,
+  Plane,
+  Min,                // registers: dst = op (a, b)
+  Max,
+  Subtract,           // max (a, -b)
+  SmoothMin,          // constants: blend width
+  SmoothMax,
+  SmoothSubtract,
+  Offset,             // dst = a - constants [0]
+};
+
+struct SdfInstruction {
+  SdfOpcode opcode = SdfOpcode::Sphere;
+  uint8_t dst = 0;
+  uint8_t a = 0;
+  uint8_t b = 0;
+  uint32_t constants = 0; // first constant in SdfProgram::constants
+};
+
+// Flat program a compiled expression runs as. Transforms are folded into one affine map per primitive, emitted only
+// when it changes, and the distance scale of uniform scaling into the primitive and the blend widths; CSG operands
+// are computed deepest first, so registers stay few. The result ends up in register 0.
+struct SdfProgram {
+  std::vector <SdfInstruction> instructions;
+  std::vector <float> constants;
+  uint32_t register_count = 0;
+
+  // Distances at `count` points given as SoA coordinates. Points run through each instruction in blocks of 64 lanes,
+  // vectorized for AVX2 when the CPU has it; results do not depend on the path taken. Thread-safe.
+  void evaluate (const float* xs, const float* ys, const float* zs, float* distances, size_t count) const;
+  float evaluate (const LiteMath::float3& p) const;
+};
+
+// Compiles the graph below `root`; the last node when `root` is left out.
+SdfProgram compile_sdf_expression (const SdfExpression& expression);
+SdfProgram compile_sdf_expression (const SdfExpression& expression, SdfExpression::Id root);
+
+}
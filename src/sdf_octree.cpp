@@ -1,12 +1,115 @@
+#include <cerrno>
 #include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "sdf_octree.hpp"
 #include "vk_buffers.h"
 
 namespace sdf_raster {
 
+MappedSdfOctree::MappedSdfOctree (const std::string& path, const SdfOctreeMappingOptions& options) {
+    int fd = ::open (path.c_str (), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error ("[MappedSdfOctree]: failed to open '" + path + "': " + std::strerror (errno));
+    }
+
+    struct stat st {};
+    if (::fstat (fd, &st) != 0) {
+        ::close (fd);
+        throw std::runtime_error ("[MappedSdfOctree]: failed to stat '" + path + "': " + std::strerror (errno));
+    }
+
+    const size_t file_size = static_cast <size_t> (st.st_size);
+    if (file_size < sizeof (unsigned)) {
+        ::close (fd);
+        throw std::runtime_error ("[MappedSdfOctree]: '" + path + "' is too small to be an octree.");
+    }
+
+    int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+    if (options.populate) {
+        flags |= MAP_POPULATE;
+    }
+#endif
+
+    void* mapping = ::mmap (nullptr, file_size, PROT_READ, flags, fd, 0);
+    ::close (fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error ("[MappedSdfOctree]: mmap of '" + path + "' failed: " + std::strerror (errno));
+    }
+
+    this->mapping = mapping;
+    this->mapping_size = file_size;
+
+    unsigned count = 0;
+    std::memcpy (&count, mapping, sizeof (unsigned));
+    if (sizeof (unsigned) + static_cast <size_t> (count) * sizeof (SdfOctreeNode) > file_size) {
+        this->close ();
+        throw std::runtime_error ("[MappedSdfOctree]: '" + path + "' is truncated.");
+    }
+    this->nodes = SdfOctreeView (
+            reinterpret_cast <const SdfOctreeNode*> (static_cast <const char*> (mapping) + sizeof (unsigned))
+            , count
+            );
+
+    // Hints are best effort: a kernel without THP for file mappings just ignores them.
+#ifdef MADV_HUGEPAGE
+    if (options.huge_pages) {
+        ::madvise (mapping, file_size, MADV_HUGEPAGE);
+    }
+#endif
+    if (options.access_pattern == SdfOctreeAccessPattern::Random) {
+        ::madvise (mapping, file_size, MADV_RANDOM);
+    } else if (options.access_pattern == SdfOctreeAccessPattern::Sequential) {
+        ::madvise (mapping, file_size, MADV_SEQUENTIAL);
+    }
+#ifndef MAP_POPULATE
+    if (options.populate) {
+        ::madvise (mapping, file_size, MADV_WILLNEED);
+    }
+#endif
+}
+
+MappedSdfOctree::~MappedSdfOctree () {
+    this->close ();
+}
+
+MappedSdfOctree::MappedSdfOctree (MappedSdfOctree&& other) noexcept
+    : mapping (other.mapping)
+    , mapping_size (other.mapping_size)
+    , nodes (other.nodes) {
+    other.mapping = nullptr;
+    other.mapping_size = 0;
+    other.nodes = {};
+}
+
+MappedSdfOctree& MappedSdfOctree::operator = (MappedSdfOctree&& other) noexcept {
+    if (this != &other) {
+        this->close ();
+        std::swap (this->mapping, other.mapping);
+        std::swap (this->mapping_size, other.mapping_size);
+        std::swap (this->nodes, other.nodes);
+    }
+    return *this;
+}
+
+void MappedSdfOctree::close () {
+    if (this->mapping != nullptr) {
+        ::munmap (this->mapping, this->mapping_size);
+    }
+    this->mapping = nullptr;
+    this->mapping_size = 0;
+    this->nodes = {};
+}
+
 void load_sdf_octree (SdfOctree &scene, const std::string &path) {
     std::ifstream fs (path, std::ios::binary);
     unsigned sz = 0;
@@ -16,16 +119,16 @@ void load_sdf_octree (SdfOctree &scene, const std::string &path) {
     fs.close ();
 }
 
-void save_sdf_octree (const SdfOctree &scene, const std::string &path) {
+void save_sdf_octree (const SdfOctreeView &scene, const std::string &path) {
     std::ofstream fs (path, std::ios::binary);
-    size_t size = scene.nodes.size ();
+    size_t size = scene.size ();
     fs.write ((const char *) &size, sizeof (unsigned));
-    fs.write ((const char *) scene.nodes.data (), size * sizeof (SdfOctreeNode));
+    fs.write ((const char *) scene.data (), size * sizeof (SdfOctreeNode));
     fs.flush ();
     fs.close ();
 }
 
-void dump_sdf_octree_text (const SdfOctree &scene, const std::string &path_to_dump) {
+void dump_sdf_octree_text (const SdfOctreeView &scene, const std::string &path_to_dump) {
     std::ofstream dump_file (path_to_dump);
     if (!dump_file.is_open()) {
         std::cerr << "Error: Could not open file for dumping: " << path_to_dump << std::endl;
@@ -33,11 +136,11 @@ void dump_sdf_octree_text (const SdfOctree &scene, const std::string &path_to_du
     }
 
     dump_file << "SDF Octree Dump:" << std::endl;
-    dump_file << "Total nodes: " << scene.nodes.size() << std::endl;
+    dump_file << "Total nodes: " << scene.size() << std::endl;
     dump_file << "----------------------------------------" << std::endl;
 
-    for (size_t i = 0; i < scene.nodes.size(); ++i) {
-        const auto& node = scene.nodes[i];
+    for (size_t i = 0; i < scene.size(); ++i) {
+        const auto& node = scene[i];
         dump_file << "Node [" << i << "]:" << std::endl;
         dump_file << "  Values: [";
         for (int j = 0; j < 8; ++j) {
@@ -65,39 +168,82 @@ void dump_sdf_octree_text (const SdfOctree &scene, const std::string &path_to_du
     std::cout << "SDF Octree successfully dumped to: " << path_to_dump << std::endl;
 }
 
-float sample_sdf (const SdfOctree& scene, const LiteMath::float3& p) {
-    const SdfOctreeNode* node = &scene.nodes [0];
-    LiteMath::float3 min_corner = {-1.0f, -1.0f, -1.0f};
-    float voxel_size = 2.0f;
+// Corner i sits at (i & 1, (i >> 1) & 1, (i >> 2) & 1), the layout used by the marching cubes tables.
+float interpolate_trilinear (const float (&values) [8], const LiteMath::float3& local) {
+    auto lerp = [] (float a, float b, float t) { return a + t * (b - a); };
 
-    while (node->offset != 0) {
-        float half = voxel_size * 0.5f;
-        unsigned child_index = 0;
-        if (p.x >= min_corner.x + half) child_index |= 1, min_corner.x += half;
-        if (p.y >= min_corner.y + half) child_index |= 2, min_corner.y += half;
-        if (p.z >= min_corner.z + half) child_index |= 4, min_corner.z += half;
-        voxel_size = half;
-        node = &scene.nodes [node->offset + child_index];
-    }
+    float c00 = lerp (values [0], values [1], local.x);
+    float c01 = lerp (values [4], values [5], local.x);
+    float c10 = lerp (values [2], values [3], local.x);
+    float c11 = lerp (values [6], values [7], local.x);
 
-    LiteMath::float3 local = (p - min_corner) / voxel_size;
+    float c0 = lerp (c00, c10, local.y);
+    float c1 = lerp (c01, c11, local.y);
+
+    return lerp (c0, c1, local.z);
+}
+
+SdfSample interpolate_trilinear_with_gradient (const float (&values) [8], const LiteMath::float3& local, float voxel_size) {
     auto lerp = [] (float a, float b, float t) { return a + t * (b - a); };
 
-    float c00 = lerp (node->values [0], node->values [1], local.x);
-    float c01 = lerp (node->values [4], node->values [5], local.x);
-    float c10 = lerp (node->values [3], node->values [2], local.x);
-    float c11 = lerp (node->values [7], node->values [6], local.x);
+    float c00 = lerp (values [0], values [1], local.x);
+    float c01 = lerp (values [4], values [5], local.x);
+    float c10 = lerp (values [2], values [3], local.x);
+    float c11 = lerp (values [6], values [7], local.x);
 
     float c0 = lerp (c00, c10, local.y);
     float c1 = lerp (c01, c11, local.y);
 
-    return lerp (c0, c1, local.z);
+    float du = lerp (lerp (values [1] - values [0], values [3] - values [2], local.y)
+                   , lerp (values [5] - values [4], values [7] - values [6], local.y)
+                   , local.z);
+    float dv = lerp (c10 - c00, c11 - c01, local.z);
+    float dw = c1 - c0;
+
+    SdfSample sample;
+    sample.distance = lerp (c0, c1, local.z);
+    sample.gradient = LiteMath::float3 {du, dv, dw} / voxel_size;
+    return sample;
+}
+
+float sample_sdf (const SdfOctreeView& scene, const LiteMath::float3& p) {
+    LiteMath::float3 min_corner;
+    float voxel_size = 0.0f;
+    const SdfOctreeNode& node = scene [find_leaf (scene, p, min_corner, voxel_size)];
+
+    LiteMath::float3 local = (p - min_corner) / voxel_size;
+    return interpolate_trilinear (node.values, local);
+}
+
+SdfSample sample_sdf_with_gradient (const SdfOctreeView& scene, const LiteMath::float3& p) {
+    LiteMath::float3 min_corner;
+    float voxel_size = 0.0f;
+    const SdfOctreeNode& node = scene [find_leaf (scene, p, min_corner, voxel_size)];
+
+    return interpolate_trilinear_with_gradient (node.values, (p - min_corner) / voxel_size, voxel_size);
+}
+
+SdfOctreeDescriptorSetInfo create_sdf_octree_descriptor_set (
+        VkDevice device
+        , VkPhysicalDevice physical_device
+        , const sdf_raster::SdfOctreeView& octree
+        , std::shared_ptr <vk_utils::ICopyEngine> copy_helper
+        , vk_utils::DescriptorMaker& ds_maker
+        , VkShaderStageFlags shader_stage_flags) {
+    return create_sdf_octree_descriptor_set (device
+            , physical_device
+            , octree.data ()
+            , octree.size () * sizeof (SdfOctreeNode)
+            , copy_helper
+            , ds_maker
+            , shader_stage_flags);
 }
 
 SdfOctreeDescriptorSetInfo create_sdf_octree_descriptor_set (
         VkDevice device
         , VkPhysicalDevice physical_device
-        , const sdf_raster::SdfOctree& octree
+        , const void* nodes
+        , VkDeviceSize nodes_size
         , std::shared_ptr <vk_utils::ICopyEngine> copy_helper
         , vk_utils::DescriptorMaker& ds_maker
         , VkShaderStageFlags shader_stage_flags) {
@@ -107,7 +253,7 @@ SdfOctreeDescriptorSetInfo create_sdf_octree_descriptor_set (
         throw std::runtime_error("ICopyEngine shared_ptr cannot be null.");
     }
 
-    VkDeviceSize octreeNodesSize = octree.nodes.size () * sizeof (SdfOctreeNode);
+    VkDeviceSize octreeNodesSize = nodes_size;
 
     if (octreeNodesSize == 0) {
         throw std::runtime_error ("SdfOctree is empty, cannot create descriptor set.");
@@ -127,7 +273,7 @@ SdfOctreeDescriptorSetInfo create_sdf_octree_descriptor_set (
             device, physical_device, {octreeBuffer}
             );
 
-    copy_helper->UpdateBuffer (info.nodes_buffer, 0, octree.nodes.data (), octreeNodesSize);
+    copy_helper->UpdateBuffer (info.nodes_buffer, 0, nodes, octreeNodesSize);
 
     ds_maker.BindBegin (shader_stage_flags);
     ds_maker.BindBuffer (0, info.nodes_buffer, VK_NULL_HANDLE, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <vector>
@@ -16,10 +17,118 @@ struct SdfOctree {
   std::vector <SdfOctreeNode> nodes;
 };
 
+// Read-only span over octree nodes. Does not own the memory: nodes either live in an
+// SdfOctree or in a memory-mapped .octree file (see MappedSdfOctree).
+struct SdfOctreeView {
+  SdfOctreeView () = default;
+  SdfOctreeView (const SdfOctreeNode* a_nodes, size_t a_count) : nodes (a_nodes), count (a_count) {}
+  SdfOctreeView (const SdfOctree& octree) : nodes (octree.nodes.data ()), count (octree.nodes.size ()) {}
+
+  const SdfOctreeNode& operator [] (size_t i) const { return nodes [i]; }
+  const SdfOctreeNode* data () const { return nodes; }
+  const SdfOctreeNode* begin () const { return nodes; }
+  const SdfOctreeNode* end () const { return nodes + count; }
+  size_t size () const { return count; }
+  bool empty () const { return count == 0; }
+
+  const SdfOctreeNode* nodes = nullptr;
+  size_t count = 0;
+};
+
+enum class SdfOctreeAccessPattern {
+  Default,
+  Random,     // MADV_RANDOM: root-to-leaf queries, disables read-ahead
+  Sequential, // MADV_SEQUENTIAL: full scans (traversal, GPU upload)
+};
+
+struct SdfOctreeMappingOptions {
+  bool populate = false;   // MAP_POPULATE: prefault the whole file on open instead of paging in lazily
+  bool huge_pages = false; // MADV_HUGEPAGE: back the mapping with transparent huge pages where the kernel allows it
+  SdfOctreeAccessPattern access_pattern = SdfOctreeAccessPattern::Default;
+};
+
+// Zero-copy .octree loader: maps the file read-only, so opening is O(1) and nodes are paged in on first access.
+class MappedSdfOctree {
+public:
+  MappedSdfOctree () = default;
+  explicit MappedSdfOctree (const std::string& path, const SdfOctreeMappingOptions& options = {});
+  ~MappedSdfOctree ();
+
+  MappedSdfOctree (const MappedSdfOctree&) = delete;
+  MappedSdfOctree& operator = (const MappedSdfOctree&) = delete;
+  MappedSdfOctree (MappedSdfOctree&& other) noexcept;
+  MappedSdfOctree& operator = (MappedSdfOctree&& other) noexcept;
+
+  SdfOctreeView view () const { return this->nodes; }
+  operator SdfOctreeView () const { return this->nodes; }
+  bool is_open () const { return this->mapping != nullptr; }
+
+  void close ();
+
+private:
+  void* mapping = nullptr;
+  size_t mapping_size = 0;
+  SdfOctreeView nodes {};
+};
+
+// Descends from the root to the leaf containing p. Works for any octree whose nodes expose `offset`.
+template <typename Octree>
+size_t find_leaf (const Octree& scene, const LiteMath::float3& p, LiteMath::float3& min_corner, float& voxel_size) {
+    size_t index = 0;
+    min_corner = {-1.0f, -1.0f, -1.0f};
+    voxel_size = 2.0f;
+
+    while (scene [index].offset != 0) {
+        float half = voxel_size * 0.5f;
+        unsigned child_index = 0;
+        if (p.x >= min_corner.x + half) child_index |= 1, min_corner.x += half;
+        if (p.y >= min_corner.y + half) child_index |= 2, min_corner.y += half;
+        if (p.z >= min_corner.z + half) child_index |= 4, min_corner.z += half;
+        voxel_size = half;
+        index = scene [index].offset + child_index;
+    }
+
+    return index;
+}
+
+inline void load_node_values (const SdfOctreeNode& node, float (&values) [8]) {
+    for (int i = 0; i < 8; ++i) {
+        values [i] = node.values [i];
+    }
+}
+
+struct SdfSample {
+  float distance;
+  LiteMath::float3 gradient; // analytic gradient of the leaf's trilinear patch, in world units
+};
+
+float interpolate_trilinear (const float (&values) [8], const LiteMath::float3& local);
+SdfSample interpolate_trilinear_with_gradient (const float (&values) [8], const LiteMath::float3& local, float voxel_size);
+
+// Node orders for reorder_sdf_octree. Siblings always stay contiguous (offset + child_index),
+// so the layouts differ in how whole sibling groups are arranged.
+enum class SdfOctreeLayout {
+  DepthFirst,      // pre-order: a group is followed by the groups of its descendants
+  BreadthFirstHot, // the top `hot_levels` levels packed breadth-first, then each remaining subtree depth-first
+  VanEmdeBoas,     // recursive split by height: cache-oblivious, every root-to-leaf walk touches O(log_B N) blocks
+};
+
+// Rewrites node order and offsets. Nodes unreachable from the root are dropped.
+void reorder_sdf_octree (const SdfOctreeView& scene, SdfOctree& reordered, SdfOctreeLayout layout, unsigned hot_levels = 4);
+
 void load_sdf_octree (SdfOctree &scene, const std::string &path);
-void save_sdf_octree (const SdfOctree &scene, const std::string &path);
-void dump_sdf_octree_text (const SdfOctree &scene, const std::string &path_to_dump);
-float sample_sdf (const SdfOctree& scene, const LiteMath::float3& p);
+void save_sdf_octree (const SdfOctreeView &scene, const std::string &path);
+void save_sdf_octree (const SdfOctreeView &scene, const std::string &path, SdfOctreeLayout layout);
+void dump_sdf_octree_text (const SdfOctreeView &scene, const std::string &path_to_dump);
+float sample_sdf (const SdfOctreeView& scene, const LiteMath::float3& p);
+// Value and gradient from a single descent, replacing 6-tap central differences.
+SdfSample sample_sdf_with_gradient (const SdfOctreeView& scene, const LiteMath::float3& p);
+
+// Samples `count` points given as SoA coordinates. On x86 the points descend the tree 16 (AVX-512) or
+// 8 (AVX2) at a time in lockstep, chosen at runtime; elsewhere it falls back to sample_sdf per point.
+// Results are bit-identical to sample_sdf.
+void sample_sdf_batch (const SdfOctreeView& scene, const float* xs, const float* ys, const float* zs, float* distances, size_t count);
+void sample_sdf_batch (const SdfOctreeView& scene, const std::vector <LiteMath::float3>& points, std::vector <float>& distances);
 
 struct SdfOctreeDescriptorSetInfo {
   VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
@@ -32,7 +141,17 @@ struct SdfOctreeDescriptorSetInfo {
 SdfOctreeDescriptorSetInfo create_sdf_octree_descriptor_set (
     VkDevice device
     , VkPhysicalDevice physical_device
-    , const sdf_raster::SdfOctree& octree
+    , const sdf_raster::SdfOctreeView& octree
+    , std::shared_ptr <vk_utils::ICopyEngine> copy_helper
+    , vk_utils::DescriptorMaker& ds_maker
+    , VkShaderStageFlags shader_stage_flags);
+
+// Uploads an arbitrary node array (any of the layouts in shaders/common.h) as the octree storage buffer.
+SdfOctreeDescriptorSetInfo create_sdf_octree_descriptor_set (
+    VkDevice device
+    , VkPhysicalDevice physical_device
+    , const void* nodes
+    , VkDeviceSize nodes_size
     , std::shared_ptr <vk_utils::ICopyEngine> copy_helper
     , vk_utils::DescriptorMaker& ds_maker
     , VkShaderStageFlags shader_stage_flags);
@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <stdexcept>
+
+#if defined (__x86_64__) || defined (__i386__)
+#include <immintrin.h>
+#define SDF_RASTER_X86_SIMD 1
+#endif
+
+#include "sdf_octree.hpp"
+
+namespace sdf_raster {
+
+namespace {
+
+constexpr int NODE_STRIDE = sizeof (SdfOctreeNode) / sizeof (float);
+constexpr int OFFSET_FIELD = offsetof (SdfOctreeNode, offset) / sizeof (float);
+constexpr size_t AOS_CHUNK = 256;
+
+static_assert (sizeof (SdfOctreeNode) % sizeof (float) == 0, "gathers address nodes in float units");
+
+void sample_sdf_batch_scalar (const SdfOctreeView& scene, const float* xs, const float* ys, const float* zs, float* distances, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        distances [i] = sample_sdf (scene, {xs [i], ys [i], zs [i]});
+    }
+}
+
+#ifdef SDF_RASTER_X86_SIMD
+
+__attribute__ ((target ("avx2")))
+inline __m256 lerp (__m256 a, __m256 b, __m256 t) {
+    return _mm256_add_ps (a, _mm256_mul_ps (t, _mm256_sub_ps (b, a)));
+}
+
+// GCC's AVX-512 headers start several intrinsics from _mm512_undefined_*, which trips -Wmaybe-uninitialized.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+// AVX-512 implies FMA, and the compiler would fuse a separate mul and add. The explicit-rounding forms
+// are never contracted, which keeps the results identical to the scalar path.
+constexpr int ROUND_NEAREST = _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC;
+
+__attribute__ ((target ("avx512f")))
+inline __m512 lerp (__m512 a, __m512 b, __m512 t) {
+    return _mm512_add_round_ps (a, _mm512_mul_round_ps (t, _mm512_sub_round_ps (b, a, ROUND_NEAREST), ROUND_NEAREST), ROUND_NEAREST);
+}
+
+// Lanes walk root-to-leaf in lockstep; a lane that reached its leaf keeps its state until the slowest lane
+// arrives. The arithmetic mirrors sample_sdf operation by operation, so results are bit-identical.
+__attribute__ ((target ("avx2")))
+void sample_sdf_batch_avx2 (const SdfOctreeView& scene, const float* xs, const float* ys, const float* zs, float* distances, size_t count) {
+    const float* base = reinterpret_cast <const float*> (scene.data ());
+    const __m256i stride = _mm256_set1_epi32 (NODE_STRIDE);
+    const __m256i offset_field = _mm256_set1_epi32 (OFFSET_FIELD);
+    const __m256i zero = _mm256_setzero_si256 ();
+    const __m256i ones = _mm256_set1_epi32 (-1);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 px = _mm256_loadu_ps (xs + i);
+        const __m256 py = _mm256_loadu_ps (ys + i);
+        const __m256 pz = _mm256_loadu_ps (zs + i);
+
+        __m256 min_x = _mm256_set1_ps (-1.0f);
+        __m256 min_y = _mm256_set1_ps (-1.0f);
+        __m256 min_z = _mm256_set1_ps (-1.0f);
+        __m256 size = _mm256_set1_ps (2.0f);
+        __m256i node = zero;
+
+        for (;;) {
+            const __m256i field = _mm256_add_epi32 (_mm256_mullo_epi32 (node, stride), offset_field);
+            const __m256i offset = _mm256_i32gather_epi32 (reinterpret_cast <const int*> (base), field, 4);
+            const __m256i is_leaf = _mm256_cmpeq_epi32 (offset, zero);
+            if (_mm256_movemask_ps (_mm256_castsi256_ps (is_leaf)) == 0xff) {
+                break;
+            }
+            const __m256 active = _mm256_castsi256_ps (_mm256_xor_si256 (is_leaf, ones));
+
+            const __m256 half = _mm256_mul_ps (size, _mm256_set1_ps (0.5f));
+            const __m256 mid_x = _mm256_add_ps (min_x, half);
+            const __m256 mid_y = _mm256_add_ps (min_y, half);
+            const __m256 mid_z = _mm256_add_ps (min_z, half);
+            const __m256 upper_x = _mm256_and_ps (_mm256_cmp_ps (px, mid_x, _CMP_GE_OQ), active);
+            const __m256 upper_y = _mm256_and_ps (_mm256_cmp_ps (py, mid_y, _CMP_GE_OQ), active);
+            const __m256 upper_z = _mm256_and_ps (_mm256_cmp_ps (pz, mid_z, _CMP_GE_OQ), active);
+            min_x = _mm256_blendv_ps (min_x, mid_x, upper_x);
+            min_y = _mm256_blendv_ps (min_y, mid_y, upper_y);
+            min_z = _mm256_blendv_ps (min_z, mid_z, upper_z);
+
+            __m256i child = _mm256_and_si256 (_mm256_castps_si256 (upper_x), _mm256_set1_epi32 (1));
+            child = _mm256_or_si256 (child, _mm256_and_si256 (_mm256_castps_si256 (upper_y), _mm256_set1_epi32 (2)));
+            child = _mm256_or_si256 (child, _mm256_and_si256 (_mm256_castps_si256 (upper_z), _mm256_set1_epi32 (4)));
+
+            node = _mm256_castps_si256 (_mm256_blendv_ps (_mm256_castsi256_ps (node)
+                        , _mm256_castsi256_ps (_mm256_add_epi32 (offset, child))
+                        , active));
+            size = _mm256_blendv_ps (size, half, active);
+        }
+
+        const __m256i first_value = _mm256_mullo_epi32 (node, stride);
+        __m256 v [8];
+        for (int c = 0; c < 8; ++c) {
+            v [c] = _mm256_i32gather_ps (base, _mm256_add_epi32 (first_value, _mm256_set1_epi32 (c)), 4);
+        }
+
+        const __m256 local_x = _mm256_div_ps (_mm256_sub_ps (px, min_x), size);
+        const __m256 local_y = _mm256_div_ps (_mm256_sub_ps (py, min_y), size);
+        const __m256 local_z = _mm256_div_ps (_mm256_sub_ps (pz, min_z), size);
+
+        const __m256 c00 = lerp (v [0], v [1], local_x);
+        const __m256 c01 = lerp (v [4], v [5], local_x);
+        const __m256 c10 = lerp (v [2], v [3], local_x);
+        const __m256 c11 = lerp (v [6], v [7], local_x);
+        const __m256 c0 = lerp (c00, c10, local_y);
+        const __m256 c1 = lerp (c01, c11, local_y);
+        _mm256_storeu_ps (distances + i, lerp (c0, c1, local_z));
+    }
+
+    sample_sdf_batch_scalar (scene, xs + i, ys + i, zs + i, distances + i, count - i);
+}
+
+__attribute__ ((target ("avx512f")))
+void sample_sdf_batch_avx512 (const SdfOctreeView& scene, const float* xs, const float* ys, const float* zs, float* distances, size_t count) {
+    const float* base = reinterpret_cast <const float*> (scene.data ());
+    const __m512i stride = _mm512_set1_epi32 (NODE_STRIDE);
+    const __m512i offset_field = _mm512_set1_epi32 (OFFSET_FIELD);
+    const __m512i zero = _mm512_setzero_si512 ();
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m512 px = _mm512_loadu_ps (xs + i);
+        const __m512 py = _mm512_loadu_ps (ys + i);
+        const __m512 pz = _mm512_loadu_ps (zs + i);
+
+        __m512 min_x = _mm512_set1_ps (-1.0f);
+        __m512 min_y = _mm512_set1_ps (-1.0f);
+        __m512 min_z = _mm512_set1_ps (-1.0f);
+        __m512 size = _mm512_set1_ps (2.0f);
+        __m512i node = zero;
+
+        for (;;) {
+            const __m512i field = _mm512_add_epi32 (_mm512_mullo_epi32 (node, stride), offset_field);
+            const __m512i offset = _mm512_i32gather_epi32 (field, base, 4);
+            const __mmask16 active = _mm512_cmpneq_epi32_mask (offset, zero);
+            if (active == 0) {
+                break;
+            }
+
+            const __m512 half = _mm512_mul_round_ps (size, _mm512_set1_ps (0.5f), ROUND_NEAREST);
+            const __m512 mid_x = _mm512_add_round_ps (min_x, half, ROUND_NEAREST);
+            const __m512 mid_y = _mm512_add_round_ps (min_y, half, ROUND_NEAREST);
+            const __m512 mid_z = _mm512_add_round_ps (min_z, half, ROUND_NEAREST);
+            const __mmask16 upper_x = _mm512_mask_cmp_ps_mask (active, px, mid_x, _CMP_GE_OQ);
+            const __mmask16 upper_y = _mm512_mask_cmp_ps_mask (active, py, mid_y, _CMP_GE_OQ);
+            const __mmask16 upper_z = _mm512_mask_cmp_ps_mask (active, pz, mid_z, _CMP_GE_OQ);
+            min_x = _mm512_mask_blend_ps (upper_x, min_x, mid_x);
+            min_y = _mm512_mask_blend_ps (upper_y, min_y, mid_y);
+            min_z = _mm512_mask_blend_ps (upper_z, min_z, mid_z);
+
+            __m512i child = _mm512_maskz_mov_epi32 (upper_x, _mm512_set1_epi32 (1));
+            child = _mm512_mask_or_epi32 (child, upper_y, child, _mm512_set1_epi32 (2));
+            child = _mm512_mask_or_epi32 (child, upper_z, child, _mm512_set1_epi32 (4));
+
+            node = _mm512_mask_add_epi32 (node, active, offset, child);
+            size = _mm512_mask_mov_ps (size, active, half);
+        }
+
+        const __m512i first_value = _mm512_mullo_epi32 (node, stride);
+        __m512 v [8];
+        for (int c = 0; c < 8; ++c) {
+            v [c] = _mm512_i32gather_ps (_mm512_add_epi32 (first_value, _mm512_set1_epi32 (c)), base, 4);
+        }
+
+        const __m512 local_x = _mm512_div_round_ps (_mm512_sub_round_ps (px, min_x, ROUND_NEAREST), size, ROUND_NEAREST);
+        const __m512 local_y = _mm512_div_round_ps (_mm512_sub_round_ps (py, min_y, ROUND_NEAREST), size, ROUND_NEAREST);
+        const __m512 local_z = _mm512_div_round_ps (_mm512_sub_round_ps (pz, min_z, ROUND_NEAREST), size, ROUND_NEAREST);
+
+        const __m512 c00 = lerp (v [0], v [1], local_x);
+        const __m512 c01 = lerp (v [4], v [5], local_x);
+        const __m512 c10 = lerp (v [2], v [3], local_x);
+        const __m512 c11 = lerp (v [6], v [7], local_x);
+        const __m512 c0 = lerp (c00, c10, local_y);
+        const __m512 c1 = lerp (c01, c11, local_y);
+        _mm512_storeu_ps (distances + i, lerp (c0, c1, local_z));
+    }
+
+    sample_sdf_batch_avx2 (scene, xs + i, ys + i, zs + i, distances + i, count - i);
+}
+
+#pragma GCC diagnostic pop
+
+#endif // SDF_RASTER_X86_SIMD
+
+}
+
+void sample_sdf_batch (const SdfOctreeView& scene, const float* xs, const float* ys, const float* zs, float* distances, size_t count) {
+    if (scene.empty ()) {
+        throw std::runtime_error {"[sample_sdf_batch]: empty sdf"};
+    }
+
+#ifdef SDF_RASTER_X86_SIMD
+    // Gathers use 32-bit float indices into the node array.
+    if (scene.size () < static_cast <size_t> (INT_MAX / NODE_STRIDE)) {
+        static const bool has_avx512 = __builtin_cpu_supports ("avx512f");
+        static const bool has_avx2 = __builtin_cpu_supports ("avx2");
+        if (has_avx512) {
+            sample_sdf_batch_avx512 (scene, xs, ys, zs, distances, count);
+            return;
+        }
+        if (has_avx2) {
+            sample_sdf_batch_avx2 (scene, xs, ys, zs, distances, count);
+            return;
+        }
+    }
+#endif
+
+    sample_sdf_batch_scalar (scene, xs, ys, zs, distances, count);
+}
+
+void sample_sdf_batch (const SdfOctreeView& scene, const std::vector <LiteMath::float3>& points, std::vector <float>& distances) {
+    distances.resize (points.size ());
+
+    float xs [AOS_CHUNK], ys [AOS_CHUNK], zs [AOS_CHUNK];
+    for (size_t first = 0; first < points.size (); first += AOS_CHUNK) {
+        const size_t count = std::min (AOS_CHUNK, points.size () - first);
+        for (size_t i = 0; i < count; ++i) {
+            xs [i] = points [first + i].x;
+            ys [i] = points [first + i].y;
+            zs [i] = points [first + i].z;
+        }
+        sample_sdf_batch (scene, xs, ys, zs, distances.data () + first, count);
+    }
+}
+
+}
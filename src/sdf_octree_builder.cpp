@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "sdf_octree_builder.hpp"
+
+namespace sdf_raster {
+
+namespace {
+
+// Cells evaluated as one batch: 19 points each, enough lanes to amortize a call of the distance function.
+constexpr size_t CELL_GRAIN = 256;
+constexpr size_t RANGE_GRAIN = 1 << 14;
+constexpr unsigned int MAX_DEPTH = 20;
+constexpr int LATTICE_POINTS = 27;
+constexpr int CENTER = 13;
+
+// Lattice point i + 3 j + 9 k sits at (i, j, k) / 2 of the cell; corner c (x | y << 1 | z << 2) at lattice point
+// 2 (x + 3 y + 9 z).
+constexpr int corner_lattice_point (int corner) {
+    return 2 * ((corner & 1) + 3 * ((corner >> 1) & 1) + 9 * ((corner >> 2) & 1));
+}
+
+bool is_corner (int point) {
+    return point % 3 != 1 && point / 3 % 3 != 1 && point / 9 != 1;
+}
+
+// The 19 points that are not corners, and the weights of the corners in the trilinear patch at each of them.
+struct LatticeTables {
+  LatticeTables () {
+      for (int point = 0; point < LATTICE_POINTS; ++point) {
+          if (is_corner (point)) {
+              continue;
+          }
+          const float t [3] = {0.5f * (point % 3), 0.5f * (point / 3 % 3), 0.5f * (point / 9)};
+          for (int corner = 0; corner < 8; ++corner) {
+              float weight = 1.0f;
+              for (int axis = 0; axis < 3; ++axis) {
+                  weight *= (corner >> axis) & 1 ? t [axis] : 1.0f - t [axis];
+              }
+              this->weights [this->count] [corner] = weight;
+          }
+          this->points [this->count++] = point;
+      }
+  }
+
+  std::array <int, 19> points {};
+  float weights [19] [8] = {};
+  int count = 0;
+};
+
+const LatticeTables& lattice_tables () {
+    static const LatticeTables tables;
+    return tables;
+}
+
+// Cell of the level being split, at integer coordinates among the 2^depth cells per axis.
+struct Cell {
+  uint32_t node;
+  uint32_t x, y, z;
+};
+
+// Children a batch of cells produced: eight nodes per split cell, in cell order.
+struct BatchOutput {
+  std::vector <uint32_t> parents;
+  std::vector <SdfOctreeNode> nodes;
+  std::vector <Cell> cells;
+};
+
+struct BatchScratch {
+  std::vector <float> xs, ys, zs, distances;
+};
+
+}
+
+SdfOctreeBuildStats build_sdf_octree (const SdfDistanceFunction& distance, SdfOctree& octree, const SdfOctreeBuildSettings& settings) {
+    if (settings.max_depth > MAX_DEPTH) {
+        throw std::runtime_error {"[build_sdf_octree]: max_depth is at most " + std::to_string (MAX_DEPTH)};
+    }
+    if (!(settings.max_error >= 0.0f)) {
+        throw std::runtime_error {"[build_sdf_octree]: negative max_error"};
+    }
+    Executor& executor = settings.get_executor ();
+    const unsigned int concurrency = static_cast <unsigned int> (std::max (1, settings.max_threads));
+    const LatticeTables& tables = lattice_tables ();
+
+    SdfOctreeBuildStats stats;
+    octree.nodes.assign (1, SdfOctreeNode {});
+    {
+        float xs [8], ys [8], zs [8];
+        for (int corner = 0; corner < 8; ++corner) {
+            xs [corner] = corner & 1 ? 1.0f : -1.0f;
+            ys [corner] = corner & 2 ? 1.0f : -1.0f;
+            zs [corner] = corner & 4 ? 1.0f : -1.0f;
+        }
+        distance (xs, ys, zs, octree.nodes [0].values, 8);
+        octree.nodes [0].offset = 0;
+        stats.evaluations += 8;
+    }
+
+    std::vector <Cell> cells {{0, 0, 0, 0}};
+    std::vector <BatchScratch> scratch (concurrency);
+    for (unsigned int depth = 0; depth < settings.max_depth && !cells.empty (); ++depth) {
+        const float size = std::ldexp (2.0f, -int (depth));
+        const float half_diagonal = 0.5f * std::sqrt (3.0f) * size;
+        const bool forced = depth < settings.min_depth;
+
+        const size_t batch_count = (cells.size () + CELL_GRAIN - 1) / CELL_GRAIN;
+        std::vector <BatchOutput> batches (batch_count);
+        parallel_for (executor, concurrency, cells.size (), CELL_GRAIN, [&] (size_t first, size_t last, unsigned int slot) {
+            BatchScratch& batch = scratch [slot];
+            const size_t points = tables.count * (last - first);
+            batch.xs.resize (points);
+            batch.ys.resize (points);
+            batch.zs.resize (points);
+            batch.distances.resize (points);
+            for (size_t c = first; c < last; ++c) {
+                const Cell& cell = cells [c];
+                const float min_x = -1.0f + size * cell.x;
+                const float min_y = -1.0f + size * cell.y;
+                const float min_z = -1.0f + size * cell.z;
+                for (int i = 0; i < tables.count; ++i) {
+                    const int point = tables.points [i];
+                    const size_t k = tables.count * (c - first) + i;
+                    batch.xs [k] = min_x + 0.5f * size * (point % 3);
+                    batch.ys [k] = min_y + 0.5f * size * (point / 3 % 3);
+                    batch.zs [k] = min_z + 0.5f * size * (point / 9);
+                }
+            }
+            distance (batch.xs.data (), batch.ys.data (), batch.zs.data (), batch.distances.data (), points);
+
+            BatchOutput& out = batches [first / CELL_GRAIN];
+            for (size_t c = first; c < last; ++c) {
+                const Cell& cell = cells [c];
+                const float* corners = octree.nodes [cell.node].values;
+                const float* values = batch.distances.data () + tables.count * (c - first);
+
+                float lattice [LATTICE_POINTS];
+                float error = 0.0f;
+                for (int corner = 0; corner < 8; ++corner) {
+                    lattice [corner_lattice_point (corner)] = corners [corner];
+                }
+                for (int i = 0; i < tables.count; ++i) {
+                    float patch = 0.0f;
+                    for (int corner = 0; corner < 8; ++corner) {
+                        patch += tables.weights [i] [corner] * corners [corner];
+                    }
+                    lattice [tables.points [i]] = values [i];
+                    error = std::max (error, std::fabs (values [i] - patch));
+                }
+
+                const bool near = std::fabs (lattice [CENTER]) <= half_diagonal;
+                if (!near || (!forced && !(error > settings.max_error))) {
+                    continue;
+                }
+
+                out.parents.push_back (cell.node);
+                for (int child = 0; child < 8; ++child) {
+                    const int base = (child & 1) + 3 * ((child >> 1) & 1) + 9 * ((child >> 2) & 1);
+                    SdfOctreeNode node {};
+                    for (int corner = 0; corner < 8; ++corner) {
+                        node.values [corner] = lattice [base + corner_lattice_point (corner) / 2];
+                    }
+                    node.offset = 0;
+                    out.nodes.push_back (node);
+                    out.cells.push_back ({0, 2 * cell.x + (child & 1), 2 * cell.y + ((child >> 1) & 1), 2 * cell.z + ((child >> 2) & 1)});
+                }
+            }
+        });
+        stats.evaluations += tables.count * cells.size ();
+
+        std::vector <size_t> bases (batch_count + 1, 0);
+        bases [0] = octree.nodes.size ();
+        for (size_t b = 0; b < batch_count; ++b) {
+            bases [b + 1] = bases [b] + batches [b].nodes.size ();
+        }
+        if (bases [batch_count] >= std::numeric_limits <uint32_t>::max ()) {
+            throw std::runtime_error {"[build_sdf_octree]: too many nodes"};
+        }
+
+        const size_t level_base = bases [0];
+        octree.nodes.resize (bases [batch_count]);
+        cells.resize (bases [batch_count] - level_base);
+        parallel_for (executor, concurrency, batch_count, 1, [&] (size_t first, size_t last, unsigned int) {
+            for (size_t b = first; b < last; ++b) {
+                BatchOutput& out = batches [b];
+                for (size_t j = 0; j < out.parents.size (); ++j) {
+                    octree.nodes [out.parents [j]].offset = static_cast <uint32_t> (bases [b] + 8 * j);
+                }
+                std::copy (out.nodes.begin (), out.nodes.end (), octree.nodes.begin () + bases [b]);
+                for (size_t j = 0; j < out.cells.size (); ++j) {
+                    Cell& cell = cells [bases [b] - level_base + j];
+                    cell = out.cells [j];
+                    cell.node = static_cast <uint32_t> (bases [b] + j);
+                }
+                out = {};
+            }
+        });
+        if (!cells.empty ()) {
+            stats.depth = depth + 1;
+        }
+    }
+
+    stats.nodes = octree.nodes.size ();
+    stats.leaves = stats.nodes - (stats.nodes - 1) / 8;
+    return stats;
+}
+
+SdfOctreeBuildStats build_sdf_octree (const SdfProgram& program, SdfOctree& octree, const SdfOctreeBuildSettings& settings) {
+    return build_sdf_octree ([&program] (const float* xs, const float* ys, const float* zs, float* distances, size_t count) {
+        program.evaluate (xs, ys, zs, distances, count);
+    }, octree, settings);
+}
+
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+#include "executor.hpp"
+#include "sdf_expression.hpp"
+#include "sdf_octree.hpp"
+
+namespace sdf_raster {
+
+// Signed distances at `count` points given as SoA coordinates in the octree's [-1, 1]^3. Called from several threads
+// at once. Magnitudes may fall short of the distance to the surface, as they do after CSG, but must not exceed it, or
+// cells the surface crosses may be left unsplit.
+using SdfDistanceFunction = std::function <void (const float* xs, const float* ys, const float* zs, float* distances, size_t count)>;
+
+struct SdfOctreeBuildSettings : ParallelSettings {
+  unsigned int max_depth = 8;   // leaves are at most this deep; the root is depth 0
+  unsigned int min_depth = 3;   // cells the surface may cross are split at least this deep, whatever the error
+  float max_error = 1e-3f;      // largest difference, in octree units, between the field and a leaf's trilinear patch
+};
+
+struct SdfOctreeBuildStats {
+  size_t nodes = 0;
+  size_t leaves = 0;
+  size_t evaluations = 0;       // points the distance function was called for
+  unsigned int depth = 0;       // depth of the deepest leaf
+};
+
+// Builds `octree` over [-1, 1]^3 top-down, one level at a time. A cell is split when it is shallower than max_depth,
+// the surface may cross it (|distance at its center| is at most half its diagonal), and it is shallower than
+// min_depth or the field strays from the cell's trilinear patch by more than max_error at one of the 19 points of the
+// 3x3x3 lattice that are not its corners. The lattice holds the corners of the children, so every point is evaluated
+// once. Cells of a level are evaluated in parallel batches and their children appended in order, so nodes come out
+// breadth-first and the octree is the same for any max_threads.
+SdfOctreeBuildStats build_sdf_octree (const SdfDistanceFunction& distance, SdfOctree& octree, const SdfOctreeBuildSettings& settings = {});
+SdfOctreeBuildStats build_sdf_octree (const SdfProgram& program, SdfOctree& octree, const SdfOctreeBuildSettings& settings = {});
+
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "sdf_octree.hpp"
+#include "sdf_octree_quantized.hpp"
+#include "sdf_octree_shared.hpp"
+
+namespace sdf_raster {
+
+// Uniform node access for code templated over the octree formats. Only SharedCornerSdfOctree keeps corners
+// per sibling group, so traversals carry the group's lattice and the child slot along; other formats ignore them.
+template <typename Octree>
+uint32_t children_lattice (const Octree&, size_t) {
+    return 0;
+}
+
+inline uint32_t children_lattice (const SharedCornerSdfOctree& scene, size_t node_index) {
+    return scene [node_index].lattice;
+}
+
+template <typename Octree>
+void load_node_values (const Octree& scene, size_t node_index, uint32_t, uint32_t, float (&values) [8]) {
+    load_node_values (scene [node_index], values);
+}
+
+inline void load_node_values (const SharedCornerSdfOctree& scene, size_t, uint32_t lattice, uint32_t child_slot, float (&values) [8]) {
+    load_node_values (scene, lattice, child_slot, values);
+}
+
+}
@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "sdf_octree.hpp"
+
+namespace sdf_raster {
+
+namespace {
+
+constexpr uint32_t NO_GROUP = ~0u;
+
+// Sibling groups are the unit of reordering: group 0 is the root alone, every other group is the
+// 8 children of one internal node.
+struct GroupTree {
+    std::vector <uint32_t> first;        // first node of the group in the source order
+    std::vector <uint32_t> count;        // 1 for the root group, 8 otherwise
+    std::vector <uint32_t> child_group;  // per source node: group of its children, NO_GROUP for leaves
+    std::vector <uint32_t> height;       // levels of groups in the subtree, 1 for groups of leaves only
+};
+
+GroupTree build_group_tree (const SdfOctreeView& scene) {
+    GroupTree tree;
+    tree.child_group.assign (scene.size (), NO_GROUP);
+    tree.first.push_back (0);
+    tree.count.push_back (1);
+
+    // Breadth-first, so every group is discovered after its parent group.
+    for (uint32_t g = 0; g < tree.first.size (); ++g) {
+        for (uint32_t n = tree.first [g]; n < tree.first [g] + tree.count [g]; ++n) {
+            const uint32_t offset = scene [n].offset;
+            if (offset == 0) {
+                continue;
+            }
+            if (static_cast <size_t> (offset) + 8 > scene.size ()) {
+                throw std::runtime_error {"[reorder_sdf_octree]: out of bounds."};
+            }
+            if (tree.child_group [n] != NO_GROUP) {
+                throw std::runtime_error {"[reorder_sdf_octree]: node is reachable twice."};
+            }
+            tree.child_group [n] = static_cast <uint32_t> (tree.first.size ());
+            tree.first.push_back (offset);
+            tree.count.push_back (8);
+        }
+    }
+
+    tree.height.assign (tree.first.size (), 1);
+    for (size_t g = tree.first.size (); g-- > 0;) {
+        for (uint32_t n = tree.first [g]; n < tree.first [g] + tree.count [g]; ++n) {
+            if (tree.child_group [n] != NO_GROUP) {
+                tree.height [g] = std::max (tree.height [g], tree.height [tree.child_group [n]] + 1);
+            }
+        }
+    }
+
+    return tree;
+}
+
+template <typename Visitor>
+void for_each_child_group (const GroupTree& tree, uint32_t group, Visitor&& visit) {
+    for (uint32_t n = tree.first [group]; n < tree.first [group] + tree.count [group]; ++n) {
+        if (tree.child_group [n] != NO_GROUP) {
+            visit (tree.child_group [n]);
+        }
+    }
+}
+
+void emit_depth_first (const GroupTree& tree, uint32_t root, std::vector <uint32_t>& order) {
+    std::vector <uint32_t> stack {root};
+    while (!stack.empty ()) {
+        const uint32_t group = stack.back ();
+        stack.pop_back ();
+        order.push_back (group);
+
+        const size_t mark = stack.size ();
+        for_each_child_group (tree, group, [&] (uint32_t child) { stack.push_back (child); });
+        std::reverse (stack.begin () + mark, stack.end ());
+    }
+}
+
+void emit_breadth_first_hot (const GroupTree& tree, unsigned hot_levels, std::vector <uint32_t>& order) {
+    std::vector <uint32_t> level {0};
+    std::vector <uint32_t> cold_roots;
+    for (unsigned depth = 0; !level.empty (); ++depth) {
+        std::vector <uint32_t> next_level;
+        for (uint32_t group : level) {
+            if (depth < hot_levels) {
+                order.push_back (group);
+                for_each_child_group (tree, group, [&] (uint32_t child) { next_level.push_back (child); });
+            } else {
+                cold_roots.push_back (group);
+            }
+        }
+        level = std::move (next_level);
+    }
+
+    for (uint32_t group : cold_roots) {
+        emit_depth_first (tree, group, order);
+    }
+}
+
+// Groups exactly `depth` group-levels below `group`, left to right.
+void collect_groups_at_depth (const GroupTree& tree, uint32_t group, uint32_t depth, std::vector <uint32_t>& out) {
+    if (depth == 0) {
+        out.push_back (group);
+        return;
+    }
+    for_each_child_group (tree, group, [&] (uint32_t child) { collect_groups_at_depth (tree, child, depth - 1, out); });
+}
+
+void emit_van_emde_boas (const GroupTree& tree, uint32_t group, uint32_t height, std::vector <uint32_t>& order) {
+    height = std::min (height, tree.height [group]);
+    if (height <= 1) {
+        order.push_back (group);
+        return;
+    }
+
+    const uint32_t top_height = (height + 1) / 2;
+    emit_van_emde_boas (tree, group, top_height, order);
+
+    std::vector <uint32_t> bottom_roots;
+    collect_groups_at_depth (tree, group, top_height, bottom_roots);
+    for (uint32_t bottom : bottom_roots) {
+        emit_van_emde_boas (tree, bottom, height - top_height, order);
+    }
+}
+
+}
+
+void reorder_sdf_octree (const SdfOctreeView& scene, SdfOctree& reordered, SdfOctreeLayout layout, unsigned hot_levels) {
+    if (scene.empty ()) {
+        throw std::runtime_error {"[reorder_sdf_octree]: empty sdf"};
+    }
+
+    const GroupTree tree = build_group_tree (scene);
+
+    std::vector <uint32_t> order;
+    order.reserve (tree.first.size ());
+    switch (layout) {
+        case SdfOctreeLayout::DepthFirst:
+            emit_depth_first (tree, 0, order);
+            break;
+        case SdfOctreeLayout::BreadthFirstHot:
+            emit_breadth_first_hot (tree, hot_levels, order);
+            break;
+        case SdfOctreeLayout::VanEmdeBoas:
+            emit_van_emde_boas (tree, 0, tree.height [0], order);
+            break;
+    }
+
+    std::vector <uint32_t> new_first (tree.first.size ());
+    uint32_t cursor = 0;
+    for (uint32_t group : order) {
+        new_first [group] = cursor;
+        cursor += tree.count [group];
+    }
+
+    reordered.nodes.resize (cursor);
+    for (uint32_t group : order) {
+        for (uint32_t k = 0; k < tree.count [group]; ++k) {
+            const uint32_t source = tree.first [group] + k;
+            SdfOctreeNode node = scene [source];
+            node.offset = tree.child_group [source] == NO_GROUP ? 0 : new_first [tree.child_group [source]];
+            reordered.nodes [new_first [group] + k] = node;
+        }
+    }
+
+    if (reordered.nodes.size () != scene.size ()) {
+        printf ("[reorder_sdf_octree]: dropped %u unreachable nodes\n", (unsigned) (scene.size () - reordered.nodes.size ()));
+    }
+}
+
+void save_sdf_octree (const SdfOctreeView &scene, const std::string &path, SdfOctreeLayout layout) {
+    SdfOctree reordered;
+    reorder_sdf_octree (scene, reordered, layout);
+    save_sdf_octree (reordered, path);
+}
+
+}
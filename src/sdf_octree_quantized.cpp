@@ -0,0 +1,231 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+#include "executor.hpp"
+#include "sdf_octree_quantized.hpp"
+
+namespace sdf_raster {
+
+namespace {
+
+// f16 conversion that truncates towards zero; callers step one ulp outwards when they need a bound.
+uint32_t float_to_half_truncate (float value) {
+    uint32_t bits;
+    std::memcpy (&bits, &value, sizeof (float));
+
+    const uint32_t sign = (bits >> 16) & 0x8000u;
+    const int exponent = static_cast <int> ((bits >> 23) & 0xffu) - 127 + 15;
+    const uint32_t mantissa = bits & 0x7fffffu;
+
+    if (std::fabs (value) >= 65504.0f) {
+        return sign | 0x7bffu;
+    }
+    if (exponent <= 0) {
+        if (exponent < -10) {
+            return sign;
+        }
+        return sign | ((mantissa | 0x800000u) >> (14 - exponent));
+    }
+    return sign | (static_cast <uint32_t> (exponent) << 10) | (mantissa >> 13);
+}
+
+uint32_t float_to_half_round_down (float value) {
+    uint32_t h = float_to_half_truncate (value);
+    if (half_to_float (h) > value && (h & 0x7fffu) != 0x7bffu) {
+        ++h; // negative value: one ulp further from zero
+    }
+    return h;
+}
+
+uint32_t float_to_half_round_up (float value) {
+    uint32_t h = float_to_half_truncate (value);
+    if (half_to_float (h) < value && (h & 0x7fffu) != 0x7bffu) {
+        ++h; // positive value: one ulp further from zero
+    }
+    return h;
+}
+
+constexpr size_t CONVERSION_GRAIN = 4096;
+
+template <typename NodeT> struct QuantizationTraits;
+
+template <> struct QuantizationTraits <SdfOctreeNodeQ8> {
+    static constexpr uint32_t bits = 8;
+    static constexpr uint32_t levels = 0xffu;
+    static constexpr uint32_t per_word = 4;
+    static constexpr char magic [4] = {'S', 'Q', '0', '8'};
+};
+
+template <> struct QuantizationTraits <SdfOctreeNodeQ16> {
+    static constexpr uint32_t bits = 16;
+    static constexpr uint32_t levels = 0xffffu;
+    static constexpr uint32_t per_word = 2;
+    static constexpr char magic [4] = {'S', 'Q', '1', '6'};
+};
+
+template <typename NodeT>
+float quantize_node (const SdfOctreeNode& source, NodeT& node) {
+    using Traits = QuantizationTraits <NodeT>;
+
+    const float min_value = *std::min_element (std::begin (source.values), std::end (source.values));
+    const float max_value = *std::max_element (std::begin (source.values), std::end (source.values));
+
+    const uint32_t base_h = float_to_half_round_down (min_value);
+    const float base = half_to_float (base_h);
+    const uint32_t step_h = float_to_half_round_up ((max_value - base) / static_cast <float> (Traits::levels));
+    const float step = half_to_float (step_h);
+
+    node = {};
+    node.range = base_h | (step_h << 16);
+    node.offset = source.offset;
+
+    for (uint32_t i = 0; i < 8; ++i) {
+        uint32_t q = 0;
+        if (step > 0.0f) {
+            const float scaled = std::round ((source.values [i] - base) / step);
+            q = static_cast <uint32_t> (std::clamp (scaled, 0.0f, static_cast <float> (Traits::levels)));
+        }
+        node.values [i / Traits::per_word] |= q << ((i % Traits::per_word) * Traits::bits);
+    }
+
+    float decoded [8];
+    load_node_values (node, decoded);
+    float max_error = 0.0f;
+    for (int i = 0; i < 8; ++i) {
+        max_error = std::max (max_error, std::fabs (decoded [i] - source.values [i]));
+    }
+    return max_error;
+}
+
+template <typename NodeT>
+void quantize (const SdfOctreeView& scene, QuantizedSdfOctree <NodeT>& quantized) {
+    quantized.nodes.resize (scene.size ());
+
+    Executor& executor = Executor::shared ();
+    std::vector <float> slot_max_errors (executor.size (), 0.0f);
+    parallel_for (executor, executor.size (), scene.size (), CONVERSION_GRAIN, [&] (size_t first, size_t last, unsigned int slot) {
+        for (size_t i = first; i < last; ++i) {
+            slot_max_errors [slot] = std::max (slot_max_errors [slot], quantize_node (scene [i], quantized.nodes [i]));
+        }
+    });
+    const float max_error = *std::max_element (slot_max_errors.begin (), slot_max_errors.end ());
+    quantized.max_error = max_error;
+
+    printf ("Quantized SDF octree to %u bits: %u nodes, %.2f MB -> %.2f MB, max error %g\n"
+            , (unsigned) QuantizationTraits <NodeT>::bits
+            , (unsigned) scene.size ()
+            , scene.size () * sizeof (SdfOctreeNode) / (1024.0 * 1024.0)
+            , quantized.size () * sizeof (NodeT) / (1024.0 * 1024.0)
+            , max_error
+            );
+}
+
+template <typename NodeT>
+void dequantize (const QuantizedSdfOctree <NodeT>& quantized, SdfOctree& scene) {
+    scene.nodes.resize (quantized.size ());
+
+    Executor& executor = Executor::shared ();
+    parallel_for (executor, executor.size (), quantized.size (), CONVERSION_GRAIN, [&] (size_t first, size_t last, unsigned int) {
+        for (size_t i = first; i < last; ++i) {
+            load_node_values (quantized [i], scene.nodes [i].values);
+            scene.nodes [i].offset = quantized [i].offset;
+        }
+    });
+}
+
+template <typename NodeT>
+void load (QuantizedSdfOctree <NodeT>& scene, const std::string& path) {
+    std::ifstream fs (path, std::ios::binary);
+    if (!fs) {
+        throw std::runtime_error ("[load_sdf_octree]: failed to open " + path);
+    }
+
+    char magic [4] = {};
+    unsigned sz = 0;
+    fs.read (magic, sizeof (magic));
+    if (!std::equal (std::begin (magic), std::end (magic), QuantizationTraits <NodeT>::magic)) {
+        throw std::runtime_error ("[load_sdf_octree]: " + path + " is not a " + std::to_string (QuantizationTraits <NodeT>::bits) + "-bit quantized octree");
+    }
+    fs.read ((char *) &sz, sizeof (unsigned));
+    fs.read ((char *) &scene.max_error, sizeof (float));
+    scene.nodes.resize (sz);
+    fs.read ((char *) scene.nodes.data (), scene.nodes.size () * sizeof (NodeT));
+    if (!fs) {
+        throw std::runtime_error ("[load_sdf_octree]: " + path + " is truncated");
+    }
+}
+
+template <typename NodeT>
+void save (const QuantizedSdfOctree <NodeT>& scene, const std::string& path) {
+    std::ofstream fs (path, std::ios::binary);
+    unsigned size = scene.size ();
+    fs.write (QuantizationTraits <NodeT>::magic, sizeof (QuantizationTraits <NodeT>::magic));
+    fs.write ((const char *) &size, sizeof (unsigned));
+    fs.write ((const char *) &scene.max_error, sizeof (float));
+    fs.write ((const char *) scene.nodes.data (), size * sizeof (NodeT));
+    fs.flush ();
+}
+
+template <typename NodeT>
+float sample (const QuantizedSdfOctree <NodeT>& scene, const LiteMath::float3& p) {
+    LiteMath::float3 min_corner;
+    float voxel_size = 0.0f;
+    float values [8];
+    load_node_values (scene [find_leaf (scene, p, min_corner, voxel_size)], values);
+    return interpolate_trilinear (values, (p - min_corner) / voxel_size);
+}
+
+template <typename NodeT>
+SdfSample sample_with_gradient (const QuantizedSdfOctree <NodeT>& scene, const LiteMath::float3& p) {
+    LiteMath::float3 min_corner;
+    float voxel_size = 0.0f;
+    float values [8];
+    load_node_values (scene [find_leaf (scene, p, min_corner, voxel_size)], values);
+    return interpolate_trilinear_with_gradient (values, (p - min_corner) / voxel_size, voxel_size);
+}
+
+}
+
+void quantize_sdf_octree (const SdfOctreeView& scene, SdfOctreeQ8& quantized) { quantize (scene, quantized); }
+void quantize_sdf_octree (const SdfOctreeView& scene, SdfOctreeQ16& quantized) { quantize (scene, quantized); }
+
+void dequantize_sdf_octree (const SdfOctreeQ8& quantized, SdfOctree& scene) { dequantize (quantized, scene); }
+void dequantize_sdf_octree (const SdfOctreeQ16& quantized, SdfOctree& scene) { dequantize (quantized, scene); }
+
+void load_sdf_octree (SdfOctreeQ8& scene, const std::string& path) { load (scene, path); }
+void load_sdf_octree (SdfOctreeQ16& scene, const std::string& path) { load (scene, path); }
+void save_sdf_octree (const SdfOctreeQ8& scene, const std::string& path) { save (scene, path); }
+void save_sdf_octree (const SdfOctreeQ16& scene, const std::string& path) { save (scene, path); }
+
+float sample_sdf (const SdfOctreeQ8& scene, const LiteMath::float3& p) { return sample (scene, p); }
+float sample_sdf (const SdfOctreeQ16& scene, const LiteMath::float3& p) { return sample (scene, p); }
+SdfSample sample_sdf_with_gradient (const SdfOctreeQ8& scene, const LiteMath::float3& p) { return sample_with_gradient (scene, p); }
+SdfSample sample_sdf_with_gradient (const SdfOctreeQ16& scene, const LiteMath::float3& p) { return sample_with_gradient (scene, p); }
+
+SdfOctreeDescriptorSetInfo create_sdf_octree_descriptor_set (
+        VkDevice device
+        , VkPhysicalDevice physical_device
+        , const SdfOctreeQ8& octree
+        , std::shared_ptr <vk_utils::ICopyEngine> copy_helper
+        , vk_utils::DescriptorMaker& ds_maker
+        , VkShaderStageFlags shader_stage_flags) {
+    return create_sdf_octree_descriptor_set (device, physical_device
+            , octree.nodes.data (), octree.size () * sizeof (SdfOctreeNodeQ8)
+            , copy_helper, ds_maker, shader_stage_flags);
+}
+
+SdfOctreeDescriptorSetInfo create_sdf_octree_descriptor_set (
+        VkDevice device
+        , VkPhysicalDevice physical_device
+        , const SdfOctreeQ16& octree
+        , std::shared_ptr <vk_utils::ICopyEngine> copy_helper
+        , vk_utils::DescriptorMaker& ds_maker
+        , VkShaderStageFlags shader_stage_flags) {
+    return create_sdf_octree_descriptor_set (device, physical_device
+            , octree.nodes.data (), octree.size () * sizeof (SdfOctreeNodeQ16)
+            , copy_helper, ds_maker, shader_stage_flags);
+}
+
+}
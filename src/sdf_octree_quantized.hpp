@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "sdf_octree.hpp"
+
+namespace sdf_raster {
+
+// Quantized octree storage. Every node keeps its own value range (f16 base and step) and
+// 8- or 16-bit corners, so precision follows the local range of the field instead of fp32.
+template <typename NodeT>
+struct QuantizedSdfOctree {
+  std::vector <NodeT> nodes;
+  float max_error = 0.0f; // max |decoded - original| over all corners, measured at encode time
+
+  const NodeT& operator [] (size_t i) const { return nodes [i]; }
+  size_t size () const { return nodes.size (); }
+  bool empty () const { return nodes.empty (); }
+};
+
+using SdfOctreeQ8 = QuantizedSdfOctree <SdfOctreeNodeQ8>;
+using SdfOctreeQ16 = QuantizedSdfOctree <SdfOctreeNodeQ16>;
+
+// Node storage uploaded for rendering; each one has its own build of the octree shaders.
+enum class SdfOctreeEncoding {
+  Float32, // SdfOctreeNode, <shader>.spv
+  Q8,      // SdfOctreeNodeQ8, <shader>.q8.spv
+  Q16,     // SdfOctreeNodeQ16, <shader>.q16.spv
+};
+
+inline float half_to_float (uint32_t h) {
+    const uint32_t sign = (h & 0x8000u) << 16;
+    const uint32_t exponent = (h >> 10) & 0x1fu;
+    const uint32_t mantissa = h & 0x3ffu;
+
+    if (exponent == 0) {
+        const float magnitude = static_cast <float> (mantissa) * 5.9604644775390625e-8f; // 2^-24
+        return sign ? -magnitude : magnitude;
+    }
+
+    uint32_t bits = sign | ((exponent == 0x1fu ? 0xffu : exponent + 112u) << 23) | (mantissa << 13);
+    float result;
+    std::memcpy (&result, &bits, sizeof (float));
+    return result;
+}
+
+inline void load_node_values (const SdfOctreeNodeQ8& node, float (&values) [8]) {
+    const float base = half_to_float (node.range & 0xffffu);
+    const float step = half_to_float (node.range >> 16);
+    for (int i = 0; i < 8; ++i) {
+        values [i] = base + static_cast <float> ((node.values [i >> 2] >> ((i & 3) * 8)) & 0xffu) * step;
+    }
+}
+
+inline void load_node_values (const SdfOctreeNodeQ16& node, float (&values) [8]) {
+    const float base = half_to_float (node.range & 0xffffu);
+    const float step = half_to_float (node.range >> 16);
+    for (int i = 0; i < 8; ++i) {
+        values [i] = base + static_cast <float> ((node.values [i >> 1] >> ((i & 1) * 16)) & 0xffffu) * step;
+    }
+}
+
+void quantize_sdf_octree (const SdfOctreeView& scene, SdfOctreeQ8& quantized);
+void quantize_sdf_octree (const SdfOctreeView& scene, SdfOctreeQ16& quantized);
+
+// Expands back to fp32 nodes, e.g. for tools that only understand the original format.
+void dequantize_sdf_octree (const SdfOctreeQ8& quantized, SdfOctree& scene);
+void dequantize_sdf_octree (const SdfOctreeQ16& quantized, SdfOctree& scene);
+
+void load_sdf_octree (SdfOctreeQ8& scene, const std::string& path);
+void load_sdf_octree (SdfOctreeQ16& scene, const std::string& path);
+void save_sdf_octree (const SdfOctreeQ8& scene, const std::string& path);
+void save_sdf_octree (const SdfOctreeQ16& scene, const std::string& path);
+
+float sample_sdf (const SdfOctreeQ8& scene, const LiteMath::float3& p);
+float sample_sdf (const SdfOctreeQ16& scene, const LiteMath::float3& p);
+SdfSample sample_sdf_with_gradient (const SdfOctreeQ8& scene, const LiteMath::float3& p);
+SdfSample sample_sdf_with_gradient (const SdfOctreeQ16& scene, const LiteMath::float3& p);
+
+SdfOctreeDescriptorSetInfo create_sdf_octree_descriptor_set (
+    VkDevice device
+    , VkPhysicalDevice physical_device
+    , const SdfOctreeQ8& octree
+    , std::shared_ptr <vk_utils::ICopyEngine> copy_helper
+    , vk_utils::DescriptorMaker& ds_maker
+    , VkShaderStageFlags shader_stage_flags);
+
+SdfOctreeDescriptorSetInfo create_sdf_octree_descriptor_set (
+    VkDevice device
+    , VkPhysicalDevice physical_device
+    , const SdfOctreeQ16& octree
+    , std::shared_ptr <vk_utils::ICopyEngine> copy_helper
+    , vk_utils::DescriptorMaker& ds_maker
+    , VkShaderStageFlags shader_stage_flags);
+
+}
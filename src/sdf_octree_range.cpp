@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#include <sys/stat.h>
+
+#include "sdf_octree_range.hpp"
+
+namespace sdf_raster {
+
+namespace {
+
+// Version 3 stores the stamp and hash of the octree; older files fail the magic check and get rebuilt.
+constexpr char RANGE_INDEX_MAGIC [4] = {'S', 'R', 'I', '3'};
+
+struct RangeBuildEntry {
+    uint32_t node_index;
+    uint32_t corner_lattice;
+    uint32_t child_slot;
+};
+
+template <typename Octree>
+void build_range_index (const Octree& scene, SdfOctreeRangeIndex& index) {
+    if (scene.empty ()) {
+        throw std::runtime_error {"[build_sdf_octree_range_index]: empty sdf"};
+    }
+
+    // Breadth-first order puts every node after its parent, so walking it backwards visits children first.
+    std::vector <RangeBuildEntry> order {{0, 0, 0}};
+    for (size_t i = 0; i < order.size (); ++i) {
+        const uint32_t offset = scene [order [i].node_index].offset;
+        if (offset == 0) {
+            continue;
+        }
+        if (static_cast <size_t> (offset) + 8 > scene.size () || order.size () + 8 > scene.size ()) {
+            throw std::runtime_error {"[build_sdf_octree_range_index]: out of bounds."};
+        }
+        const uint32_t lattice = children_lattice (scene, order [i].node_index);
+        for (uint32_t k = 0; k < 8; ++k) {
+            order.push_back ({offset + k, lattice, k});
+        }
+    }
+
+    const SdfOctreeRange empty_range = {std::numeric_limits <float>::infinity (), -std::numeric_limits <float>::infinity ()};
+    index.ranges.assign (scene.size (), empty_range);
+    index.octree_hash = 0;
+    index.octree_file = {};
+
+    for (size_t i = order.size (); i-- > 0;) {
+        const RangeBuildEntry& entry = order [i];
+        SdfOctreeRange& range = index.ranges [entry.node_index];
+        const uint32_t offset = scene [entry.node_index].offset;
+
+        if (offset == 0) {
+            float values [8];
+            load_node_values (scene, entry.node_index, entry.corner_lattice, entry.child_slot, values);
+            range.min = *std::min_element (std::begin (values), std::end (values));
+            range.max = *std::max_element (std::begin (values), std::end (values));
+        } else {
+            for (uint32_t k = 0; k < 8; ++k) {
+                range.min = std::min (range.min, index.ranges [offset + k].min);
+                range.max = std::max (range.max, index.ranges [offset + k].max);
+            }
+        }
+    }
+}
+
+}
+
+void build_sdf_octree_range_index (const SdfOctreeView& scene, SdfOctreeRangeIndex& index) { build_range_index (scene, index); }
+void build_sdf_octree_range_index (const SdfOctreeQ8& scene, SdfOctreeRangeIndex& index) { build_range_index (scene, index); }
+void build_sdf_octree_range_index (const SdfOctreeQ16& scene, SdfOctreeRangeIndex& index) { build_range_index (scene, index); }
+void build_sdf_octree_range_index (const SharedCornerSdfOctree& scene, SdfOctreeRangeIndex& index) { build_range_index (scene, index); }
+
+SdfOctreeFileStamp stamp_sdf_octree_file (const std::string& path) {
+    struct stat st {};
+    if (::stat (path.c_str (), &st) != 0) {
+        throw std::runtime_error ("[stamp_sdf_octree_file]: failed to stat " + path);
+    }
+    SdfOctreeFileStamp stamp;
+    stamp.size = static_cast <uint64_t> (st.st_size);
+    stamp.mtime_ns = static_cast <uint64_t> (st.st_mtim.tv_sec) * 1000000000ull + static_cast <uint64_t> (st.st_mtim.tv_nsec);
+    stamp.inode = static_cast <uint64_t> (st.st_ino);
+    stamp.device = static_cast <uint64_t> (st.st_dev);
+    return stamp;
+}
+
+uint64_t hash_sdf_octree (const SdfOctreeView& scene) {
+    // FNV-1a over 32-bit words, which every node field is.
+    static_assert (sizeof (SdfOctreeNode) % sizeof (uint32_t) == 0, "nodes must be whole 32-bit words");
+    const char* bytes = reinterpret_cast <const char*> (scene.data ());
+    const size_t words = scene.size () * (sizeof (SdfOctreeNode) / sizeof (uint32_t));
+    uint64_t hash = 0xcbf29ce484222325ull ^ scene.size ();
+    for (size_t i = 0; i < words; ++i) {
+        uint32_t word;
+        std::memcpy (&word, bytes + i * sizeof (uint32_t), sizeof (uint32_t));
+        hash = (hash ^ word) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+void load_sdf_octree_range_index (SdfOctreeRangeIndex& index, const std::string& path) {
+    std::ifstream fs (path, std::ios::binary);
+    if (!fs) {
+        throw std::runtime_error ("[load_sdf_octree_range_index]: failed to open " + path);
+    }
+
+    char magic [4] = {};
+    unsigned sz = 0;
+    fs.read (magic, sizeof (magic));
+    if (!std::equal (std::begin (magic), std::end (magic), RANGE_INDEX_MAGIC)) {
+        throw std::runtime_error ("[load_sdf_octree_range_index]: " + path + " is not a range index");
+    }
+    fs.read ((char *) &index.octree_file, sizeof (SdfOctreeFileStamp));
+    fs.read ((char *) &index.octree_hash, sizeof (uint64_t));
+    fs.read ((char *) &sz, sizeof (unsigned));
+    index.ranges.resize (sz);
+    fs.read ((char *) index.ranges.data (), index.ranges.size () * sizeof (SdfOctreeRange));
+    if (!fs) {
+        throw std::runtime_error ("[load_sdf_octree_range_index]: " + path + " is truncated");
+    }
+}
+
+void save_sdf_octree_range_index (const SdfOctreeRangeIndex& index, const std::string& path) {
+    std::ofstream fs (path, std::ios::binary);
+    unsigned size = index.size ();
+    fs.write (RANGE_INDEX_MAGIC, sizeof (RANGE_INDEX_MAGIC));
+    fs.write ((const char *) &index.octree_file, sizeof (SdfOctreeFileStamp));
+    fs.write ((const char *) &index.octree_hash, sizeof (uint64_t));
+    fs.write ((const char *) &size, sizeof (unsigned));
+    fs.write ((const char *) index.ranges.data (), size * sizeof (SdfOctreeRange));
+    fs.flush ();
+}
+
+void load_or_build_sdf_octree_range_index (const SdfOctreeView& scene, const std::string& octree_path, SdfOctreeRangeIndex& index) {
+    const std::string path = octree_path + ".range";
+    // The node count alone misses octrees rewritten in place: a new layout or a rebuild can keep it.
+    const SdfOctreeFileStamp stamp = stamp_sdf_octree_file (octree_path);
+
+    if (std::ifstream (path, std::ios::binary)) {
+        try {
+            load_sdf_octree_range_index (index, path);
+            if (index.size () == scene.size () && index.octree_file == stamp) {
+                return;
+            }
+            // A new stamp with the same nodes (touched or copied) only needs the stamp updated.
+            if (index.size () == scene.size () && index.octree_hash == hash_sdf_octree (scene)) {
+                index.octree_file = stamp;
+                save_sdf_octree_range_index (index, path);
+                return;
+            }
+            printf ("[load_or_build_sdf_octree_range_index]: %s does not match the octree, rebuilding\n", path.c_str ());
+        } catch (const std::runtime_error& e) {
+            printf ("%s, rebuilding\n", e.what ());
+        }
+    }
+
+    build_sdf_octree_range_index (scene, index);
+    index.octree_hash = hash_sdf_octree (scene);
+    index.octree_file = stamp;
+    save_sdf_octree_range_index (index, path);
+}
+
+}
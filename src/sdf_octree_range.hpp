@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "sdf_octree_formats.hpp"
+
+namespace sdf_raster {
+
+struct SdfOctreeRange {
+  float min;
+  float max;
+};
+
+// Per-node bounds of all corner values in the node's subtree. A trilinear leaf never leaves the range of its
+// corners, so a subtree whose range does not straddle the iso level holds no surface and can be skipped whole.
+// Node order matches the octree it was built from; unreachable nodes get an empty range.
+// Size, modification time and identity of an octree file: a cheap check that it has not changed since.
+struct SdfOctreeFileStamp {
+  uint64_t size = 0;
+  uint64_t mtime_ns = 0;
+  uint64_t inode = 0;
+  uint64_t device = 0;
+
+  bool operator== (const SdfOctreeFileStamp& other) const {
+      return this->size == other.size && this->mtime_ns == other.mtime_ns && this->inode == other.inode && this->device == other.device;
+  }
+  bool operator!= (const SdfOctreeFileStamp& other) const { return !(*this == other); }
+};
+
+struct SdfOctreeRangeIndex {
+  std::vector <SdfOctreeRange> ranges;
+  uint64_t octree_hash = 0;         // hash_sdf_octree of the octree it was built from when known, 0 otherwise
+  SdfOctreeFileStamp octree_file;   // the file it was built from when known, zeros otherwise
+
+  // Same classification as marching cubes: a corner is inside when its value is below iso_level.
+  bool may_contain_surface (size_t node_index, float iso_level) const {
+      return this->ranges [node_index].min < iso_level && this->ranges [node_index].max >= iso_level;
+  }
+
+  size_t size () const { return ranges.size (); }
+  bool empty () const { return ranges.empty (); }
+};
+
+void build_sdf_octree_range_index (const SdfOctreeView& scene, SdfOctreeRangeIndex& index);
+void build_sdf_octree_range_index (const SdfOctreeQ8& scene, SdfOctreeRangeIndex& index);
+void build_sdf_octree_range_index (const SdfOctreeQ16& scene, SdfOctreeRangeIndex& index);
+void build_sdf_octree_range_index (const SharedCornerSdfOctree& scene, SdfOctreeRangeIndex& index);
+
+// Hash of the node array: any change to node values, offsets or order changes it, even at the same node count.
+uint64_t hash_sdf_octree (const SdfOctreeView& scene);
+SdfOctreeFileStamp stamp_sdf_octree_file (const std::string& path);
+
+void load_sdf_octree_range_index (SdfOctreeRangeIndex& index, const std::string& path);
+void save_sdf_octree_range_index (const SdfOctreeRangeIndex& index, const std::string& path);
+
+// Reads `<octree_path>.range` when it exists and was built from this exact octree, otherwise builds the index and
+// writes that file so later runs skip the build. An unchanged file stamp is enough and reads no nodes; only when it
+// differs (the file was touched, copied or rewritten) are the nodes hashed and compared.
+void load_or_build_sdf_octree_range_index (const SdfOctreeView& scene, const std::string& octree_path, SdfOctreeRangeIndex& index);
+
+}
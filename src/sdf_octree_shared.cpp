@@ -0,0 +1,238 @@
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "sdf_octree_shared.hpp"
+
+namespace sdf_raster {
+
+namespace {
+
+constexpr uint32_t MAX_SHARED_DEPTH = 20; // lattice coordinates are packed as 3 x 21 bits
+
+struct GridNode {
+    uint32_t index;
+    uint32_t depth;
+    uint32_t x, y, z; // min corner in units of this node's size
+};
+
+uint64_t lattice_key (uint64_t x, uint64_t y, uint64_t z) {
+    return x | (y << 21) | (z << 42);
+}
+
+uint32_t max_depth (const SdfOctreeView& scene) {
+    uint32_t depth = 0;
+    std::vector <std::pair <uint32_t, uint32_t>> stack {{0, 0}};
+    while (!stack.empty ()) {
+        const auto [index, node_depth] = stack.back ();
+        stack.pop_back ();
+        depth = std::max (depth, node_depth);
+        const uint32_t offset = scene [index].offset;
+        if (offset != 0) {
+            if (offset + 8 > scene.size ()) {
+                throw std::runtime_error {"[build_shared_corner_octree]: out of bounds."};
+            }
+            for (uint32_t k = 0; k < 8; ++k) {
+                stack.push_back ({offset + k, node_depth + 1});
+            }
+        }
+    }
+    return depth;
+}
+
+}
+
+void build_shared_corner_octree (const SdfOctreeView& scene, SharedCornerSdfOctree& shared) {
+    if (scene.empty ()) {
+        throw std::runtime_error {"[build_shared_corner_octree]: empty sdf"};
+    }
+
+    const uint32_t depth = max_depth (scene);
+    if (depth > MAX_SHARED_DEPTH) {
+        throw std::runtime_error {"[build_shared_corner_octree]: octree is deeper than " + std::to_string (MAX_SHARED_DEPTH) + " levels."};
+    }
+
+    shared.nodes.assign (scene.size (), SdfOctreeSharedNode {0, 0});
+    shared.lattices.clear ();
+    shared.corners.clear ();
+
+    std::unordered_map <uint64_t, uint32_t> corner_ids;
+    corner_ids.reserve (scene.size () * 2);
+    std::vector <uint32_t> sample_counts;
+
+    // Ids are handed out in depth-first order, so leaves that are close in the tree are close in the pool.
+    auto corner_id = [&] (uint64_t x, uint64_t y, uint64_t z) {
+        auto [it, inserted] = corner_ids.try_emplace (lattice_key (x, y, z), static_cast <uint32_t> (shared.corners.size ()));
+        if (inserted) {
+            shared.corners.push_back (0.0f);
+            sample_counts.push_back (0);
+        }
+        return it->second;
+    };
+
+    // Lattice 0: the root as child 0 of a virtual parent; points outside the 2x2x2 corner set are never read.
+    shared.lattices.assign (27, 0);
+    for (uint32_t c = 0; c < 8; ++c) {
+        shared.lattices [lattice_point (0, c)] = corner_id (
+                static_cast <uint64_t> (c & 1) << depth
+                , static_cast <uint64_t> (c >> 1 & 1) << depth
+                , static_cast <uint64_t> (c >> 2 & 1) << depth);
+    }
+
+    std::vector <GridNode> stack {{0, 0, 0, 0, 0}};
+    while (!stack.empty ()) {
+        const GridNode node = stack.back ();
+        stack.pop_back ();
+
+        const SdfOctreeNode& source = scene [node.index];
+        const uint32_t shift = depth - node.depth;
+        for (uint32_t c = 0; c < 8; ++c) {
+            const uint32_t id = corner_id (
+                    static_cast <uint64_t> (node.x + (c & 1)) << shift
+                    , static_cast <uint64_t> (node.y + (c >> 1 & 1)) << shift
+                    , static_cast <uint64_t> (node.z + (c >> 2 & 1)) << shift);
+            shared.corners [id] += source.values [c];
+            ++sample_counts [id];
+        }
+
+        shared.nodes [node.index].offset = source.offset;
+        if (source.offset == 0) {
+            continue;
+        }
+
+        const uint32_t lattice = static_cast <uint32_t> (shared.lattices.size ());
+        shared.nodes [node.index].lattice = lattice;
+        shared.lattices.resize (lattice + 27);
+        for (uint32_t i = 0; i < 27; ++i) {
+            shared.lattices [lattice + i] = corner_id (
+                    static_cast <uint64_t> (2 * node.x + i % 3) << (shift - 1)
+                    , static_cast <uint64_t> (2 * node.y + i / 3 % 3) << (shift - 1)
+                    , static_cast <uint64_t> (2 * node.z + i / 9) << (shift - 1));
+        }
+
+        for (int k = 7; k >= 0; --k) {
+            stack.push_back ({source.offset + k
+                    , node.depth + 1
+                    , 2 * node.x + (k & 1)
+                    , 2 * node.y + (k >> 1 & 1)
+                    , 2 * node.z + (k >> 2 & 1)});
+        }
+    }
+
+    for (size_t i = 0; i < shared.corners.size (); ++i) {
+        shared.corners [i] /= static_cast <float> (sample_counts [i]);
+    }
+
+    printf ("Shared-corner SDF octree: %u nodes, %u unique corners, %.2f MB -> %.2f MB\n"
+            , (unsigned) shared.nodes.size ()
+            , (unsigned) shared.corners.size ()
+            , scene.size () * sizeof (SdfOctreeNode) / (1024.0 * 1024.0)
+            , shared.memory_footprint () / (1024.0 * 1024.0)
+            );
+}
+
+void expand_shared_corner_octree (const SharedCornerSdfOctree& shared, SdfOctree& scene) {
+    scene.nodes.resize (shared.size ());
+    if (shared.empty ()) {
+        return;
+    }
+
+    // (node index, lattice of its sibling group, slot within the group)
+    std::vector <std::array <uint32_t, 3>> stack {{0, 0, 0}};
+    while (!stack.empty ()) {
+        const auto [index, lattice, slot] = stack.back ();
+        stack.pop_back ();
+
+        load_node_values (shared, lattice, slot, scene.nodes [index].values);
+        scene.nodes [index].offset = shared [index].offset;
+        for (uint32_t k = 0; shared [index].offset != 0 && k < 8; ++k) {
+            stack.push_back ({shared [index].offset + k, shared [index].lattice, k});
+        }
+    }
+}
+
+void load_sdf_octree (SharedCornerSdfOctree& scene, const std::string& path) {
+    std::ifstream fs (path, std::ios::binary);
+    if (!fs) {
+        throw std::runtime_error ("[load_sdf_octree]: failed to open " + path);
+    }
+
+    char magic [4] = {};
+    unsigned sizes [3] = {};
+    fs.read (magic, sizeof (magic));
+    if (std::string (magic, sizeof (magic)) != "SCO1") {
+        throw std::runtime_error ("[load_sdf_octree]: " + path + " is not a shared-corner octree");
+    }
+    fs.read ((char *) sizes, sizeof (sizes));
+    scene.nodes.resize (sizes [0]);
+    scene.lattices.resize (sizes [1]);
+    scene.corners.resize (sizes [2]);
+    fs.read ((char *) scene.nodes.data (), scene.nodes.size () * sizeof (SdfOctreeSharedNode));
+    fs.read ((char *) scene.lattices.data (), scene.lattices.size () * sizeof (uint32_t));
+    fs.read ((char *) scene.corners.data (), scene.corners.size () * sizeof (float));
+    if (!fs) {
+        throw std::runtime_error ("[load_sdf_octree]: " + path + " is truncated");
+    }
+}
+
+void save_sdf_octree (const SharedCornerSdfOctree& scene, const std::string& path) {
+    std::ofstream fs (path, std::ios::binary);
+    const unsigned sizes [3] = {
+        (unsigned) scene.nodes.size ()
+        , (unsigned) scene.lattices.size ()
+        , (unsigned) scene.corners.size ()
+    };
+    fs.write ("SCO1", 4);
+    fs.write ((const char *) sizes, sizeof (sizes));
+    fs.write ((const char *) scene.nodes.data (), scene.nodes.size () * sizeof (SdfOctreeSharedNode));
+    fs.write ((const char *) scene.lattices.data (), scene.lattices.size () * sizeof (uint32_t));
+    fs.write ((const char *) scene.corners.data (), scene.corners.size () * sizeof (float));
+    fs.flush ();
+}
+
+namespace {
+
+size_t find_shared_leaf (const SharedCornerSdfOctree& scene, const LiteMath::float3& p, LiteMath::float3& min_corner, float& voxel_size, float (&values) [8]) {
+    min_corner = {-1.0f, -1.0f, -1.0f};
+    voxel_size = 2.0f;
+    uint32_t index = 0;
+    uint32_t lattice = 0;
+    uint32_t slot = 0;
+
+    while (scene [index].offset != 0) {
+        float half = voxel_size * 0.5f;
+        unsigned child_index = 0;
+        if (p.x >= min_corner.x + half) child_index |= 1, min_corner.x += half;
+        if (p.y >= min_corner.y + half) child_index |= 2, min_corner.y += half;
+        if (p.z >= min_corner.z + half) child_index |= 4, min_corner.z += half;
+        voxel_size = half;
+        lattice = scene [index].lattice;
+        slot = child_index;
+        index = scene [index].offset + child_index;
+    }
+
+    load_node_values (scene, lattice, slot, values);
+    return index;
+}
+
+}
+
+float sample_sdf (const SharedCornerSdfOctree& scene, const LiteMath::float3& p) {
+    LiteMath::float3 min_corner;
+    float voxel_size = 0.0f;
+    float values [8];
+    find_shared_leaf (scene, p, min_corner, voxel_size, values);
+    return interpolate_trilinear (values, (p - min_corner) / voxel_size);
+}
+
+SdfSample sample_sdf_with_gradient (const SharedCornerSdfOctree& scene, const LiteMath::float3& p) {
+    LiteMath::float3 min_corner;
+    float voxel_size = 0.0f;
+    float values [8];
+    find_shared_leaf (scene, p, min_corner, voxel_size, values);
+    return interpolate_trilinear_with_gradient (values, (p - min_corner) / voxel_size, voxel_size);
+}
+
+}
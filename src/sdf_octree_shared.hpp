@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "sdf_octree.hpp"
+
+namespace sdf_raster {
+
+struct SdfOctreeSharedNode {
+  uint32_t offset;  // same meaning as SdfOctreeNode::offset, 0 means leaf
+  uint32_t lattice; // first of the 27 lattice entries describing the corners of this node's children
+};
+
+// Octree whose corner samples are stored once in a global pool.
+//
+// The 8 children of a node tile a 3x3x3 lattice of sample points, so each sibling group stores 27 corner ids
+// instead of 8 x 8 values, and neighbouring leaves read the very same samples on shared edges. Corner c of
+// child k sits at lattice point (kx + cx, ky + cy, kz + cz). Lattice 0 describes the root, as child 0 of a
+// virtual parent. Node order and offsets match the source SdfOctree.
+struct SharedCornerSdfOctree {
+  std::vector <SdfOctreeSharedNode> nodes;
+  std::vector <uint32_t> lattices;
+  std::vector <float> corners;
+
+  const SdfOctreeSharedNode& operator [] (size_t i) const { return nodes [i]; }
+  size_t size () const { return nodes.size (); }
+  bool empty () const { return nodes.empty (); }
+
+  size_t memory_footprint () const {
+      return nodes.size () * sizeof (SdfOctreeSharedNode) + lattices.size () * sizeof (uint32_t) + corners.size () * sizeof (float);
+  }
+};
+
+inline uint32_t lattice_point (uint32_t child_slot, uint32_t corner) {
+    return ((child_slot & 1) + (corner & 1))
+         + ((child_slot >> 1 & 1) + (corner >> 1 & 1)) * 3
+         + ((child_slot >> 2 & 1) + (corner >> 2 & 1)) * 9;
+}
+
+// Corner values of the node sitting in `child_slot` of the sibling group described by `lattice`.
+inline void load_node_values (const SharedCornerSdfOctree& scene, uint32_t lattice, uint32_t child_slot, float (&values) [8]) {
+    const uint32_t* ids = &scene.lattices [lattice];
+    for (uint32_t i = 0; i < 8; ++i) {
+        values [i] = scene.corners [ids [lattice_point (child_slot, i)]];
+    }
+}
+
+// Converts from the per-node layout. Samples that several nodes report for the same point are averaged.
+void build_shared_corner_octree (const SdfOctreeView& scene, SharedCornerSdfOctree& shared);
+void expand_shared_corner_octree (const SharedCornerSdfOctree& shared, SdfOctree& scene);
+
+void load_sdf_octree (SharedCornerSdfOctree& scene, const std::string& path);
+void save_sdf_octree (const SharedCornerSdfOctree& scene, const std::string& path);
+
+float sample_sdf (const SharedCornerSdfOctree& scene, const LiteMath::float3& p);
+SdfSample sample_sdf_with_gradient (const SharedCornerSdfOctree& scene, const LiteMath::float3& p);
+
+}